@@ -0,0 +1,506 @@
+#include "cairo_renderer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/macros.h"
+
+#ifndef M_PI
+#  define M_PI 3.14159265358979323846
+#endif
+
+// cairo instance commands are rasterized into, owned by backend
+static cairo_t* cairo = NULL;
+
+// cairo instance used for measuring text, as target may be in use by
+// another thread
+static cairo_t* measure_cairo = NULL;
+
+// state of target, to skip redundant state changes
+static bool has_source_color = false;
+static color source_color;
+static cairo_scaled_font_t* current_font = NULL;
+
+// fonts loaded under their handles, created by measuring cairo instance
+// and shared with target
+typedef struct loaded_font
+{
+  cairo_scaled_font_t* scaled_font;
+  cairo_font_extents_t extents;
+} loaded_font;
+static loaded_font* fonts = NULL;
+static uint32 fonts_count = 0;
+
+// glyphs of glyph run being rendered, placed at coordinates of its command
+static cairo_glyph_t* render_glyphs = NULL;
+static uint32 render_glyphs_capacity = 0;
+
+result_void cairo_renderer_init()
+{
+  cairo_surface_t* cairo_surface =
+    cairo_image_surface_create(CAIRO_FORMAT_RGB24, 1, 1);
+  if(!cairo_surface)
+  {
+    return error(result_void,
+                 "Error while creating cairo surface for measuring text!");
+  }
+
+  measure_cairo = cairo_create(cairo_surface);
+  if(!measure_cairo)
+  {
+    return error(result_void,
+                 "Error while creating cairo instance for measuring text!");
+  }
+
+  cairo_surface_destroy(cairo_surface);
+
+  return ok_void();
+}
+
+void cairo_renderer_deinit()
+{
+  cairo_destroy(measure_cairo);
+  measure_cairo = NULL;
+  cairo = NULL;
+
+  for(uint32 i = 0; i < fonts_count; i++)
+  {
+    if(fonts[i].scaled_font)
+    {
+      cairo_scaled_font_destroy(fonts[i].scaled_font);
+    }
+  }
+  free(fonts);
+  fonts = NULL;
+  fonts_count = 0;
+
+  free(render_glyphs);
+  render_glyphs = NULL;
+  render_glyphs_capacity = 0;
+}
+
+void cairo_renderer_set_target(cairo_t* target)
+{
+  cairo = target;
+
+  // new cairo instance starts with default state
+  has_source_color = false;
+  current_font = NULL;
+}
+
+result_void cairo_renderer_load_font(font_handle font,
+                                     const char* font_name,
+                                     uint8 font_size)
+{
+  if(!font_name)
+  {
+    return error(result_void, "Cannot load font pointing to NULL!");
+  }
+
+  // resolving font once, texts of this handle reuse its scaled font
+  cairo_select_font_face(measure_cairo, font_name, 0, 0);
+  cairo_set_font_size(measure_cairo, font_size);
+  cairo_scaled_font_t* scaled_font =
+    cairo_scaled_font_reference(cairo_get_scaled_font(measure_cairo));
+  if(cairo_scaled_font_status(scaled_font) != CAIRO_STATUS_SUCCESS)
+  {
+    cairo_scaled_font_destroy(scaled_font);
+    return error(result_void, "Error while loading font!");
+  }
+
+  if(font >= fonts_count)
+  {
+    loaded_font* new_fonts =
+      (loaded_font*)realloc(fonts, sizeof(loaded_font) * (font + 1));
+    if(!new_fonts)
+    {
+      cairo_scaled_font_destroy(scaled_font);
+      return error(result_void, "Unable to allocate memory for fonts!");
+    }
+    memset(new_fonts + fonts_count,
+           0,
+           sizeof(loaded_font) * (font + 1 - fonts_count));
+    fonts = new_fonts;
+    fonts_count = font + 1;
+  }
+
+  if(fonts[font].scaled_font)
+  {
+    cairo_scaled_font_destroy(fonts[font].scaled_font);
+  }
+  fonts[font].scaled_font = scaled_font;
+  cairo_scaled_font_extents(scaled_font, &fonts[font].extents);
+  current_font = NULL;
+
+  return ok_void();
+}
+
+/// Gives font loaded under handle, (or) default font if none is loaded under
+/// it, `NULL` if neither is loaded.
+static const loaded_font* get_font(font_handle font)
+{
+  if(font < fonts_count && fonts[font].scaled_font)
+  {
+    return &fonts[font];
+  }
+
+  if(fonts_count && fonts[DEFAULT_FONT_HANDLE].scaled_font)
+  {
+    return &fonts[DEFAULT_FONT_HANDLE];
+  }
+
+  return NULL;
+}
+
+result_text_dimensions cairo_renderer_get_text_dimensions(const char* text,
+                                                          font_handle font)
+{
+  if(!text)
+  {
+    return error(result_text_dimensions,
+                 "Cannot get dimensions of text pointing to NULL!");
+  }
+
+  const loaded_font* loaded = get_font(font);
+  if(!loaded)
+  {
+    return error(result_text_dimensions,
+                 "Cannot get dimensions of text, font is not loaded!");
+  }
+
+  cairo_text_extents_t text_extents;
+  cairo_scaled_font_text_extents(loaded->scaled_font, text, &text_extents);
+
+  text_dimensions dimensions = {.w = text_extents.width,
+                                .h = loaded->extents.height};
+
+  return ok(result_text_dimensions, dimensions);
+}
+
+result_void cairo_renderer_get_texts_dimensions(const char* const* texts,
+                                                uint32 count,
+                                                font_handle font,
+                                                text_dimensions* dimensions)
+{
+  if(!texts || !dimensions)
+  {
+    return error(result_void,
+                 "Cannot get dimensions of texts pointing to NULL!");
+  }
+
+  const loaded_font* loaded = get_font(font);
+  if(!loaded)
+  {
+    return error(result_void,
+                 "Cannot get dimensions of texts, font is not loaded!");
+  }
+
+  for(uint32 i = 0; i < count; i++)
+  {
+    cairo_text_extents_t text_extents;
+    cairo_scaled_font_text_extents(
+      loaded->scaled_font, texts[i], &text_extents);
+
+    dimensions[i] = (text_dimensions){.w = text_extents.width,
+                                      .h = loaded->extents.height};
+  }
+
+  return ok_void();
+}
+
+result_void cairo_renderer_get_glyph_table(font_handle font,
+                                           glyph_table* table)
+{
+  if(!table)
+  {
+    return error(result_void, "Cannot fill glyph table pointing to NULL!");
+  }
+
+  const loaded_font* loaded = get_font(font);
+  if(!loaded)
+  {
+    return error(result_void, "Cannot get glyph table, font is not loaded!");
+  }
+
+  table->height = loaded->extents.height;
+
+  // codepoint 0 terminates texts, it is never measured
+  table->advances[0] = 0.0;
+  table->ink_lefts[0] = 0.0;
+  table->ink_widths[0] = 0.0;
+
+  for(uint16 codepoint = 1; codepoint < GLYPH_TABLE_SIZE; codepoint++)
+  {
+    // encoding codepoint as UTF-8, Latin-1 codepoints take 2 bytes
+    char text[3] = {0};
+    if(codepoint < 0x80)
+    {
+      text[0] = (char)codepoint;
+    }
+    else
+    {
+      text[0] = (char)(0xC0 | (codepoint >> 6));
+      text[1] = (char)(0x80 | (codepoint & 0x3F));
+    }
+
+    cairo_text_extents_t text_extents;
+    cairo_scaled_font_text_extents(loaded->scaled_font, text, &text_extents);
+
+    table->advances[codepoint] = text_extents.x_advance;
+    table->ink_lefts[codepoint] = text_extents.x_bearing;
+    table->ink_widths[codepoint] = text_extents.width;
+  }
+
+  return ok_void();
+}
+
+result_void cairo_renderer_shape_text(const char* text,
+                                      font_handle font,
+                                      positioned_glyph* glyphs,
+                                      uint32 capacity,
+                                      uint32* glyphs_count)
+{
+  if(!text || !glyphs_count || (!glyphs && capacity))
+  {
+    return error(result_void,
+                 "Cannot shape text, with text (or) glyphs pointing to NULL!");
+  }
+
+  const loaded_font* loaded = get_font(font);
+  if(!loaded)
+  {
+    return error(result_void, "Cannot shape text, font is not loaded!");
+  }
+
+  // glyphs sit on baseline of text, same as texts rendered by
+  // `RENDER_TEXT` commands
+  cairo_glyph_t* cairo_glyphs = NULL;
+  int cairo_glyphs_count = 0;
+  cairo_status_t status = cairo_scaled_font_text_to_glyphs(
+    loaded->scaled_font,
+    0.0,
+    loaded->extents.height - loaded->extents.descent,
+    text,
+    -1,
+    &cairo_glyphs,
+    &cairo_glyphs_count,
+    NULL,
+    NULL,
+    NULL);
+  if(status != CAIRO_STATUS_SUCCESS)
+  {
+    return error(result_void, "Error while shaping text!");
+  }
+
+  for(uint32 i = 0; i < (uint32)cairo_glyphs_count && i < capacity; i++)
+  {
+    glyphs[i] = (positioned_glyph){.index = (uint32)cairo_glyphs[i].index,
+                                   .x = (float32)cairo_glyphs[i].x,
+                                   .y = (float32)cairo_glyphs[i].y};
+  }
+  *glyphs_count = (uint32)cairo_glyphs_count;
+
+  cairo_glyph_free(cairo_glyphs);
+
+  return ok_void();
+}
+
+/// Sets source color of target, if it's not already set.
+static void set_source_color(color c)
+{
+  if(has_source_color && c.r == source_color.r && c.g == source_color.g &&
+     c.b == source_color.b && c.a == source_color.a)
+  {
+    return;
+  }
+
+  cairo_set_source_rgba(cairo,
+                        (float32)(c.r) / 255.0f,
+                        (float32)(c.g) / 255.0f,
+                        (float32)(c.b) / 255.0f,
+                        (float32)(c.a) / 255.0f);
+  source_color = c;
+  has_source_color = true;
+}
+
+/// Sets font of target, if it's not already set.
+/// Texts are rendered in paint order, so font is switched only between
+/// texts of different fonts.
+static void set_font(const loaded_font* font)
+{
+  if(font->scaled_font == current_font)
+  {
+    return;
+  }
+
+  cairo_set_scaled_font(cairo, font->scaled_font);
+  current_font = font->scaled_font;
+}
+
+// replaces clip of target, pixel aligned rects are clipped by cairo without
+// rasterizing a clip path
+static void set_clip_rect(rect clip_rect)
+{
+  cairo_reset_clip(cairo);
+  cairo_rectangle(cairo, clip_rect.x, clip_rect.y, clip_rect.w, clip_rect.h);
+  cairo_clip(cairo);
+}
+
+result_void cairo_renderer_process_command(const command* cmd)
+{
+  if(!cmd)
+  {
+    return error(result_void, "Cannot process command pointing to NULL!");
+  }
+
+  if(!cairo)
+  {
+    return error(result_void, "Cannot process command, target is not set!");
+  }
+
+  switch(cmd->type)
+  {
+  case RENDER_RECT: {
+    const rect bounding_rect = cmd->data.render_rect.bounding_rect;
+    const color rect_color = cmd->data.render_rect.rect_color;
+    cairo_rectangle(cairo,
+                    bounding_rect.x,
+                    bounding_rect.y,
+                    bounding_rect.w,
+                    bounding_rect.h);
+    set_source_color(rect_color);
+    cairo_fill(cairo);
+    break;
+  }
+  case RENDER_RECTS: {
+    // single path and fill for all rects
+    const render_rects_data* data = &cmd->data.render_rects;
+    for(uint16 i = 0; i < data->rects_count; i++)
+    {
+      const rect bounding_rect = data->rects[i];
+      cairo_rectangle(cairo,
+                      bounding_rect.x,
+                      bounding_rect.y,
+                      bounding_rect.w,
+                      bounding_rect.h);
+    }
+    set_source_color(data->rects_color);
+    cairo_fill(cairo);
+    break;
+  }
+  case RENDER_ROUNDED_RECT: {
+    const rect bounding_rect = cmd->data.render_rounded_rect.bounding_rect;
+    const uint8 border_radius = cmd->data.render_rounded_rect.border_radius;
+    const color rect_color = cmd->data.render_rounded_rect.rect_color;
+    set_source_color(rect_color);
+    cairo_new_sub_path(cairo);
+    cairo_arc(cairo,
+              bounding_rect.x + border_radius,
+              bounding_rect.y + border_radius,
+              border_radius,
+              M_PI,
+              3 * M_PI / 2);
+    cairo_arc(cairo,
+              bounding_rect.x + bounding_rect.w - border_radius,
+              bounding_rect.y + border_radius,
+              border_radius,
+              3 * M_PI / 2,
+              2 * M_PI);
+    cairo_arc(cairo,
+              bounding_rect.x + bounding_rect.w - border_radius,
+              bounding_rect.y + bounding_rect.h - border_radius,
+              border_radius,
+              0,
+              M_PI / 2);
+    cairo_arc(cairo,
+              bounding_rect.x + border_radius,
+              bounding_rect.y + bounding_rect.h - border_radius,
+              border_radius,
+              M_PI / 2,
+              M_PI);
+    cairo_close_path(cairo);
+    cairo_fill(cairo);
+    break;
+  }
+  case RENDER_RECT_OUTLINED: {
+    const rect bounding_rect = cmd->data.render_rect.bounding_rect;
+    const color rect_color = cmd->data.render_rect.rect_color;
+    cairo_rectangle(cairo,
+                    bounding_rect.x,
+                    bounding_rect.y,
+                    bounding_rect.w,
+                    bounding_rect.h);
+    set_source_color(rect_color);
+    cairo_stroke(cairo);
+    break;
+  }
+  case RENDER_TEXT: {
+    const char* text = cmd->data.render_text.text;
+    const color text_color = cmd->data.render_text.text_color;
+    const point text_coordinates = cmd->data.render_text.text_coordinates;
+    const loaded_font* font = get_font(cmd->data.render_text.font);
+    if(!font)
+    {
+      return error(result_void, "Cannot render text, font is not loaded!");
+    }
+    set_source_color(text_color);
+    set_font(font);
+    cairo_move_to(
+      cairo,
+      text_coordinates.x,
+      text_coordinates.y + font->extents.height - font->extents.descent);
+    cairo_show_text(cairo, text);
+    break;
+  }
+  case RENDER_GLYPH_RUN: {
+    const render_glyph_run_data* data = &cmd->data.render_glyph_run;
+    const loaded_font* font = get_font(data->font);
+    if(!font)
+    {
+      return error(result_void,
+                   "Cannot render glyph run, font is not loaded!");
+    }
+
+    if(render_glyphs_capacity < data->glyphs_count)
+    {
+      cairo_glyph_t* glyphs = (cairo_glyph_t*)realloc(
+        render_glyphs, data->glyphs_count * sizeof(cairo_glyph_t));
+      if(!glyphs)
+      {
+        return error(result_void,
+                     "Unable to allocate memory for rendering glyph run!");
+      }
+      render_glyphs = glyphs;
+      render_glyphs_capacity = data->glyphs_count;
+    }
+
+    // glyphs are already shaped, only placing them at text's coordinates
+    for(uint16 i = 0; i < data->glyphs_count; i++)
+    {
+      render_glyphs[i] = (cairo_glyph_t){
+        .index = data->glyphs[i].index,
+        .x = data->text_coordinates.x + (float64)data->glyphs[i].x,
+        .y = data->text_coordinates.y + (float64)data->glyphs[i].y};
+    }
+
+    set_source_color(data->text_color);
+    set_font(font);
+    cairo_show_glyphs(cairo, render_glyphs, data->glyphs_count);
+    break;
+  }
+  case PUSH_CLIP_RECT:
+  case POP_CLIP_RECT: {
+    // clip rect is already intersected with enclosing clip rects
+    set_clip_rect(cmd->data.clip_rect);
+    break;
+  }
+  case CLEAR_WINDOW: {
+    set_source_color((color){.r = 0, .g = 0, .b = 0, .a = 255});
+    cairo_fill(cairo);
+    break;
+  }
+  default:
+    break;
+  }
+
+  return ok_void();
+}
@@ -0,0 +1,71 @@
+#ifndef SMOLL_WIDGETS__CAIRO_RENDERER_H
+#define SMOLL_WIDGETS__CAIRO_RENDERER_H
+
+#include <cairo.h>
+#include "../../include/backend.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Cairo Renderer
+/// Rasterizes commands into a cairo instance, and measures & shapes texts
+/// with the fonts it has loaded. Shared by Cairo based backends, which own
+/// the target cairo instance, and handle cursor commands themselves.
+///
+/// Texts are measured with a cairo instance of renderer, so they can be
+/// measured on UI thread while target is rendered into on another thread.
+/// Backends rendering on another thread must hold their render lock while
+/// loading fonts, as rendering reads them.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Initializes renderer, creating its cairo instance for measuring
+///        texts.
+/// @return Void result.
+result_void cairo_renderer_init();
+
+/// @brief Frees fonts and cairo instance of renderer. Target is not
+///        destroyed, as it is owned by backend.
+void cairo_renderer_deinit();
+
+/// @brief Sets cairo instance commands are rasterized into.
+///        Call this again whenever backend creates its target again.
+/// @param target cairo instance owned by backend.
+void cairo_renderer_set_target(cairo_t* target);
+
+/// @brief Loads font under handle, replacing font loaded under it.
+///        Implements `render_backend.load_font`.
+/// @return Void result.
+result_void cairo_renderer_load_font(font_handle font,
+                                     const char* font_name,
+                                     uint8 font_size);
+
+/// @brief Implements `render_backend.get_text_dimensions`.
+/// @return Text dimensions result.
+result_text_dimensions cairo_renderer_get_text_dimensions(const char* text,
+                                                          font_handle font);
+
+/// @brief Implements `render_backend.get_texts_dimensions`.
+/// @return Void result.
+result_void cairo_renderer_get_texts_dimensions(const char* const* texts,
+                                                uint32 count,
+                                                font_handle font,
+                                                text_dimensions* dimensions);
+
+/// @brief Implements `render_backend.get_glyph_table`.
+/// @return Void result.
+result_void cairo_renderer_get_glyph_table(font_handle font,
+                                           glyph_table* table);
+
+/// @brief Implements `render_backend.shape_text`.
+/// @return Void result.
+result_void cairo_renderer_shape_text(const char* text,
+                                      font_handle font,
+                                      positioned_glyph* glyphs,
+                                      uint32 capacity,
+                                      uint32* glyphs_count);
+
+/// @brief Rasterizes command into target. Cursor commands are ignored, as
+///        cursors belong to backend's window.
+/// @param cmd pointer to command.
+/// @return Void result.
+result_void cairo_renderer_process_command(const command* cmd);
+
+#endif
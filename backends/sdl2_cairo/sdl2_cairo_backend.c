@@ -1,16 +1,35 @@
 #include "sdl2_cairo_backend.h"
 #include <stdlib.h>
+#include <string.h>
+#include "../../include/damage_region.h"
 #include "../../include/macros.h"
+#include "../cairo/cairo_renderer.h"
 
 static SDL_Window* window = NULL;
 static cairo_t* cairo = NULL;
 
+// render thread
+static SDL_Thread* render_thread = NULL;
+static SDL_sem* render_requests = NULL;
+static SDL_mutex* cairo_lock = NULL;
+static SDL_atomic_t render_thread_quit;
+static smoll_context* render_context = NULL;
+static Uint32 frame_released_event_type = (Uint32)-1;
+
+// size of window, recorded on UI thread whenever window's cairo instance
+// is created, as render thread can't query SDL2 window
+static uint16 window_width = 0, window_height = 0;
+
+// area of window painted by a command buffer, uploaded to the screen
+static damage_region* damage = NULL;
+
 // cursors
 typedef SDL_Cursor* SDL_CursorPtr;
 SDL_CursorPtr arrow = NULL, ibeam = NULL, move = NULL, crosshair = NULL,
               resize_left_right = NULL, resize_top_left__bottom_right = NULL,
               resize_top_right__bottom_left = NULL, resize_top_bottom = NULL,
               hand = NULL, processing = NULL, loading = NULL, prohibited = NULL;
+static SDL_Cursor* current_cursor = NULL;
 
 result_void init_sdl2();
 result_void init_cairo();
@@ -18,9 +37,9 @@ result_void init_cairo();
 void deinit_sdl2();
 void deinit_cairo();
 
-result_void sdl2_cairo_backend_load_font(const char* font, uint8 font_size);
-result_text_dimensions sdl2_cairo_backend_get_text_dimensions(
-  const char* text, const char* font_name, uint8 font_size);
+result_void sdl2_cairo_backend_load_font(font_handle font,
+                                         const char* font_name,
+                                         uint8 font_size);
 result_void sdl2_cairo_backend_process_command(const command* cmd);
 result_void
 sdl2_cairo_backend_process_command_buffer(const command_buffer* cmd_buffer);
@@ -37,15 +56,29 @@ result_render_backend_ptr sdl2_cairo_backend_create()
   backend->name = "SDL2 + Cairo";
   backend->backend_version = (version){1, 0, 0};
   backend->supports_curve_rendering = true;
+  backend->supports_batched_rects = true;
 
   backend->load_font = sdl2_cairo_backend_load_font;
-  backend->get_text_dimensions = sdl2_cairo_backend_get_text_dimensions;
+  backend->get_text_dimensions = cairo_renderer_get_text_dimensions;
+  backend->get_texts_dimensions = cairo_renderer_get_texts_dimensions;
+  backend->get_glyph_table = cairo_renderer_get_glyph_table;
+  backend->shape_text = cairo_renderer_shape_text;
   backend->process_command = sdl2_cairo_backend_process_command;
   backend->process_command_buffer = sdl2_cairo_backend_process_command_buffer;
 
   init_sdl2();
+  cairo_renderer_init();
   init_cairo();
 
+  cairo_lock = SDL_CreateMutex();
+
+  result_damage_region_ptr _ = damage_region_new();
+  if(!_.ok)
+  {
+    return error(result_render_backend_ptr, _.error);
+  }
+  damage = _.value;
+
   // loading cursors
   arrow = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_ARROW);
   ibeam = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_IBEAM);
@@ -102,6 +135,12 @@ result_void sdl2_cairo_backend_destroy(render_backend* backend)
   SDL_FreeCursor(loading);
   SDL_FreeCursor(prohibited);
 
+  sdl2_cairo_backend_stop_render_thread();
+  SDL_DestroyMutex(cairo_lock);
+
+  damage_region_free(damage);
+  damage = NULL;
+
   deinit_cairo();
   deinit_sdl2();
 
@@ -110,209 +149,170 @@ result_void sdl2_cairo_backend_destroy(render_backend* backend)
   return ok_void();
 }
 
-result_void sdl2_cairo_backend_load_font(const char* font, uint8 font_size)
+result_void sdl2_cairo_backend_load_font(font_handle font,
+                                         const char* font_name,
+                                         uint8 font_size)
 {
-  if(!font)
-  {
-    return error(result_void, "Cannot load font pointing to NULL!");
-  }
-
-  cairo_select_font_face(cairo, font, 0, 0);
-  cairo_set_font_size(cairo, font_size);
+  // waiting for render thread, as it reads fonts while rendering, and
+  // loading a font may move them
+  SDL_LockMutex(cairo_lock);
+  result_void _ = cairo_renderer_load_font(font, font_name, font_size);
+  SDL_UnlockMutex(cairo_lock);
 
-  return ok_void();
+  return _;
 }
 
-result_text_dimensions sdl2_cairo_backend_get_text_dimensions(
-  const char* text, const char* font_name, uint8 font_size)
+/// Sets cursor, if it's not already set.
+static void set_cursor(SDL_Cursor* cursor)
 {
-  if(!text)
-  {
-    return error(result_text_dimensions,
-                 "Cannot get dimensions of text pointing to NULL!");
-  }
-
-  if(!font_name)
+  if(cursor == current_cursor)
   {
-    return error(result_text_dimensions,
-                 "Cannot get dimensions of text, with font pointing to NULL");
+    return;
   }
 
-  // sdl2_cairo_backend_load_font(font_name, font_size);
-
-  cairo_font_extents_t font_extents;
-  cairo_font_extents(cairo, &font_extents);
-  cairo_text_extents_t text_extents;
-  cairo_text_extents(cairo, text, &text_extents);
-
-  text_dimensions dimensions = {.w = text_extents.width,
-                                .h = font_extents.height};
-
-  return ok(result_text_dimensions, dimensions);
+  SDL_SetCursor(cursor);
+  current_cursor = cursor;
 }
 
-result_void sdl2_cairo_backend_process_command(const command* cmd)
+/// Sets cursor right away, (or) records it in `frame_cursor` if it's not
+/// `NULL`, to be set on UI thread when frame is presented.
+static void request_cursor(SDL_Cursor* cursor, SDL_Cursor** frame_cursor)
 {
-  if(!cmd)
+  if(frame_cursor)
   {
-    return error(result_void, "Cannot process command pointing to NULL!");
+    *frame_cursor = cursor;
+    return;
   }
 
+  set_cursor(cursor);
+}
+
+/// Processes command, recording cursor it sets in `frame_cursor` if it's
+/// not `NULL`.
+static result_void process_command(const command* cmd,
+                                   SDL_Cursor** frame_cursor)
+{
   switch(cmd->type)
   {
-  case RENDER_RECT: {
-    const rect bounding_rect = cmd->data.render_rect.bounding_rect;
-    const color rect_color = cmd->data.render_rect.rect_color;
-    cairo_rectangle(cairo,
-                    bounding_rect.x,
-                    bounding_rect.y,
-                    bounding_rect.w,
-                    bounding_rect.h);
-    cairo_set_source_rgba(cairo,
-                          (float32)(rect_color.r) / 255.0f,
-                          (float32)(rect_color.g) / 255.0f,
-                          (float32)(rect_color.b) / 255.0f,
-                          (float32)(rect_color.a) / 255.0f);
-    cairo_fill(cairo);
-    break;
-  }
-  case RENDER_ROUNDED_RECT: {
-    const rect bounding_rect = cmd->data.render_rounded_rect.bounding_rect;
-    const uint8 border_radius = cmd->data.render_rounded_rect.border_radius;
-    const color rect_color = cmd->data.render_rounded_rect.rect_color;
-    cairo_set_source_rgba(cairo,
-                          (float32)(rect_color.r) / 255.0f,
-                          (float32)(rect_color.g) / 255.0f,
-                          (float32)(rect_color.b) / 255.0f,
-                          (float32)(rect_color.a) / 255.0f);
-    cairo_new_sub_path(cairo);
-    cairo_arc(cairo,
-              bounding_rect.x + border_radius,
-              bounding_rect.y + border_radius,
-              border_radius,
-              M_PI,
-              3 * M_PI / 2);
-    cairo_arc(cairo,
-              bounding_rect.x + bounding_rect.w - border_radius,
-              bounding_rect.y + border_radius,
-              border_radius,
-              3 * M_PI / 2,
-              2 * M_PI);
-    cairo_arc(cairo,
-              bounding_rect.x + bounding_rect.w - border_radius,
-              bounding_rect.y + bounding_rect.h - border_radius,
-              border_radius,
-              0,
-              M_PI / 2);
-    cairo_arc(cairo,
-              bounding_rect.x + border_radius,
-              bounding_rect.y + bounding_rect.h - border_radius,
-              border_radius,
-              M_PI / 2,
-              M_PI);
-    cairo_close_path(cairo);
-    cairo_fill(cairo);
-    break;
-  }
-  case RENDER_RECT_OUTLINED: {
-    const rect bounding_rect = cmd->data.render_rect.bounding_rect;
-    const color rect_color = cmd->data.render_rect.rect_color;
-    cairo_rectangle(cairo,
-                    bounding_rect.x,
-                    bounding_rect.y,
-                    bounding_rect.w,
-                    bounding_rect.h);
-    cairo_set_source_rgba(cairo,
-                          (float32)(rect_color.r) / 255.0f,
-                          (float32)(rect_color.g) / 255.0f,
-                          (float32)(rect_color.b) / 255.0f,
-                          (float32)(rect_color.a) / 255.0f);
-    cairo_stroke(cairo);
-    break;
-  }
-  case RENDER_TEXT: {
-    const char* text = cmd->data.render_text.text;
-    const color text_color = cmd->data.render_text.text_color;
-    const point text_coordinates = cmd->data.render_text.text_coordinates;
-    cairo_set_source_rgba(cairo,
-                          (float32)(text_color.r) / 255.0f,
-                          (float32)(text_color.g) / 255.0f,
-                          (float32)(text_color.b) / 255.0f,
-                          (float32)(text_color.a) / 255.0f);
-    cairo_font_extents_t font_extents;
-    cairo_font_extents(cairo, &font_extents);
-    cairo_move_to(cairo,
-                  text_coordinates.x,
-                  text_coordinates.y + font_extents.height -
-                    font_extents.descent);
-    cairo_show_text(cairo, text);
-    break;
-  }
-  case PUSH_CLIP_RECT: {
-    rect clip_rect = cmd->data.clip_rect;
-    cairo_rectangle(cairo, clip_rect.x, clip_rect.y, clip_rect.w, clip_rect.h);
-    cairo_clip(cairo);
-    break;
-  }
-  case POP_CLIP_RECT: {
-    cairo_reset_clip(cairo);
-    break;
-  }
   case SET_CURSOR_ARROW: {
-    SDL_SetCursor(arrow);
+    request_cursor(arrow, frame_cursor);
     break;
   }
   case SET_CURSOR_IBEAM: {
-    SDL_SetCursor(ibeam);
+    request_cursor(ibeam, frame_cursor);
     break;
   }
   case SET_CURSOR_MOVE: {
-    SDL_SetCursor(move);
+    request_cursor(move, frame_cursor);
     break;
   }
   case SET_CURSOR_CROSSHAIR: {
-    SDL_SetCursor(crosshair);
+    request_cursor(crosshair, frame_cursor);
     break;
   }
   case SET_CURSOR_HAND: {
-    SDL_SetCursor(hand);
+    request_cursor(hand, frame_cursor);
     break;
   }
   case SET_CURSOR_LOADING: {
-    SDL_SetCursor(loading);
+    request_cursor(loading, frame_cursor);
     break;
   }
   case SET_CURSOR_PROCESSING: {
-    SDL_SetCursor(processing);
+    request_cursor(processing, frame_cursor);
     break;
   }
   case SET_CURSOR_PROHIBITED: {
-    SDL_SetCursor(prohibited);
+    request_cursor(prohibited, frame_cursor);
     break;
   }
   case SET_CURSOR_RESIZE_LEFT_RIGHT: {
-    SDL_SetCursor(resize_left_right);
+    request_cursor(resize_left_right, frame_cursor);
     break;
   }
   case SET_CURSOR_RESIZE_TOP_BOTTOM: {
-    SDL_SetCursor(resize_top_bottom);
+    request_cursor(resize_top_bottom, frame_cursor);
     break;
   }
   case SET_CURSOR_RESIZE_TOP_LEFT__BOTTOM_RIGHT: {
-    SDL_SetCursor(resize_top_left__bottom_right);
+    request_cursor(resize_top_left__bottom_right, frame_cursor);
     break;
   }
   case SET_CURSOR_RESIZE_TOP_RIGHT__BOTTOM_LEFT: {
-    SDL_SetCursor(resize_top_right__bottom_left);
-    break;
-  }
-  case CLEAR_WINDOW: {
-    cairo_set_source_rgb(cairo, 0.0f, 0.0f, 0.0f);
-    cairo_fill(cairo);
+    request_cursor(resize_top_right__bottom_left, frame_cursor);
     break;
   }
   default:
-    break;
+    return cairo_renderer_process_command(cmd);
+  }
+
+  return ok_void();
+}
+
+result_void sdl2_cairo_backend_process_command(const command* cmd)
+{
+  if(!cmd)
+  {
+    return error(result_void, "Cannot process command pointing to NULL!");
+  }
+
+  return process_command(cmd, NULL);
+}
+
+/// Rasterizes commands of buffer into window surface, without presenting it.
+/// Gives the damaged rects of window surface in `damaged`. Cursor is set
+/// right away, (or) recorded in `frame_cursor` if it's not `NULL`.
+static result_void render_command_buffer(const command_buffer* cmd_buffer,
+                                         damage_span* damaged,
+                                         SDL_Cursor** frame_cursor)
+{
+  *damaged = (damage_span){0};
+
+  if(command_buffer_length(cmd_buffer) < 1)
+  {
+    return ok_void();
+  }
+
+  damage_region_reset(damage, window_width, window_height);
+
+  result_void _ = damage_region_add_command_buffer(damage, cmd_buffer);
+  if(!_.ok)
+  {
+    return _;
+  }
+
+  // processing one segment of commands at a time
+  uint32 segments_count = command_buffer_get_segments_count(cmd_buffer);
+  for(uint32 s = 0; s < segments_count; s++)
+  {
+    command_span span = command_buffer_get_segment(cmd_buffer, s);
+    for(uint32 i = 0; i < span.length; i++)
+    {
+      result_void __ = process_command(&span.commands[i], frame_cursor);
+      if(!__.ok)
+      {
+        return __;
+      }
+    }
+  }
+
+  *damaged = damage_region_get_rects(damage);
+
+  return ok_void();
+}
+
+/// Copies damaged rects of window surface to window.
+/// Must be called from UI (main) thread, as SDL2 requires.
+static result_void present_rects(const SDL_Rect* rects, int count)
+{
+  if(count < 1)
+  {
+    return ok_void();
+  }
+
+  if(SDL_UpdateWindowSurfaceRects(window, rects, count) != 0)
+  {
+    return error(result_void, "Unable to update window surface rects!");
   }
 
   return ok_void();
@@ -327,89 +327,198 @@ sdl2_cairo_backend_process_command_buffer(const command_buffer* cmd_buffer)
                  "Cannot process command buffer pointing to NULL!");
   }
 
-  int16 buffer_length = command_buffer_length(cmd_buffer);
-  if(buffer_length < 1)
+  damage_span damaged;
+  result_void _ = render_command_buffer(cmd_buffer, &damaged, NULL);
+  if(!_.ok)
   {
-    return ok_void();
+    return _;
   }
 
-  // allocating a constant size array, as MSVC doesn't support VLAs.
-  // SDL_Rect rects_to_update[buffer_length];
-  SDL_Rect rects_to_update[500];
-  int last_rect_index = 0;
-
-  result_command_buffer_const_iterator_ptr _ =
-    command_buffer_const_iterator_new(cmd_buffer);
-  if(!_.ok)
+  SDL_Rect rects_to_update[DAMAGE_REGION_RECTS_MAX];
+  for(uint16 i = 0; i < damaged.length; i++)
   {
-    return error(result_void, _.error);
+    rects_to_update[i] = rect_to_sdl_rect(damaged.rects[i]);
   }
 
-  command_buffer_const_iterator* iterator = _.value;
+  return present_rects(rects_to_update, damaged.length);
+}
+
+static int render_thread_main(void* data)
+{
+  (void)data;
 
-  for(int16 i = 0; i < buffer_length; i++)
+  while(1)
   {
-    if(!iterator->good)
+    SDL_SemWait(render_requests);
+    if(SDL_AtomicGet(&render_thread_quit))
     {
       break;
     }
 
-    result_const_command_ptr __ = iterator->next_cmd(iterator);
-    if(!__.ok)
+    result_const_command_buffer_ptr _ =
+      smoll_context_acquire_frame(render_context);
+    if(!_.ok || !_.value)
     {
-      return error(result_void, __.error);
+      continue;
     }
 
-    const command* cmd = __.value;
-    switch(cmd->type)
+    // rasterizing here, but leaving presenting to UI thread, as SDL2 video
+    // functions can be called only from main thread.
+    // damaged rects & last cursor set by frame are handed over with frame
+    // released event.
+    SDL_Rect* rects_to_update = NULL;
+    uint16 rects_count = 0;
+    SDL_Cursor* frame_cursor = NULL;
+
+    SDL_LockMutex(cairo_lock);
+    damage_span damaged;
+    result_void __ = render_command_buffer(_.value, &damaged, &frame_cursor);
+    if(__.ok && damaged.length > 0)
     {
-    case RENDER_RECT: {
-      rects_to_update[i] =
-        rect_to_sdl_rect(cmd->data.render_rect.bounding_rect);
-      last_rect_index = i;
-      break;
-    }
-    case RENDER_ROUNDED_RECT: {
-      rects_to_update[i] =
-        rect_to_sdl_rect(cmd->data.render_rounded_rect.bounding_rect);
-      last_rect_index = i;
-      break;
-    }
-    case RENDER_RECT_OUTLINED: {
-      rects_to_update[i] =
-        rect_to_sdl_rect(cmd->data.render_rect.bounding_rect);
-      last_rect_index = i;
-      break;
-    }
-    case CLEAR_WINDOW: {
-      int window_width = 0, window_height = 0;
-      SDL_GetWindowSize(window, &window_width, &window_height);
-      rects_to_update[i] =
-        (SDL_Rect){.x = 0, .y = 0, .w = window_width, .h = window_height};
-      last_rect_index = i;
-      break;
-    }
-    default: {
-      break;
-    };
+      rects_to_update =
+        (SDL_Rect*)malloc(damaged.length * sizeof(SDL_Rect));
+      if(rects_to_update)
+      {
+        for(uint16 i = 0; i < damaged.length; i++)
+        {
+          rects_to_update[i] = rect_to_sdl_rect(damaged.rects[i]);
+        }
+        rects_count = damaged.length;
+      }
     }
+    SDL_UnlockMutex(cairo_lock);
 
-    result_void ___ = sdl2_cairo_backend_process_command(cmd);
-    if(!___.ok)
+    smoll_context_release_frame(render_context);
+
+    // waking up UI thread, to present this frame and to submit commands
+    // which got accumulated while this frame was being rendered
+    SDL_Event event = {.type = frame_released_event_type};
+    event.user.code = rects_count;
+    event.user.data1 = rects_to_update;
+    event.user.data2 = frame_cursor;
+    if(SDL_PushEvent(&event) != 1)
     {
-      return ___;
+      free(rects_to_update);
     }
   }
 
-  if(SDL_UpdateWindowSurfaceRects(
-       window, rects_to_update, last_rect_index + 1) != 0)
+  return 0;
+}
+
+result_void sdl2_cairo_backend_start_render_thread(smoll_context* context)
+{
+  if(!context)
   {
-    return error(result_void, "Unable to update window surface rects!");
+    return error(result_void,
+                 "Cannot start render thread for context pointing to NULL!");
+  }
+
+  if(render_thread)
+  {
+    return error(result_void, "Render thread is already running!");
+  }
+
+  frame_released_event_type = SDL_RegisterEvents(1);
+  if(frame_released_event_type == (Uint32)-1)
+  {
+    return error(result_void, "Unable to register SDL2 frame released event!");
+  }
+
+  render_requests = SDL_CreateSemaphore(0);
+  if(!render_requests)
+  {
+    return error(result_void, "Unable to create semaphore for render thread!");
+  }
+
+  render_context = context;
+  SDL_AtomicSet(&render_thread_quit, 0);
+
+  render_thread = SDL_CreateThread(render_thread_main, "render", NULL);
+  if(!render_thread)
+  {
+    SDL_DestroySemaphore(render_requests);
+    render_requests = NULL;
+    return error(result_void, "Unable to create render thread!");
   }
 
   return ok_void();
 }
 
+result_bool sdl2_cairo_backend_submit_frame(smoll_context* context)
+{
+  result_bool _ = smoll_context_submit_frame(context);
+  if(_.ok && _.value)
+  {
+    SDL_SemPost(render_requests);
+  }
+
+  return _;
+}
+
+void sdl2_cairo_backend_stop_render_thread()
+{
+  if(!render_thread)
+  {
+    return;
+  }
+
+  SDL_AtomicSet(&render_thread_quit, 1);
+  SDL_SemPost(render_requests);
+  SDL_WaitThread(render_thread, NULL);
+  render_thread = NULL;
+
+  // freeing damaged rects of frames, which weren't presented
+  SDL_Event event;
+  while(SDL_PeepEvents(&event,
+                       1,
+                       SDL_GETEVENT,
+                       frame_released_event_type,
+                       frame_released_event_type) > 0)
+  {
+    free(event.user.data1);
+  }
+
+  SDL_DestroySemaphore(render_requests);
+  render_requests = NULL;
+  render_context = NULL;
+}
+
+Uint32 sdl2_cairo_backend_get_frame_released_event_type()
+{
+  return frame_released_event_type;
+}
+
+result_void sdl2_cairo_backend_present_frame(const SDL_Event* event)
+{
+  if(!event)
+  {
+    return error(result_void,
+                 "Cannot present frame of event pointing to NULL!");
+  }
+
+  if(event->type != frame_released_event_type)
+  {
+    return error(result_void, "Cannot present frame of non frame event!");
+  }
+
+  SDL_Rect* rects_to_update = (SDL_Rect*)event->user.data1;
+
+  // locking, so render thread doesn't draw into surface while it's copied
+  SDL_LockMutex(cairo_lock);
+  result_void _ = present_rects(rects_to_update, event->user.code);
+  SDL_UnlockMutex(cairo_lock);
+
+  free(rects_to_update);
+
+  SDL_Cursor* frame_cursor = (SDL_Cursor*)event->user.data2;
+  if(frame_cursor)
+  {
+    set_cursor(frame_cursor);
+  }
+
+  return _;
+}
+
 result_void init_sdl2()
 {
   if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0)
@@ -460,12 +569,19 @@ result_void init_cairo()
 
   cairo_surface_set_device_scale(cairo_surface, 1.0, 1.0);
 
+  int w = 0, h = 0;
+  SDL_GetWindowSize(window, &w, &h);
+  window_width = (uint16)w;
+  window_height = (uint16)h;
+
   cairo = cairo_create(cairo_surface);
   if(!cairo)
   {
     return error(result_void, "Error while creating cairo instance!");
   }
 
+  cairo_renderer_set_target(cairo);
+
   cairo_surface_destroy(cairo_surface);
 
   return ok_void();
@@ -480,13 +596,17 @@ void deinit_sdl2()
 void deinit_cairo()
 {
   cairo_destroy(cairo);
+  cairo_renderer_deinit();
 }
 
 viewport_resize_event translate_sdl2_window_resize_event(SDL_WindowEvent event)
 {
   // destroying previous cairo object as SDL_Window's surface is recreated
+  // waiting for render thread, if it's using the cairo object
+  SDL_LockMutex(cairo_lock);
   cairo_destroy(cairo);
   init_cairo();
+  SDL_UnlockMutex(cairo_lock);
 
   return (viewport_resize_event){.w = (uint16)event.data1,
                                  .h = (uint16)event.data2};
@@ -495,8 +615,11 @@ viewport_resize_event translate_sdl2_window_resize_event(SDL_WindowEvent event)
 viewport_resize_event translate_sdl2_window_maximized_or_restored_event()
 {
   // destroying previous cairo object as SDL_Window's surface is recreated
+  // waiting for render thread, if it's using the cairo object
+  SDL_LockMutex(cairo_lock);
   cairo_destroy(cairo);
   init_cairo();
+  SDL_UnlockMutex(cairo_lock);
 
   int w, h;
   SDL_GetWindowSize(window, &w, &h);
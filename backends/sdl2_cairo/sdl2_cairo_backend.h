@@ -1,5 +1,6 @@
 #include "../../include/backend.h"
 #include "../../include/events.h"
+#include "../../include/smoll_context.h"
 #define SDL_MAIN_HANDLED
 #include "SDL2-Devel-2.30.4/MinGW/x86_64-w64-mingw32/include/SDL2/SDL.h"
 #include "cairo-windows-1.17.2/include/cairo.h"
@@ -21,6 +22,39 @@ cairo_t* sdl2_cairo_backend_get_cairo_instance();
 /// @return Void result.
 result_void sdl2_cairo_backend_destroy(render_backend* backend);
 
+/// @brief Starts render thread, which renders the frames submitted to
+///        the smoll context, while UI thread builds the next frame.
+///        Submit frames using `sdl2_cairo_backend_submit_frame()`.
+/// @param context pointer to smoll context.
+/// @return Void result.
+result_void sdl2_cairo_backend_start_render_thread(smoll_context* context);
+
+/// @brief Submits commands of smoll context as a frame, and wakes up
+///        render thread to render it.
+///        Call this from UI thread, after processing events.
+/// @param context pointer to smoll context.
+/// @return Bool result, `true` if a frame was submitted.
+result_bool sdl2_cairo_backend_submit_frame(smoll_context* context);
+
+/// @brief Stops render thread, after it finishes rendering in-flight frame.
+void sdl2_cairo_backend_stop_render_thread();
+
+/// @brief Gives SDL2 event type, which is pushed by render thread after
+///        it releases a frame. UI thread should present the frame using
+///        `sdl2_cairo_backend_present_frame()`, and try submitting the
+///        pending commands again on receiving this event.
+/// @return SDL2 event type.
+Uint32 sdl2_cairo_backend_get_frame_released_event_type();
+
+/// @brief Updates window with damaged rects of frame rendered by render
+///        thread, and sets the cursor last requested by frame, which are
+///        carried in frame released event.
+///        Call this from UI thread, for every frame released event, as
+///        SDL2 windows can be updated only from main thread.
+/// @param event pointer to frame released event.
+/// @return Void result.
+result_void sdl2_cairo_backend_present_frame(const SDL_Event* event);
+
 /// @brief Translates SDL2 window resize event to smoll context event.
 ///        This internally reloads the cairo object for SDL2 window surface.
 /// @param event SDL2 Window event.
@@ -66,6 +66,18 @@ int main()
   // Setting default font (or) fallback font for smoll context
   smoll_context_set_default_font(sctx, "Consolas", 14);
 
+  // Dropping commands which get painted over in the same frame
+  smoll_context_set_occlusion_culling(sctx, true);
+
+  // Merging same colored rects, dropping redundant cursor & clip commands
+  smoll_context_set_command_batching(sctx, true);
+
+  // Dropping commands of widgets which would repaint what is on screen
+  smoll_context_set_retained_rendering(sctx, true);
+
+  // Laying out & rendering changed widgets once per submitted frame
+  smoll_context_set_deferred_updates(sctx, true);
+
   // Creating root box widget
   box* bx = NULL;
   {
@@ -93,9 +105,8 @@ int main()
       printf("Error while creating split-view: %s", _.error);
     }
     split = _.value;
-    split->base->flexbox_data.container.flex_grow = 1;
-    split->base->flexbox_data.container.cross_axis_sizing =
-      CROSS_AXIS_SIZING_EXPAND;
+    widget_flex_grow(split->base) = 1;
+    widget_cross_axis_sizing(split->base) = CROSS_AXIS_SIZING_EXPAND;
   }
 
   // Creating flex-row view
@@ -108,12 +119,11 @@ int main()
   //     printf("Error while creating flex-row view: %s", _.error);
   //   }
   //   row_view = _.value;
-  //   row_view->base->flexbox_data.container.flex_grow = 1;
+  //   widget_flex_grow(row_view->base) = 1;
   //   row_view->base->flexbox_data.container.align_items = ALIGN_ITEMS_CENTER;
   //   row_view->base->flexbox_data.container.justify_content =
   //     JUSTIFY_CONTENT_START;
-  //   row_view->base->flexbox_data.container.cross_axis_sizing =
-  //     CROSS_AXIS_SIZING_EXPAND;
+  //   widget_cross_axis_sizing(row_view->base) = CROSS_AXIS_SIZING_EXPAND;
   //   row_view->base->flexbox_data.container.gap = 10;
   //   row_view->background = (color){128, 128, 128, 255};
   // }
@@ -127,9 +137,8 @@ int main()
       printf("Error while creating list-view: %s", _.error);
     }
     row_view = _.value;
-    row_view->base->flexbox_data.container.cross_axis_sizing =
-      CROSS_AXIS_SIZING_EXPAND;
-    row_view->base->flexbox_data.container.flex_grow = 1;
+    widget_cross_axis_sizing(row_view->base) = CROSS_AXIS_SIZING_EXPAND;
+    widget_flex_grow(row_view->base) = 1;
     row_view->base->flexbox_data.container.gap = 10;
   }
 
@@ -143,12 +152,11 @@ int main()
       printf("Error while creating flex-column view: %s", _.error);
     }
     col_view = _.value;
-    col_view->base->flexbox_data.container.flex_grow = 1;
+    widget_flex_grow(col_view->base) = 1;
     col_view->base->flexbox_data.container.align_items = ALIGN_ITEMS_START;
     col_view->base->flexbox_data.container.justify_content =
       JUSTIFY_CONTENT_START;
-    col_view->base->flexbox_data.container.cross_axis_sizing =
-      CROSS_AXIS_SIZING_EXPAND;
+    widget_cross_axis_sizing(col_view->base) = CROSS_AXIS_SIZING_EXPAND;
     col_view->background = (color){33, 66, 99, 255};
   }
 
@@ -445,9 +453,9 @@ int main()
       printf("Error while creating toggle: %s", _.error);
     }
     t = _.value;
-    t->base->w = 50;
-    t->base->h = 20;
-    //    t->base->flexbox_data.item.cross_axis_sizing = CROSS_AXIS_SIZING_EXPAND;
+    widget_w(t->base) = 50;
+    widget_h(t->base) = 20;
+    //    widget_cross_axis_sizing(t->base) = CROSS_AXIS_SIZING_EXPAND;
     t->handle_width_fraction = 0.4;
     t->padding_x = 2;
     t->padding_y = 2;
@@ -466,8 +474,8 @@ int main()
       printf("Error while creating progress bar: %s\n", _.error);
     }
     bar = _.value;
-    bar->base->w = 200;
-    bar->base->h = 20;
+    widget_w(bar->base) = 200;
+    widget_h(bar->base) = 20;
     bar->base->debug_name = "progress-bar";
   }
 
@@ -489,6 +497,16 @@ int main()
   /// initial window surface update
   SDL_UpdateWindowSurface(sdl2_cairo_backend_get_window());
 
+  // Rendering further updates on backend's render thread,
+  // so that rasterization doesn't block event processing
+  {
+    result_void _ = sdl2_cairo_backend_start_render_thread(sctx);
+    if(!_.ok)
+    {
+      printf("Error while starting render thread: %s", _.error);
+    }
+  }
+
   // Event Loop
   while(1)
   {
@@ -535,19 +553,32 @@ int main()
         smoll_context_process_mouse_scroll_event(
           sctx, translate_sdl2_mouse_wheel_event(event.wheel));
       }
+      else if(event.type == sdl2_cairo_backend_get_frame_released_event_type())
+      {
+        // Presenting frame rendered by render thread
+        sdl2_cairo_backend_present_frame(&event);
+      }
     }
 
     // Rendering incremental updates
     //     smoll_context_render(sctx);
 
     // Rendering all updates at once
-    smoll_context_render_send_cmd_buffer_to_backend(sctx);
+    //     smoll_context_render_send_cmd_buffer_to_backend(sctx);
+
+    // Handing over all updates to render thread, if it's not busy.
+    // Otherwise updates are accumulated and submitted when render thread
+    // releases its frame (render thread pushes frame released event).
+    sdl2_cairo_backend_submit_frame(sctx);
 
     // Updating window surface
     //     SDL_UpdateWindowSurface(sdl2_cairo_backend_get_window());
   }
 
 cleanup:
+  // Stopping render thread before destroying context it renders from
+  sdl2_cairo_backend_stop_render_thread();
+
   // Destroying smoll context
   // this also frees UI tree
   smoll_context_destroy(sctx);
@@ -1,6 +1,7 @@
 #include "win32_cairo_backend.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <winuser.h>
 #include "../../include/macros.h"
 #include "windowsx.h"
@@ -9,6 +10,22 @@
 
 static cairo_t* cairo = NULL;
 
+// fonts loaded under their handles
+typedef struct loaded_font
+{
+  cairo_scaled_font_t* scaled_font;
+  cairo_font_extents_t extents;
+} loaded_font;
+static loaded_font* fonts = NULL;
+static uint32 fonts_count = 0;
+
+// font set on cairo instance, to skip redundant font changes
+static cairo_scaled_font_t* current_font = NULL;
+
+// glyphs of glyph run being rendered, placed at coordinates of its command
+static cairo_glyph_t* render_glyphs = NULL;
+static uint32 render_glyphs_capacity = 0;
+
 // cursors
 HCURSOR arrow = NULL, ibeam = NULL, move = NULL, crosshair = NULL,
         resize_left_right = NULL, resize_top_left__bottom_right = NULL,
@@ -18,10 +35,24 @@ HCURSOR arrow = NULL, ibeam = NULL, move = NULL, crosshair = NULL,
 result_void init_cairo(HDC hdc);
 void deinit_cairo();
 
-result_void win32_cairo_backend_load_font(const char* font_name,
+result_void win32_cairo_backend_load_font(font_handle font,
+                                          const char* font_name,
                                           uint8 font_size);
-result_text_dimensions win32_cairo_backend_get_text_dimensions(
-  const char* text, const char* font_name, uint8 font_size);
+result_text_dimensions
+win32_cairo_backend_get_text_dimensions(const char* text, font_handle font);
+result_void
+win32_cairo_backend_get_texts_dimensions(const char* const* texts,
+                                         uint32 count,
+                                         font_handle font,
+                                         text_dimensions* dimensions);
+result_void win32_cairo_backend_get_glyph_table(font_handle font,
+                                               glyph_table* table);
+result_void win32_cairo_backend_shape_text(const char* text,
+                                           font_handle font,
+                                           positioned_glyph* glyphs,
+                                           uint32 capacity,
+                                           uint32* glyphs_count);
+static const loaded_font* get_font(font_handle font);
 result_void win32_cairo_backend_process_command(const command* cmd);
 
 result_render_backend_ptr win32_cairo_backend_create(HDC hdc)
@@ -39,6 +70,9 @@ result_render_backend_ptr win32_cairo_backend_create(HDC hdc)
 
   backend->load_font = win32_cairo_backend_load_font;
   backend->get_text_dimensions = win32_cairo_backend_get_text_dimensions;
+  backend->get_texts_dimensions = win32_cairo_backend_get_texts_dimensions;
+  backend->get_glyph_table = win32_cairo_backend_get_glyph_table;
+  backend->shape_text = win32_cairo_backend_shape_text;
   backend->process_command = win32_cairo_backend_process_command;
 
   init_cairo(hdc);
@@ -277,25 +311,84 @@ result_void win32_cairo_backend_process_command(const command* cmd)
                           (float32)(text_color.g) / 255.0f,
                           (float32)(text_color.b) / 255.0f,
                           (float32)(text_color.a) / 255.0f);
-    cairo_font_extents_t font_extents;
-    cairo_font_extents(cairo, &font_extents);
+    const loaded_font* font = get_font(cmd->data.render_text.font);
+    if(!font)
+    {
+      return error(result_void, "Cannot render text, font is not loaded!");
+    }
+    // texts are rendered in paint order, so font is switched only between
+    // texts of different fonts
+    if(font->scaled_font != current_font)
+    {
+      cairo_set_scaled_font(cairo, font->scaled_font);
+      current_font = font->scaled_font;
+    }
     cairo_move_to(cairo,
                   text_coordinates.x,
-                  text_coordinates.y + font_extents.height -
-                    font_extents.descent);
+                  text_coordinates.y + font->extents.height -
+                    font->extents.descent);
     cairo_show_text(cairo, text);
   }
+  else if(cmd->type == RENDER_GLYPH_RUN)
+  {
+    const render_glyph_run_data* data = &cmd->data.render_glyph_run;
+    const loaded_font* font = get_font(data->font);
+    if(!font)
+    {
+      return error(result_void,
+                   "Cannot render glyph run, font is not loaded!");
+    }
+
+    if(render_glyphs_capacity < data->glyphs_count)
+    {
+      cairo_glyph_t* glyphs = (cairo_glyph_t*)realloc(
+        render_glyphs, data->glyphs_count * sizeof(cairo_glyph_t));
+      if(!glyphs)
+      {
+        return error(result_void,
+                     "Unable to allocate memory for rendering glyph run!");
+      }
+      render_glyphs = glyphs;
+      render_glyphs_capacity = data->glyphs_count;
+    }
+
+    // glyphs are already shaped, only placing them at text's coordinates
+    for(uint16 i = 0; i < data->glyphs_count; i++)
+    {
+      render_glyphs[i] = (cairo_glyph_t){
+        .index = data->glyphs[i].index,
+        .x = data->text_coordinates.x + (float64)data->glyphs[i].x,
+        .y = data->text_coordinates.y + (float64)data->glyphs[i].y};
+    }
+
+    cairo_set_source_rgba(cairo,
+                          (float32)(data->text_color.r) / 255.0f,
+                          (float32)(data->text_color.g) / 255.0f,
+                          (float32)(data->text_color.b) / 255.0f,
+                          (float32)(data->text_color.a) / 255.0f);
+    if(font->scaled_font != current_font)
+    {
+      cairo_set_scaled_font(cairo, font->scaled_font);
+      current_font = font->scaled_font;
+    }
+    cairo_show_glyphs(cairo, render_glyphs, data->glyphs_count);
+  }
   else if(cmd->type == PUSH_CLIP_RECT)
   {
     printf("BACKEND: Command: push clip rect\n");
     rect clip_rect = cmd->data.clip_rect;
+    cairo_reset_clip(cairo);
     cairo_rectangle(cairo, clip_rect.x, clip_rect.y, clip_rect.w, clip_rect.h);
     cairo_clip(cairo);
   }
   else if(cmd->type == POP_CLIP_RECT)
   {
     printf("BACKEND: Command: pop clip rect\n");
+    // restoring clip rect which was active before push
+    rect clip_rect = cmd->data.clip_rect;
     cairo_reset_clip(cairo);
+    cairo_rectangle(cairo, clip_rect.x, clip_rect.y, clip_rect.w, clip_rect.h);
+    cairo_clip(cairo);
   }
   else if(cmd->type == SET_CURSOR_ARROW)
   {
@@ -372,9 +465,25 @@ result_void init_cairo(HDC hdc)
 void deinit_cairo()
 {
   cairo_destroy(cairo);
+
+  for(uint32 i = 0; i < fonts_count; i++)
+  {
+    if(fonts[i].scaled_font)
+    {
+      cairo_scaled_font_destroy(fonts[i].scaled_font);
+    }
+  }
+  free(fonts);
+  fonts = NULL;
+  fonts_count = 0;
+
+  free(render_glyphs);
+  render_glyphs = NULL;
+  render_glyphs_capacity = 0;
 }
 
-result_void win32_cairo_backend_load_font(const char* font_name,
+result_void win32_cairo_backend_load_font(font_handle font,
+                                          const char* font_name,
                                           uint8 font_size)
 {
   if(!font_name)
@@ -382,16 +491,68 @@ result_void win32_cairo_backend_load_font(const char* font_name,
     return error(result_void, "Cannot load font pointing to NULL!");
   }
 
-  printf("BACKEND: font face: %s, font size: %d\n", font_name, font_size);
+  printf("BACKEND: font %d face: %s, font size: %d\n",
+         font,
+         font_name,
+         font_size);
 
+  if(font >= fonts_count)
+  {
+    loaded_font* new_fonts =
+      (loaded_font*)realloc(fonts, sizeof(loaded_font) * (font + 1));
+    if(!new_fonts)
+    {
+      return error(result_void, "Unable to allocate memory for fonts!");
+    }
+    memset(new_fonts + fonts_count,
+           0,
+           sizeof(loaded_font) * (font + 1 - fonts_count));
+    fonts = new_fonts;
+    fonts_count = font + 1;
+  }
+
+  // resolving font once, texts of this handle reuse its scaled font
   cairo_select_font_face(cairo, font_name, 0, 0);
   cairo_set_font_size(cairo, font_size);
+  cairo_scaled_font_t* scaled_font =
+    cairo_scaled_font_reference(cairo_get_scaled_font(cairo));
+  if(cairo_scaled_font_status(scaled_font) != CAIRO_STATUS_SUCCESS)
+  {
+    cairo_scaled_font_destroy(scaled_font);
+    current_font = NULL;
+    return error(result_void, "Error while loading font!");
+  }
+
+  if(fonts[font].scaled_font)
+  {
+    cairo_scaled_font_destroy(fonts[font].scaled_font);
+  }
+  fonts[font].scaled_font = scaled_font;
+  cairo_scaled_font_extents(scaled_font, &fonts[font].extents);
+  current_font = scaled_font;
 
   return ok_void();
 }
 
-result_text_dimensions win32_cairo_backend_get_text_dimensions(
-  const char* text, const char* font_name, uint8 font_size)
+/// Gives font loaded under handle, (or) default font if none is loaded under
+/// it, `NULL` if neither is loaded.
+static const loaded_font* get_font(font_handle font)
+{
+  if(font < fonts_count && fonts[font].scaled_font)
+  {
+    return &fonts[font];
+  }
+
+  if(fonts_count && fonts[DEFAULT_FONT_HANDLE].scaled_font)
+  {
+    return &fonts[DEFAULT_FONT_HANDLE];
+  }
+
+  return NULL;
+}
+
+result_text_dimensions
+win32_cairo_backend_get_text_dimensions(const char* text, font_handle font)
 {
   if(!text)
   {
@@ -399,25 +560,147 @@ result_text_dimensions win32_cairo_backend_get_text_dimensions(
                  "Cannot get dimensions of text pointing to NULL!");
   }
 
-  if(!font_name)
+  const loaded_font* loaded = get_font(font);
+  if(!loaded)
   {
     return error(result_text_dimensions,
-                 "Cannot get dimensions of text, with font pointing to NULL");
+                 "Cannot get dimensions of text, font is not loaded!");
   }
 
-  // result_void _ = win32_cairo_backend_load_font(font_name, font_size);
-  // if(!_.ok)
-  // {
-  //   return error(result_text_dimensions, _.error);
-  // }
-
-  cairo_font_extents_t font_extents;
-  cairo_font_extents(cairo, &font_extents);
   cairo_text_extents_t text_extents;
-  cairo_text_extents(cairo, text, &text_extents);
+  cairo_scaled_font_text_extents(loaded->scaled_font, text, &text_extents);
 
   text_dimensions dimensions = {.w = text_extents.width,
-                                .h = font_extents.height};
+                                .h = loaded->extents.height};
 
   return ok(result_text_dimensions, dimensions);
 }
+
+result_void
+win32_cairo_backend_get_texts_dimensions(const char* const* texts,
+                                         uint32 count,
+                                         font_handle font,
+                                         text_dimensions* dimensions)
+{
+  if(!texts || !dimensions)
+  {
+    return error(result_void,
+                 "Cannot get dimensions of texts pointing to NULL!");
+  }
+
+  const loaded_font* loaded = get_font(font);
+  if(!loaded)
+  {
+    return error(result_void,
+                 "Cannot get dimensions of texts, font is not loaded!");
+  }
+
+  for(uint32 i = 0; i < count; i++)
+  {
+    cairo_text_extents_t text_extents;
+    cairo_scaled_font_text_extents(
+      loaded->scaled_font, texts[i], &text_extents);
+
+    dimensions[i] = (text_dimensions){.w = text_extents.width,
+                                      .h = loaded->extents.height};
+  }
+
+  return ok_void();
+}
+
+result_void win32_cairo_backend_get_glyph_table(font_handle font,
+                                               glyph_table* table)
+{
+  if(!table)
+  {
+    return error(result_void, "Cannot fill glyph table pointing to NULL!");
+  }
+
+  const loaded_font* loaded = get_font(font);
+  if(!loaded)
+  {
+    return error(result_void, "Cannot get glyph table, font is not loaded!");
+  }
+
+  table->height = loaded->extents.height;
+
+  // codepoint 0 terminates texts, it is never measured
+  table->advances[0] = 0.0;
+  table->ink_lefts[0] = 0.0;
+  table->ink_widths[0] = 0.0;
+
+  for(uint16 codepoint = 1; codepoint < GLYPH_TABLE_SIZE; codepoint++)
+  {
+    // encoding codepoint as UTF-8, Latin-1 codepoints take 2 bytes
+    char text[3] = {0};
+    if(codepoint < 0x80)
+    {
+      text[0] = (char)codepoint;
+    }
+    else
+    {
+      text[0] = (char)(0xC0 | (codepoint >> 6));
+      text[1] = (char)(0x80 | (codepoint & 0x3F));
+    }
+
+    cairo_text_extents_t text_extents;
+    cairo_scaled_font_text_extents(loaded->scaled_font, text, &text_extents);
+
+    table->advances[codepoint] = text_extents.x_advance;
+    table->ink_lefts[codepoint] = text_extents.x_bearing;
+    table->ink_widths[codepoint] = text_extents.width;
+  }
+
+  return ok_void();
+}
+
+result_void win32_cairo_backend_shape_text(const char* text,
+                                           font_handle font,
+                                           positioned_glyph* glyphs,
+                                           uint32 capacity,
+                                           uint32* glyphs_count)
+{
+  if(!text || !glyphs_count || (!glyphs && capacity))
+  {
+    return error(result_void,
+                 "Cannot shape text, with text (or) glyphs pointing to NULL!");
+  }
+
+  const loaded_font* loaded = get_font(font);
+  if(!loaded)
+  {
+    return error(result_void, "Cannot shape text, font is not loaded!");
+  }
+
+  // glyphs sit on baseline of text, same as texts rendered by
+  // `RENDER_TEXT` commands
+  cairo_glyph_t* cairo_glyphs = NULL;
+  int cairo_glyphs_count = 0;
+  cairo_status_t status = cairo_scaled_font_text_to_glyphs(
+    loaded->scaled_font,
+    0.0,
+    loaded->extents.height - loaded->extents.descent,
+    text,
+    -1,
+    &cairo_glyphs,
+    &cairo_glyphs_count,
+    NULL,
+    NULL,
+    NULL);
+  if(status != CAIRO_STATUS_SUCCESS)
+  {
+    return error(result_void, "Error while shaping text!");
+  }
+
+  for(uint32 i = 0; i < (uint32)cairo_glyphs_count && i < capacity; i++)
+  {
+    glyphs[i] = (positioned_glyph){.index = (uint32)cairo_glyphs[i].index,
+                                   .x = (float32)cairo_glyphs[i].x,
+                                   .y = (float32)cairo_glyphs[i].y};
+  }
+  *glyphs_count = (uint32)cairo_glyphs_count;
+
+  cairo_glyph_free(cairo_glyphs);
+
+  return ok_void();
+}
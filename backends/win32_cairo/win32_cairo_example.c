@@ -128,8 +128,8 @@ INT WINAPI WinMain(HINSTANCE hInstance,
       printf("Error while creating box: %s", _.error);
     }
     bx = _.value;
-    bx->base->w = 1080;
-    bx->base->h = 720;
+    widget_w(bx->base) = 1080;
+    widget_h(bx->base) = 720;
     bx->background = (color){255, 255, 255, 255};
     bx->base->flexbox_data.container.is_fluid = false;
   }
@@ -147,9 +147,8 @@ INT WINAPI WinMain(HINSTANCE hInstance,
       printf("Error while creating split-view: %s", _.error);
     }
     split = _.value;
-    split->base->flexbox_data.container.flex_grow = 1;
-    split->base->flexbox_data.container.cross_axis_sizing =
-      CROSS_AXIS_SIZING_EXPAND;
+    widget_flex_grow(split->base) = 1;
+    widget_cross_axis_sizing(split->base) = CROSS_AXIS_SIZING_EXPAND;
   }
 
   // Creating flex-row view
@@ -162,12 +161,11 @@ INT WINAPI WinMain(HINSTANCE hInstance,
       printf("Error while creating flex-row view: %s", _.error);
     }
     row_view = _.value;
-    row_view->base->flexbox_data.container.flex_grow = 1;
+    widget_flex_grow(row_view->base) = 1;
     row_view->base->flexbox_data.container.align_items = ALIGN_ITEMS_CENTER;
     row_view->base->flexbox_data.container.justify_content =
       JUSTIFY_CONTENT_START;
-    row_view->base->flexbox_data.container.cross_axis_sizing =
-      CROSS_AXIS_SIZING_EXPAND;
+    widget_cross_axis_sizing(row_view->base) = CROSS_AXIS_SIZING_EXPAND;
     row_view->base->flexbox_data.container.gap = 10;
     row_view->background = (color){128, 128, 128, 255};
   }
@@ -182,12 +180,11 @@ INT WINAPI WinMain(HINSTANCE hInstance,
       printf("Error while creating flex-column view: %s", _.error);
     }
     col_view = _.value;
-    col_view->base->flexbox_data.container.flex_grow = 1;
+    widget_flex_grow(col_view->base) = 1;
     col_view->base->flexbox_data.container.align_items = ALIGN_ITEMS_START;
     col_view->base->flexbox_data.container.justify_content =
       JUSTIFY_CONTENT_START;
-    col_view->base->flexbox_data.container.cross_axis_sizing =
-      CROSS_AXIS_SIZING_EXPAND;
+    widget_cross_axis_sizing(col_view->base) = CROSS_AXIS_SIZING_EXPAND;
     col_view->background = (color){33, 66, 99, 255};
   }
 
@@ -272,9 +269,9 @@ INT WINAPI WinMain(HINSTANCE hInstance,
       printf("Error while creating toggle: %s", _.error);
     }
     t = _.value;
-    t->base->w = 50;
-    t->base->h = 20;
-    //    t->base->flexbox_data.item.cross_axis_sizing = CROSS_AXIS_SIZING_EXPAND;
+    widget_w(t->base) = 50;
+    widget_h(t->base) = 20;
+    //    widget_cross_axis_sizing(t->base) = CROSS_AXIS_SIZING_EXPAND;
     t->handle_width_fraction = 0.4;
     t->padding_x = 2;
     t->padding_y = 2;
@@ -293,8 +290,8 @@ INT WINAPI WinMain(HINSTANCE hInstance,
       printf("Error while creating progress bar: %s\n", _.error);
     }
     bar = _.value;
-    bar->base->w = 200;
-    bar->base->h = 20;
+    widget_w(bar->base) = 200;
+    widget_h(bar->base) = 20;
   }
 
   // Creating checkbox
@@ -4,11 +4,6 @@
 #include "command_buffer.h"
 #include "types.h"
 
-typedef struct text_dimensions
-{
-  uint16 w, h;
-} text_dimensions;
-
 typedef struct result_text_dimensions
 {
   bool ok;
@@ -19,6 +14,39 @@ typedef struct result_text_dimensions
   };
 } result_text_dimensions;
 
+/// Font handle result.
+typedef struct result_font_handle
+{
+  bool ok;
+  union
+  {
+    font_handle value;
+    const char* error;
+  };
+} result_font_handle;
+
+/// Number of codepoints in glyph tables, those of ASCII & Latin-1.
+#define GLYPH_TABLE_SIZE 256
+
+/// Metrics of glyphs of the first `GLYPH_TABLE_SIZE` codepoints of a font,
+/// in pixels. Dimensions of texts made only of these codepoints are computed
+/// from it, without kerning. Each metric is stored in its own array, so a
+/// text is measured with plain table lookups.
+typedef struct glyph_table
+{
+  /// Horizontal advances of glyphs.
+  float64 advances[GLYPH_TABLE_SIZE];
+
+  /// Offsets of left edges of glyphs' ink, from pen position.
+  float64 ink_lefts[GLYPH_TABLE_SIZE];
+
+  /// Widths of glyphs' ink, 0 for glyphs without ink (e.g. space).
+  float64 ink_widths[GLYPH_TABLE_SIZE];
+
+  /// Height of font, height of all texts.
+  uint16 height;
+} glyph_table;
+
 typedef struct version
 {
   uint8 major, minor, patch;
@@ -32,11 +60,49 @@ typedef struct render_backend
 
   bool supports_curve_rendering;
 
-  result_void (*load_font)(const char* font_name, uint8 font_size);
+  /// Whether backend can process `RENDER_RECTS` commands.
+  /// Same colored rects are merged into these commands only if this is set.
+  bool supports_batched_rects;
+
+  /// Loads font under handle, replacing font loaded under it before.
+  /// Texts are measured & rendered with fonts of their handles, so backend
+  /// should resolve font once here, not for each text.
+  result_void (*load_font)(font_handle font,
+                           const char* font_name,
+                           uint8 font_size);
 
   result_text_dimensions (*get_text_dimensions)(const char* text,
-                                                const char* font_name,
-                                                uint8 font_size);
+                                                font_handle font);
+
+  /// Measures many texts of a font at once, filling `dimensions[i]` of
+  /// `texts[i]`.
+  /// Texts gathered in a layout pass are measured with this, so backends can
+  /// set up font once for all of them.
+  /// Optional, texts are measured one by one if this is `NULL`.
+  result_void (*get_texts_dimensions)(const char* const* texts,
+                                      uint32 count,
+                                      font_handle font,
+                                      text_dimensions* dimensions);
+
+  /// Fills glyph table of font, with which texts of ASCII & Latin-1
+  /// codepoints are measured without calling backend.
+  /// Widths must match those given by `get_text_dimensions`, i.e. the width
+  /// of ink of text, for fonts which aren't kerned.
+  /// Optional, all texts are measured by backend if this is `NULL`.
+  result_void (*get_glyph_table)(font_handle font, glyph_table* table);
+
+  /// Shapes text with font into glyphs, positioned from top-left of text.
+  /// Fills at most `capacity` glyphs, and sets `glyphs_count` to the number
+  /// of glyphs of text even if it exceeds `capacity`, so it can be shaped
+  /// again with enough room.
+  /// Widgets shape their text once, and render it with `RENDER_GLYPH_RUN`
+  /// commands until it changes, so backend must process these commands.
+  /// Optional, texts are rendered with `RENDER_TEXT` commands if `NULL`.
+  result_void (*shape_text)(const char* text,
+                            font_handle font,
+                            positioned_glyph* glyphs,
+                            uint32 capacity,
+                            uint32* glyphs_count);
 
   /// Process command.
   /// Use this api to update UI from each command.
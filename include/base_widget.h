@@ -4,6 +4,9 @@
 #include "backend.h"
 #include "command_buffer.h"
 #include "events.h"
+#include "geometry_store.h"
+#include "text_cache.h"
+#include "thread_pool.h"
 #include "types.h"
 
 /// Forward declarations
@@ -111,104 +114,388 @@ typedef struct flex_container_data
   /// Default value: `FLEX_ALIGN_START`
   flex_align_items align_items;
 
-  /// Flex grow of container when this is inside of another container.
-  /// Default value: `0`
-  uint8 flex_grow;
-
-  /// Flex shrink of container when this is inside of another container.
-  /// Default value: `0`
-  uint8 flex_shrink;
-
   /// Gap between children widgets along the flex-direction.
   /// Default value: `0`
   uint8 gap;
-
-  /// Flex cross-axis sizing of container when this is inside of
-  /// another container.
-  /// Default value: `CROSS_AXIS_SIZING_FIT_CONTENT`
-  flex_cross_axis_sizing cross_axis_sizing;
 } flex_container_data;
 
-/// @brief Flex-box related data for `FLEX_ITEM`.
-typedef struct flex_item_data
+///////////////////////////////////////////////////////////////////////////////
+/// * Display Lists
+/// Widgets retain hash of the commands they rendered last time, so commands
+/// which would repaint exactly the same pixels are not sent to backend.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Display list of a widget, retained from the last time it was
+///        rendered. Only widget's own commands are hashed, commands of its
+///        children are hashed into their own display lists.
+typedef struct display_list
 {
-  /// @brief Determines the flex-item's share of remaining space in parent.
-  /// Default value: `0`
-  uint8 flex_grow;
+  /// @brief Tells if the hashed commands are what is on screen.
+  bool valid;
 
-  /// @brief Determines the flex-item's potential to shrink.
-  /// Default value: `0`
-  uint8 flex_shrink;
+  /// @brief Hash of widget's own commands.
+  uint64 hash;
+
+  /// @brief Bounding rect of widget, when it was rendered.
+  rect geometry;
+
+  /// @brief Render pass in which widget was rendered last time.
+  uint32 render_pass;
+} display_list;
+
+/// @brief Marks absence of a render record.
+#define RENDER_RECORD_NONE UINT32_MAX
+
+/// @brief Commands rendered by a widget in current render pass.
+typedef struct render_record
+{
+  /// @brief Rendered widget.
+  base_widget* widget;
+
+  /// @brief Range of commands in command buffer, including commands of
+  ///        children.
+  uint32 begin, end;
+
+  /// @brief Index of parent widget's record, `RENDER_RECORD_NONE` for
+  ///        the widget with which render pass started.
+  uint32 parent;
+
+  /// @brief Hash of widget's own commands.
+  uint64 hash;
+
+  /// @brief Tells if widget's commands are sent to backend.
+  bool emitted;
+} render_record;
+
+/// @brief Stats of retained rendering.
+typedef struct display_list_stats
+{
+  /// @brief Number of widgets rendered.
+  uint32 widgets_rendered;
+
+  /// @brief Number of rendered widgets, whose commands were sent to backend.
+  uint32 widgets_emitted;
+
+  /// @brief Number of commands dropped, as they were already on screen.
+  uint32 commands_dropped;
+} display_list_stats;
+
+/// @brief Display list stats result.
+typedef struct result_display_list_stats
+{
+  bool ok;
+  union
+  {
+    display_list_stats value;
+    const char* error;
+  };
+} result_display_list_stats;
 
-  /// Cross axis sizing of widget.
-  /// Default value: `CROSS_AXIS_SIZING_FIT_CONTENT`
-  flex_cross_axis_sizing cross_axis_sizing;
-} flex_item_data;
+///////////////////////////////////////////////////////////////////////////////
+/// * Layout State
+/// Widgets retain size with which their children were laid out, so
+/// re-layouting skips subtrees whose constraints didn't change. Positions
+/// are relative to parent, so subtrees which only moved are not touched.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Layout state of a widget, retained from the last time its children
+///        were laid out.
+typedef struct layout_state
+{
+  /// @brief Tells if children of widget have to be laid out again, either
+  ///        the widget's size or a layout input of its subtree has changed.
+  bool layout_dirty;
+
+  /// @brief Layout generation in which children were last laid out.
+  uint32 layout_generation;
+
+  /// @brief Width of widget, when its children were laid out.
+  uint32 w;
+
+  /// @brief Height of widget, when its children were laid out.
+  uint32 h;
+} layout_state;
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Absolute Positions
+/// Widgets are positioned relative to their parent, so moving (or) scrolling
+/// a container doesn't touch its subtree. Positions relative to viewport are
+/// derived when rendering and hit-testing, and memoized until a position of
+/// any widget of context changes.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Position of a widget relative to viewport, derived from relative
+///        positions of the widget and its ancestors.
+typedef struct absolute_position
+{
+  /// @brief Position generation of context, in which position was derived.
+  uint32 generation;
+
+  /// @brief Position relative to viewport.
+  virtual_point position;
+} absolute_position;
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Measured Size
+/// Widgets sized by their content memoize the measured content size, so
+/// layout passes don't measure content which hasn't changed.
+/// Texts of widgets which are about to be measured are gathered first, and
+/// measured by backend in one call, if it supports that.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Content size measured by fit layout callback of a widget.
+typedef struct measured_size
+{
+  /// @brief Tells if dimensions are measured from widget's current content.
+  bool valid;
+
+  /// @brief Font generation of context, with which content was measured.
+  uint32 font_generation;
+
+  /// @brief Measured dimensions of content, excluding padding.
+  text_dimensions dimensions;
+} measured_size;
+
+/// @brief Text gathered to be measured in a batch.
+typedef struct batched_text
+{
+  const char* text;
+  font_handle font;
+
+  /// @brief Widget whose text it is, measured size of which is set.
+  base_widget* widget;
+} batched_text;
+
+/// @brief Texts gathered from widgets about to be fit, to be measured
+///        together if backend measures texts in batches.
+typedef struct text_batch
+{
+  batched_text* entries;
+  uint32 count;
+  uint32 capacity;
+
+  /// @brief Scratch memory for texts of a font & their dimensions, passed
+  ///        to backend.
+  const char** texts;
+  text_dimensions* dimensions;
+} text_batch;
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Fonts
+/// Fonts are registered with context under handles, which are loaded into
+/// backend once and carried by texts, so neither layout nor rendering
+/// resolves fonts by name. Each font has its own glyph table.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Font registered with context.
+typedef struct registered_font
+{
+  /// @brief Name of font, `NULL` if no font is registered under its handle.
+  char* name;
+
+  /// @brief Size of font.
+  uint8 size;
+
+  /// @brief Glyph table of font, with which texts of ASCII & Latin-1
+  ///        codepoints are measured without asking backend.
+  glyph_table* glyph_table;
+
+  /// @brief Tells if glyph table has been requested from backend, since
+  ///        font (or) backend last changed.
+  bool glyph_table_requested;
+
+  /// @brief Tells if glyph table holds metrics of font.
+  bool glyph_table_valid;
+} registered_font;
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Glyph Runs
+/// Widgets rendering text keep it shaped into glyphs by backend, if backend
+/// shapes texts, so repainting unchanged text doesn't shape it again.
+/// Glyph run is shaped again once its text (or) font changes.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Text of a widget, shaped into glyphs by backend.
+typedef struct glyph_run
+{
+  /// @brief Tells if glyphs are shaped from widget's current text & font.
+  bool valid;
+
+  /// @brief Font generation of context, with which text was shaped.
+  uint32 font_generation;
+
+  /// @brief Glyphs of text, storage is retained when text is shaped again.
+  positioned_glyph* glyphs;
+  uint32 glyphs_count;
+  uint32 capacity;
+} glyph_run;
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Traversal Stack
+/// Tree passes which need state of every ancestor walk the tree with an
+/// explicit stack instead of recursing, so depth of tree is not limited by
+/// the call stack.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Widget being visited by an iterative tree traversal.
+typedef struct traversal_frame
+{
+  /// @brief Widget being visited.
+  base_widget* widget;
+
+  /// @brief Next child node of widget to be visited, `NULL` once all
+  ///        children are visited.
+  base_widget_child_node* node;
+
+  /// @brief Group of children being laid out on thread pool, `NULL` if none.
+  thread_pool_group* parallel_children;
+} traversal_frame;
+
+/// @brief Stack of frames of an iterative tree traversal, reused across
+///        traversals. Nested traversals push above the frames of outer ones.
+typedef struct traversal_stack
+{
+  traversal_frame* frames;
+  uint32 count;
+  uint32 capacity;
+} traversal_stack;
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Deferred Updates
+/// When enabled, changes of widgets only queue their re-layout (or)
+/// re-render, and all queued widgets are updated at once per frame. Widgets
+/// queued more than once (or) below another queued widget are updated once.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Updates queued for a widget, combined as bit flags.
+typedef enum pending_update
+{
+  /// @brief No update is queued.
+  PENDING_UPDATE_NONE = 0,
+
+  /// @brief Widget has to be fit to its content, and laid out again.
+  PENDING_UPDATE_LAYOUT = 1 << 0,
+
+  /// @brief Widget has to be rendered again.
+  PENDING_UPDATE_RENDER = 1 << 1,
+
+  /// @brief Subtree of widget has to be laid out again, queued while
+  ///        running updates for ancestors whose size constraints changed.
+  PENDING_UPDATE_RELAYOUT = 1 << 2
+} pending_update;
+
+/// @brief Queue of widgets with pending updates, in order of queueing.
+typedef struct update_queue
+{
+  base_widget** widgets;
+  uint32 count;
+  uint32 capacity;
+} update_queue;
 
 ///////////////////////////////////////////////////////////////////////////////
 /// * Base Widget
 ///////////////////////////////////////////////////////////////////////////////
 
 /// @brief Base widget.
+///        Geometry & flex-box parameters read by layouting and hit-testing
+///        are kept in geometry store of widget, accessed with the
+///        `widget_*()` geometry macros. Fields read while walking the tree
+///        are kept together at the beginning, rarely read fields, callbacks
+///        and hooks come after them.
 struct base_widget
 {
-  const char* debug_name;
-
-  /// @brief Widget's x-coordinate.
-  int16 x;
-
-  /// @brief Widget's y-coordinate.
-  int16 y;
+  /// @brief Geometry store widget lives in, the store of its context (or)
+  ///        of its tree if it has no context.
+  geometry_store* geometry;
 
-  /// @brief Widget's width (including padding).
-  uint16 w;
+  /// @brief Id of widget in its geometry store.
+  uint32 geometry_id;
 
-  /// @brief Widget's height (including padding).
-  uint16 h;
+  /// @brief Offset of children from the positions they are laid out at,
+  ///        e.g. scroll offset of a scrolling container.
+  ///        Modify this value using `common_internal_set_children_offset()`.
+  virtual_point children_offset;
 
   /// @brief Widget's flex-box type.
   ///        If `FLEX_CONTAINER` this widget can have children otherwise not.
   widget_type type;
 
-  /// @brief Flex-box related data of widget.
-  union
+  /// @brief Flex-box related data of widget. Flex-item related data of
+  ///        every widget is kept in its geometry store.
+  struct
   {
     /// @brief Flex-container related data of this widget.
     flex_container_data container;
-
-    /// @brief Flex-item related data of this widget.
-    flex_item_data item;
   } flexbox_data;
 
   /// @brief Flag to know whether widget's width and height needs to be
   ///        re-calculated.
   bool need_resizing;
 
-  /// @brief Tells if widget should be taken into account while
-  ///        layouting and rendering.
-  ///
-  ///        Modify this value using the function:
-  ///        `widget_set_visibility()`.
-  ///        Changing visibility will just not render the widget, and
-  ///        gives the space taken by this widget to other children.
-  ///        The state of the widget will be the same.
-  ///        To entirely remove the widget from UI tree use function:
-  ///        `base_widget_remove_child()`.
-  bool visible;
-
-  /// @brief Pointer to derived widget.
-  ///        Casting to derived widget type is required to access it.
-  void* derived;
-
   /// @brief Parent of this widget.
   base_widget* parent;
 
   /// @brief Head of children linked list.
   base_widget_child_node* children_head;
 
+  /// @brief Tail of children linked list.
+  base_widget_child_node* children_tail;
+
+  /// @brief Number of children.
+  uint32 children_count;
+
+  /// @brief Number of widgets in subtree of this widget, excluding itself.
+  ///        Computed lazily while calculating sizes, as it is only needed
+  ///        for scheduling re-layouts.
+  uint32 descendants_count;
+
+  /// @brief Tells if `descendants_count` is up to date, children have not
+  ///        been linked (or) unlinked in subtree since it was computed.
+  bool descendants_count_valid;
+
+  /// @brief Layout state retained from the last re-layout of this widget.
+  layout_state layout;
+
+  /// @brief Memoized position of this widget relative to viewport.
+  absolute_position absolute;
+
   /// @brief Context of this widget.
   internal_context* context;
 
+  /// @brief Node enclosing this widget in its parent's children list,
+  ///        `NULL` if widget is not a child of any widget.
+  base_widget_child_node* child_node;
+
+  /// @brief Geometry ids of children in order, for looking up children by
+  ///        index and looping over their geometry. Children live in the
+  ///        geometry store of this widget.
+  ///        Patched as children are linked (or) unlinked at known positions,
+  ///        else marked stale and rebuilt on next lookup.
+  uint32* children_index;
+  uint32 children_index_capacity;
+  bool children_index_valid;
+
+  /// @brief Content size memoized by fit layout callback of this widget.
+  measured_size measured;
+
+  /// @brief Display list retained from the last render of this widget.
+  display_list display_list;
+
+  /// @brief Updates queued for this widget, combination of `pending_update`
+  ///        flags.
+  uint8 pending_updates;
+
+  /// @brief Index of this widget in context's update queue, valid only if
+  ///        updates are pending.
+  uint32 update_queue_index;
+
+  /// @brief Pointer to derived widget.
+  ///        Casting to derived widget type is required to access it.
+  void* derived;
+
+  /// @brief Name of widget, used in logs.
+  const char* debug_name;
+
   /**
    * Hook function, will be called before `internal_relayout()` is called.
    */
@@ -232,6 +519,12 @@ struct base_widget
   /// @brief Internal callback for adjusting layout of this widget.
   result_sizing_delta (*internal_fit_layout_callback)(base_widget*, bool);
 
+  /// @brief Internal callback for getting text measured by fit layout
+  ///        callback of this widget, and its font. Set only by widgets
+  ///        sized by text.
+  const char* (*internal_get_text_callback)(const base_widget*,
+                                            font_handle* font);
+
   /// @brief Internal callback for rendering this widget.
   result_bool (*internal_render_callback)(const base_widget*);
 
@@ -270,12 +563,65 @@ struct base_widget
   bool (*mouse_scroll_callback)(base_widget*, const mouse_scroll_event);
 };
 
+///////////////////////////////////////////////////////////////////////////////
+/// * Widget Geometry
+/// Geometry & flex-box parameters of widget in its geometry store. Each
+/// macro is an lvalue, so it is read and assigned like a field.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Widget's x-coordinate, relative to its parent's origin (or) to
+///        viewport for the root widget.
+///        Coordinates & sizes are 32-bit, so contents of scrolling
+///        containers can be far larger than viewport.
+#define widget_x(widget) ((widget)->geometry->x[(widget)->geometry_id])
+
+/// @brief Widget's y-coordinate, relative to its parent's origin (or) to
+///        viewport for the root widget.
+#define widget_y(widget) ((widget)->geometry->y[(widget)->geometry_id])
+
+/// @brief Widget's width (including padding).
+#define widget_w(widget) ((widget)->geometry->w[(widget)->geometry_id])
+
+/// @brief Widget's height (including padding).
+#define widget_h(widget) ((widget)->geometry->h[(widget)->geometry_id])
+
+/// @brief Tells if widget should be taken into account while layouting and
+///        rendering.
+///        Modify this value using the function: `widget_set_visibility()`.
+///        Changing visibility will just not render the widget, and gives
+///        the space taken by this widget to other children. The state of
+///        the widget will be the same.
+///        To entirely remove the widget from UI tree use function:
+///        `base_widget_remove_child()`.
+#define widget_visible(widget)                                                 \
+  ((widget)->geometry->visible[(widget)->geometry_id])
+
+/// @brief Widget's share of remaining space in parent.
+///        Modify this value using the function: `widget_set_flex_grow()`.
+#define widget_flex_grow(widget)                                               \
+  ((widget)->geometry->flex_grow[(widget)->geometry_id])
+
+/// @brief Widget's potential to shrink.
+///        Modify this value using the function: `widget_set_flex_shrink()`.
+#define widget_flex_shrink(widget)                                             \
+  ((widget)->geometry->flex_shrink[(widget)->geometry_id])
+
+/// @brief Widget's sizing along its parent's cross-axis, value of
+///        `flex_cross_axis_sizing`.
+///        Modify this value using the function:
+///        `widget_set_cross_axis_sizing()`.
+#define widget_cross_axis_sizing(widget)                                       \
+  ((widget)->geometry->cross_axis_sizing[(widget)->geometry_id])
+
 /// @brief Base widget child node.
 struct base_widget_child_node
 {
   /// @brief Child
   base_widget* child;
 
+  /// @brief Previous child node.
+  base_widget_child_node* prev;
+
   /// @brief Next child node.
   base_widget_child_node* next;
 };
@@ -294,8 +640,8 @@ struct base_widget_child_node
  * it will go on marking the parent widgets until it met the constraints.
  */
 result_base_widget_ptr common_internal_mark_need_resizing(base_widget* widget,
-                                                          int16 delta_x,
-                                                          int16 delta_y);
+                                                          int32 delta_x,
+                                                          int32 delta_y);
 
 /**
  * Internal callback for calculating minimum size needed for the widget.
@@ -310,24 +656,172 @@ result_void common_internal_calculate_size(base_widget* widget);
  *
  * Should be called by the widget in which the change of size has occurred
  * (after `internal_mark_need_resizing` and `internal_calculate_size` pass)
+ *
+ * Children of the widget are always laid out, but only those container
+ * children which are dirty (or) have changed their size are re-layouted.
+ * Positions of children are relative to widget, so container children which
+ * only moved are not touched. Every call starts a new layout generation of
+ * widget's context.
+ */
+result_void common_internal_relayout(base_widget* widget);
+
+/**
+ * Marks layout of widget and its ancestors dirty, so the next re-layout
+ * passing through them lays out their children again.
+ *
+ * Should be called whenever a layout input of widget, other than its size
+ * (flex-box properties, children, visibility) has changed.
+ */
+void common_internal_mark_layout_dirty(base_widget* widget);
+
+/**
+ * Gives content size memoized by widget's fit layout callback.
+ *
+ * @return `true` if memoized size is measured from current content of widget
+ *         and current font of its context, else `false` and content has to
+ *         be measured again.
+ */
+bool common_internal_get_measured_size(const base_widget* widget,
+                                       text_dimensions* dimensions);
+
+/**
+ * Memoizes content size measured by widget's fit layout callback.
+ */
+void common_internal_set_measured_size(base_widget* widget,
+                                       text_dimensions dimensions);
+
+/**
+ * Gathers text of widget to be measured in a batch, if widget is sized by
+ * text and its memoized content size is stale.
+ */
+result_void common_internal_batch_text(base_widget* widget);
+
+/**
+ * Invalidates memoized content size of widget.
+ * Should be called whenever content of widget (e.g. its text) changes.
+ */
+void common_internal_invalidate_measured_size(base_widget* widget);
+
+/**
+ * Adds command for rendering text of widget into command buffer of its
+ * context. Text is rendered with its glyph run if backend shapes texts,
+ * which is shaped first if it is stale, else with a `RENDER_TEXT` command.
+ * Command carries dimensions of text, memoized by widget's fit layout
+ * callback (or) measured by context, for bounding the area it paints.
+ */
+result_void common_internal_render_text(const base_widget* widget,
+                                        glyph_run* run,
+                                        const char* text,
+                                        font_handle font,
+                                        color text_color,
+                                        point text_coordinates);
+
+/**
+ * Invalidates glyph run of a widget's text.
+ * Should be called whenever text (or) font of widget changes.
  */
-result_void common_internal_relayout(const base_widget* widget);
+void common_internal_invalidate_glyph_run(glyph_run* run);
 
 /**
- * Internal callback for getting bounding rectangle of widget.
- * Will be handy when layouting.
+ * Frees glyphs of glyph run.
+ */
+void common_internal_free_glyph_run(glyph_run* run);
+
+/**
+ * Sets context of widget and its descendants, moving their geometry into the
+ * geometry store of context. Widgets get context of their parent when they
+ * are added to it, so this is needed only for the root widget.
+ * On error, nothing is changed.
+ */
+result_void common_internal_set_context(base_widget* widget,
+                                        internal_context* context);
+
+/**
+ * Rebuilds index of children of widget, if it is stale, so geometry of
+ * children is looped over by their ids in `children_index`.
+ *
+ * @return `false` if there is no memory for rebuilding index.
+ */
+bool common_internal_index_children(base_widget* widget);
+
+/**
+ * Clips virtual rectangle to the range of `rect`.
+ */
+rect common_internal_clip_virtual_rect(virtual_rect bounds);
+
+/**
+ * Internal callback for getting bounding rectangle of widget, relative to
+ * viewport. Should be used for rendering and hit-testing, as `widget_x()`
+ * and `widget_y()` of widget are relative to its parent.
+ * Parts of widget beyond the range of `rect` are clipped away, those are far
+ * outside of viewport anyway.
  */
 rect common_internal_get_bounding_rect(const base_widget* widget);
 
+/**
+ * Gives unclipped bounding rectangle of widget relative to viewport, in
+ * virtual coordinates.
+ */
+virtual_rect common_internal_get_virtual_rect(const base_widget* widget);
+
+/**
+ * Gives position of widget relative to viewport, deriving it from positions
+ * of its ancestors if it has changed since last derived.
+ */
+virtual_point common_internal_get_absolute_position(const base_widget* widget);
+
+/**
+ * Sets offset of children of widget from their laid out positions, moving
+ * the whole subtree without touching it, e.g. when scrolling.
+ */
+void common_internal_set_children_offset(base_widget* widget,
+                                         virtual_point offset);
+
 /**
  * Internal callback for adjusting layout and sizing of this widget,
  * and automatically calling this callback on parent widgets
  * if needs resizing.
+ *
+ * If deferred updates are enabled, widget is only queued for the next
+ * update.
  */
 result_bool common_internal_adjust_layout(base_widget* widget);
 
 /**
- * Internal callback for freeing UI tree recursively.
+ * Fits widget to its content, and marks ancestors which need resizing.
+ * Gives the ancestor whose subtree has to be laid out again, `NULL` if size
+ * of widget didn't change.
+ */
+result_base_widget_ptr common_internal_fit_to_content(base_widget* widget);
+
+/**
+ * Calculates sizes & re-layouts subtree of widget, calling its re-layout
+ * hooks. Subtree is not rendered.
+ */
+result_void common_internal_update_layout(base_widget* widget);
+
+/**
+ * Renders widget using its internal render callback.
+ * Widgets should render themselves and their children using this function,
+ * instead of calling internal render callback directly.
+ *
+ * If retained rendering is enabled, once the outermost render returns,
+ * commands of widgets whose own commands and geometry are same as
+ * last rendered are dropped, unless an ancestor repainted over them.
+ *
+ * If deferred updates are enabled, outermost renders only queue widget for
+ * the next update.
+ */
+result_bool common_internal_render(base_widget* widget);
+
+/**
+ * Invalidates display lists of widget and its descendants, so they are
+ * fully rendered next time.
+ */
+void common_internal_invalidate_display_list(base_widget* widget);
+
+/**
+ * Internal callback for freeing UI tree, along with children nodes.
  */
 void common_internal_free(base_widget* widget);
 
@@ -381,8 +875,8 @@ typedef struct result_base_widget_child_node_ptr
  */
 struct sizing_delta
 {
-  int16 x;
-  int16 y;
+  int32 x;
+  int32 y;
 };
 
 /**
@@ -414,22 +908,86 @@ result_void base_widget_child_node_free(base_widget_child_node* node);
 /// @return Base widget pointer result.
 result_base_widget_ptr base_widget_new(widget_type type);
 
-/// @brief Adds the given child widget to this widget.
+/// @brief Adds the given child widget to the end of this widget's children.
+///        Takes amortized constant time.
 /// @param base pointer to base widget, for which the child is to be added.
 /// @param child pointer to base widget of the child to be added.
 /// @return Void result.
 result_void base_widget_add_child(base_widget* base, base_widget* child);
 
+/// @brief Adds the given child widget after one of this widget's children.
+///        Takes constant time, index of children is rebuilt by the next
+///        lookup by index, unless the child is added after the last child.
+/// @param base pointer to base widget, for which the child is to be added.
+/// @param child pointer to base widget of the child to be added.
+/// @param after_this_widget pointer to base widget of the existing child.
+/// @return Void result.
 result_void base_widget_add_child_after(base_widget* base,
                                         base_widget* child,
                                         base_widget* after_this_widget);
 
+/// @brief Inserts the given child widget at index in this widget's children.
+///        Index equal to number of children appends the child.
+///        Takes time linear in number of children after index.
+/// @param base pointer to base widget, for which the child is to be added.
+/// @param child pointer to base widget of the child to be added.
+/// @param index index of child after insertion.
+/// @return Void result.
+result_void
+base_widget_insert_child(base_widget* base, base_widget* child, uint32 index);
+
+/// @brief Adds the given child widgets in order to the end of this widget's
+///        children. Takes time linear in number of given children.
+/// @param base pointer to base widget, for which the children are to be added.
+/// @param children array of pointers to base widgets of the children.
+/// @param children_count number of children in array.
+/// @return Void result.
+result_void base_widget_add_children(base_widget* base,
+                                     base_widget** children,
+                                     uint32 children_count);
+
+/// @brief Inserts the given child widgets in order at index in this widget's
+///        children. Index equal to number of children appends the children.
+///        Takes time linear in number of given children, and children after
+///        index, as children are spliced in at once.
+/// @param base pointer to base widget, for which the children are to be added.
+/// @param index index of first of the children after insertion.
+/// @param children array of pointers to base widgets of the children.
+/// @param children_count number of children in array.
+/// @return Void result.
+result_void base_widget_insert_children(base_widget* base,
+                                        uint32 index,
+                                        base_widget** children,
+                                        uint32 children_count);
+
+/// @brief Gets the child widget at index in this widget's children.
+///        Takes constant time, unless index of children is stale, in which
+///        case it is rebuilt.
+/// @param base pointer to base widget.
+/// @param index index of child.
+/// @return Base widget pointer result.
+result_base_widget_ptr base_widget_get_child(base_widget* base, uint32 index);
+
 /// @brief Removes the given widget from this widget's children.
+///        Unlinking takes constant time. Index of children is patched if
+///        the first (or) last child is removed, else it is rebuilt by the
+///        next lookup by index.
 /// @param base pointer to base widget, from which the child should be removed.
 /// @param child pointer to base widget of the child.
 /// @return Void result.
 result_void base_widget_remove_child(base_widget* base, base_widget* child);
 
+/// @brief Removes a range of children from this widget's children.
+///        Removed widgets are not freed. Takes time linear in number of
+///        children from index.
+/// @param base pointer to base widget, from which children should be removed.
+/// @param index index of first child to remove.
+/// @param children_count number of children to remove.
+/// @return Void result.
+result_void base_widget_remove_children(base_widget* base,
+                                        uint32 index,
+                                        uint32 children_count);
+
 /// @brief Frees the base widget.
 /// @param widget pointer to the base widget.
 /// @return Void result.
@@ -635,18 +1193,87 @@ struct internal_context
   ///        a new widget.
   base_widget* mouse_focused_widget;
 
-  /// @brief Default font for context.
-  ///        This should be loaded by backend.
-  char* font;
+  /// @brief Fonts registered with context, indexed by their handles.
+  ///        Font of `DEFAULT_FONT_HANDLE` is the default font.
+  registered_font* fonts;
+  uint32 fonts_count;
+
+  /// @brief Counter of changes to registered fonts (or) backend, content
+  ///        measured before is measured again.
+  uint32 font_generation;
 
-  /// @brief Default font size.
-  uint8 font_size;
+  /// @brief Dimensions of texts measured by backend, cleared when fonts
+  ///        change.
+  text_cache* text_cache;
+
+  /// @brief Geometry store of widgets of context.
+  geometry_store* geometry;
 
   /// @brief Command buffer.
   command_buffer* cmd_buffer;
 
   /// @brief Backend.
   render_backend* backend;
+
+  /// @brief Tells if rendered commands are diffed against display lists of
+  ///        widgets, dropping commands which are already on screen.
+  bool retained_rendering;
+
+  /// @brief Records of widgets rendered in current render pass.
+  render_record* render_records;
+  uint32 render_records_count;
+  uint32 render_records_capacity;
+
+  /// @brief Depth of nested renders in current render pass.
+  uint16 render_depth;
+
+  /// @brief Record of the widget being rendered, `RENDER_RECORD_NONE` when
+  ///        no render is in progress.
+  uint32 render_record_current;
+
+  /// @brief Counter of render passes.
+  uint32 render_pass;
+
+  /// @brief Scratch memory for diffing display lists.
+  uint32* command_owners;
+  bool* removed_commands;
+  uint32 diff_scratch_capacity;
+
+  /// @brief Stats of retained rendering, since last frame.
+  display_list_stats display_list_stats;
+
+  /// @brief Counter of layout passes.
+  uint32 layout_generation;
+
+  /// @brief Counter of changes to positions of widgets, absolute positions
+  ///        derived in an older generation are derived again.
+  uint32 position_generation;
+
+  /// @brief Thread pool on which large sibling subtrees are laid out in
+  ///        parallel, `NULL` if parallel layout is disabled.
+  thread_pool* layout_pool;
+
+  /// @brief Tells if a re-layout which may run on layout pool is in flight.
+  ///        Relayout hooks run on worker threads meanwhile, so positions
+  ///        they change are invalidated only once the re-layout finishes.
+  bool parallel_relayout;
+
+  /// @brief Scratch stack of tree traversals run on the context's thread.
+  traversal_stack traversal_stack;
+
+  /// @brief Tells if layouting & rendering of changed widgets is deferred
+  ///        to `internal_context_update()`.
+  bool deferred_updates;
+
+  /// @brief Tells if queued updates are being run, changes made meanwhile
+  ///        are applied right away.
+  bool updating;
+
+  /// @brief Widgets whose updates are deferred.
+  update_queue update_queue;
+
+  /// @brief Texts to be measured together, before widgets are fit.
+  text_batch text_batch;
 };
 
 /// @brief Internal context pointer result.
@@ -670,6 +1297,84 @@ result_internal_context_ptr internal_context_create(uint16 viewport_width,
 /// @return Void result.
 result_void internal_context_destroy(internal_context* context);
 
+/// @brief Queues updates of widget, to be run by next
+///        `internal_context_update()`.
+/// @param context pointer to internal context.
+/// @param widget pointer to the widget to update.
+/// @param updates `pending_update` flags to queue.
+/// @return Void result.
+result_void internal_context_queue_update(internal_context* context,
+                                          base_widget* widget,
+                                          uint8 updates);
+
+/// @brief Removes widget from queue of pending updates, e.g. when it is
+///        freed.
+/// @param context pointer to internal context.
+/// @param widget pointer to the widget.
+void internal_context_dequeue_update(internal_context* context,
+                                     base_widget* widget);
+
+/// @brief Runs queued updates. Queued layouts are run first, once for
+///        each subtree whose size constraints changed, then the subtrees
+///        are rendered along with queued renders, skipping widgets whose
+///        ancestor is also rendered.
+/// @param context pointer to internal context.
+/// @return Void result.
+result_void internal_context_update(internal_context* context);
+
+/// @brief Registers font under handle, and loads it into backend if one is
+///        registered. Content measured with a font replaced this way is
+///        measured again.
+/// @param context pointer to internal context.
+/// @param font handle of font.
+/// @param font_name name of font.
+/// @param font_size size of font.
+/// @return Void result.
+result_void internal_context_set_font(internal_context* context,
+                                      font_handle font,
+                                      const char* font_name,
+                                      uint8 font_size);
+
+/// @brief Loads registered fonts into backend, after backend changes.
+///        Content measured with the previous backend is measured again.
+/// @param context pointer to internal context.
+/// @return Void result.
+result_void internal_context_load_fonts(internal_context* context);
+
+/// @brief Measures text with a registered font. Texts of ASCII & Latin-1
+///        codepoints are measured with glyph table of font if backend gives
+///        it, others are asked to backend if not cached.
+/// @param context pointer to internal context.
+/// @param text the text to measure.
+/// @param font the font of text.
+/// @return Text dimensions result.
+result_text_dimensions internal_context_measure_text(internal_context* context,
+                                                     const char* text,
+                                                     font_handle font);
+
+/// @brief Gathers text of widget to be measured by next
+///        `internal_context_measure_batched_texts()`. Does nothing if
+///        backend can't measure texts in batches. Text which is cached (or)
+///        measured with glyph table is not gathered, its dimensions are set
+///        as measured size of widget right away.
+/// @param context pointer to internal context.
+/// @param widget pointer to widget whose text it is.
+/// @param text the text, must stay valid until batch is measured.
+/// @param font the font of text.
+/// @return Void result.
+result_void internal_context_batch_text(internal_context* context,
+                                        base_widget* widget,
+                                        const char* text,
+                                        font_handle font);
+
+/// @brief Measures gathered texts in one call to backend for each font, and
+///        sets their dimensions as measured sizes of their widgets, so
+///        fitting widgets doesn't call backend again. Dimensions are cached
+///        too.
+/// @param context pointer to internal context.
+/// @return Void result.
+result_void internal_context_measure_batched_texts(internal_context* context);
+
 /// @brief Gets the deepest widget which encloses the point.
 /// @param context const pointer to internal context.
 /// @param x point x-coordinate.
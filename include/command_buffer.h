@@ -26,12 +26,26 @@ typedef enum command_type
   /// Needed data: bounding rect, rect outline color.
   RENDER_RECT_OUTLINED,
 
+  /// Command for rendering multiple rectangles (filled) of same color,
+  /// at once. Produced by batching `RENDER_RECT` commands.
+  /// Needed data: rects, rects count, rects color.
+  RENDER_RECTS,
+
+  /// Command for rendering text, already shaped into glyphs by backend.
+  /// Needed data: glyphs, glyphs count, text top-left point, text color,
+  /// font.
+  RENDER_GLYPH_RUN,
+
   /// Command for pushing clip rect.
   /// Needed data: bounding rect for clipping.
+  /// In a command buffer, the rect is already intersected with enclosing
+  /// clip rects, so backends can replace their clip with it.
   PUSH_CLIP_RECT,
 
   /// Command for popping last added clip rect.
   /// Needed data: NONE
+  /// In a command buffer, it carries the clip rect which is active again
+  /// after popping, backends should restore their clip to it.
   POP_CLIP_RECT,
 
   SET_CURSOR_ARROW,
@@ -64,20 +78,92 @@ typedef struct render_rounded_rect_data
   color rect_color;
 } render_rounded_rect_data;
 
+/// Data for `RENDER_RECTS` command.
+typedef struct render_rects_data
+{
+  /// Rects to be filled.
+  /// For commands in a command buffer, this points into the command buffer's
+  /// arena, and stays valid until the command buffer is cleared.
+  const rect* rects;
+
+  /// Number of rects.
+  uint16 rects_count;
+
+  color rects_color;
+} render_rects_data;
+
 /// Data for `RENDER_LINE` command.
 typedef struct render_line_data
 {
   point begin, end;
 } render_line_data;
 
+/// Handle of a font registered with backend, see `render_backend.load_font`.
+typedef uint16 font_handle;
+
+/// Handle of default font of context.
+#define DEFAULT_FONT_HANDLE 0
+
+typedef struct text_dimensions
+{
+  uint16 w, h;
+} text_dimensions;
+
 /// Data for `RENDER_TEXT` command.
 typedef struct render_text_data
 {
+  /// Null-terminated text.
+  /// For commands in a command buffer, this points into the command buffer's
+  /// text arena, and stays valid until the command buffer is cleared.
   const char* text;
+
+  /// Length of text in bytes, excluding the null-terminator.
+  uint16 text_length;
+
+  /// Font of text.
+  font_handle font;
+
   color text_color;
   point text_coordinates;
+
+  /// Dimensions of text, as measured by backend.
+  /// `0 x 0` if not known, text is then taken to extend right & down from
+  /// its coordinates, up to the clip rect.
+  text_dimensions dimensions;
 } render_text_data;
 
+/// Glyph of a shaped text.
+typedef struct positioned_glyph
+{
+  /// Index of glyph in its font, as given by backend.
+  uint32 index;
+
+  /// Position of glyph's origin, from top-left of text.
+  float32 x, y;
+} positioned_glyph;
+
+/// Data for `RENDER_GLYPH_RUN` command.
+typedef struct render_glyph_run_data
+{
+  /// Glyphs of text, in the order they are drawn.
+  /// For commands in a command buffer, this points into the command buffer's
+  /// arena, and stays valid until the command buffer is cleared.
+  const positioned_glyph* glyphs;
+
+  /// Number of glyphs.
+  uint16 glyphs_count;
+
+  /// Font the text was shaped with.
+  font_handle font;
+
+  color text_color;
+  point text_coordinates;
+
+  /// Dimensions of text shaped into glyphs, as measured by backend.
+  /// `0 x 0` if not known, same as for `RENDER_TEXT`.
+  text_dimensions dimensions;
+} render_glyph_run_data;
+
 /// Command.
 /// Sent by widgets to command buffer, for processing by the backend.
 typedef struct command
@@ -92,11 +178,19 @@ typedef struct command
 
     render_rounded_rect_data render_rounded_rect;
 
+    /// Data of `RENDER_RECTS` command.
+    render_rects_data render_rects;
+
     /// Data of `RENDER_LINE` command.
     render_line_data render_line;
 
     /// Data of `RENDER_TEXT` command.
     render_text_data render_text;
+
+    /// Data of `RENDER_GLYPH_RUN` command.
+    render_glyph_run_data render_glyph_run;
+
+    /// Data of `PUSH_CLIP_RECT` & `POP_CLIP_RECT` commands.
     rect clip_rect;
   } data;
 } command;
@@ -122,8 +216,6 @@ typedef struct result_const_command_ptr
   };
 } result_const_command_ptr;
 
-typedef struct command_node command_node;
-
 typedef struct command_buffer command_buffer;
 
 /// Command buffer pointer result.
@@ -137,29 +229,74 @@ typedef struct result_command_buffer_ptr
   };
 } result_command_buffer_ptr;
 
-typedef struct command_buffer_const_iterator_private_data
-  command_buffer_const_iterator_private_data;
+/// Const command buffer pointer result.
+typedef struct result_const_command_buffer_ptr
+{
+  bool ok;
+  union
+  {
+    const command_buffer* value;
+    const char* error;
+  };
+} result_const_command_buffer_ptr;
 
-typedef struct command_buffer_const_iterator
+/// Contiguous view over the commands stored in a segment of command buffer.
+/// The view is valid until the command buffer is modified (adding commands,
+/// clearing or freeing the buffer).
+typedef struct command_span
 {
-  const command_buffer* cmd_buffer;
-  bool good;
+  /// Pointer to first command, `NULL` if there are no commands.
+  const command* commands;
 
-  result_const_command_ptr (*next_cmd)(
-    struct command_buffer_const_iterator* const_iterator);
+  /// Number of commands in the span.
+  uint32 length;
+} command_span;
 
-  command_buffer_const_iterator_private_data* private_data;
-} command_buffer_const_iterator;
+/// Statistics of occlusion culling pass over a command buffer.
+typedef struct command_culling_stats
+{
+  /// Number of commands in command buffer before culling.
+  uint32 commands_total;
+
+  /// Number of commands dropped, as they were fully covered by
+  /// later opaque rects.
+  uint32 commands_culled;
+} command_culling_stats;
 
-typedef struct result_command_buffer_const_iterator_ptr
+/// Command culling stats result.
+typedef struct result_command_culling_stats
 {
   bool ok;
   union
   {
-    command_buffer_const_iterator* value;
+    command_culling_stats value;
     const char* error;
   };
-} result_command_buffer_const_iterator_ptr;
+} result_command_culling_stats;
+
+/// Statistics of batching pass over a command buffer.
+typedef struct command_batching_stats
+{
+  /// Number of commands in command buffer before batching.
+  uint32 commands_total;
+
+  /// Number of `RENDER_RECT` commands merged into `RENDER_RECTS` commands.
+  uint32 commands_merged;
+
+  /// Number of redundant state commands dropped.
+  uint32 commands_dropped;
+} command_batching_stats;
+
+/// Command batching stats result.
+typedef struct result_command_batching_stats
+{
+  bool ok;
+  union
+  {
+    command_batching_stats value;
+    const char* error;
+  };
+} result_command_batching_stats;
 
 ///////////////////////////////////////////////////////////////////////////////
 /// * Command functions.
@@ -206,14 +343,18 @@ result_command_ptr command_new_render_line(point begin, point end);
  * @brief      Creates a new `RENDER_TEXT` command.
  *
  * @param[in]  text              text to render.
+ * @param[in]  font              font of text.
  * @param[in]  text_color        text color
  * @param[in]  text_coordinates  text top-left coordinates.
+ * @param[in]  dimensions        text dimensions, `0 x 0` if not known.
  *
  * @return     Command pointer result.
  */
 result_command_ptr command_new_render_text(const char* text,
+                                           font_handle font,
                                            const color text_color,
-                                           point text_coordinates);
+                                           point text_coordinates,
+                                           text_dimensions dimensions);
 
 /**
  * @brief      Creates a new `PUSH_CLIP_RECT` command.
@@ -251,6 +392,33 @@ result_command_ptr command_new_clear_window();
  */
 result_void command_free(command* cmd);
 
+/// Seed for `command_hash()`.
+#define COMMAND_HASH_SEED 14695981039346656037ull
+
+/**
+ * @brief      Hashes content of command, combining it with given hash.
+ *             Texts and rects of commands are hashed by their content.
+ *
+ * @param      cmd   the command to hash.
+ * @param[in]  hash  hash of previous commands, `COMMAND_HASH_SEED` for
+ *                   first command.
+ *
+ * @return     Hash.
+ */
+uint64 command_hash(const command* cmd, uint64 hash);
+
+/**
+ * @brief      Gives rect painted by a `RENDER_TEXT` (or) `RENDER_GLYPH_RUN`
+ *             command, from its coordinates and dimensions.
+ *
+ * @param      cmd     the command.
+ * @param[out] bounds  rect painted by text.
+ *
+ * @return     `false` if command doesn't render text, (or) dimensions of
+ *             its text are not known.
+ */
+bool command_text_rect(const command* cmd, rect* bounds);
+
 ///////////////////////////////////////////////////////////////////////////////
 /// * Command buffer functions.
 ///////////////////////////////////////////////////////////////////////////////
@@ -261,13 +429,15 @@ result_void command_free(command* cmd);
 result_command_buffer_ptr command_buffer_new();
 
 /// Gives length of command buffer.
-/// Returns `-1` if pointer to buffer is `NULL`.
-int16 command_buffer_length(const command_buffer* buffer);
+/// Returns `0` if pointer to buffer is `NULL`.
+uint32 command_buffer_length(const command_buffer* buffer);
 
-/// Adds the given command to the command buffer.
+/// Copies the given command into the command buffer.
+/// The caller still owns `cmd`, and is responsible for freeing it.
 ///
 /// Returns void result (`result_void`).
-result_void command_buffer_add_command(command_buffer* buffer, command* cmd);
+result_void command_buffer_add_command(command_buffer* buffer,
+                                       const command* cmd);
 
 /// Adds `RENDER_RECT` command to the command buffer.
 ///
@@ -298,20 +468,43 @@ result_void command_buffer_add_render_line_command(command_buffer* buffer,
                                                    point end);
 
 /// Adds `RENDER_TEXT` command to the command buffer.
+/// The text is copied into the command buffer's text arena, so the caller
+/// can free or modify its text right after this call.
 ///
 /// Returns void result (`result_void`).
 result_void command_buffer_add_render_text_command(command_buffer* buffer,
                                                    const char* text,
+                                                   font_handle font,
                                                    const color text_color,
-                                                   point text_coordinates);
+                                                   point text_coordinates,
+                                                   text_dimensions dimensions);
+
+/// Adds `RENDER_GLYPH_RUN` command to the command buffer.
+/// The glyphs are copied into the command buffer's arena, so the caller
+/// can free or modify them right after this call.
+///
+/// Returns void result (`result_void`).
+result_void
+command_buffer_add_render_glyph_run_command(command_buffer* buffer,
+                                            const positioned_glyph* glyphs,
+                                            uint16 glyphs_count,
+                                            font_handle font,
+                                            const color text_color,
+                                            point text_coordinates,
+                                            text_dimensions dimensions);
 
 /// Adds `PUSH_CLIP_RECT` command to the command buffer.
+/// The clip rect is intersected with clip rects pushed before it, and
+/// commands which paint nothing within it are not added to the command
+/// buffer, until it is popped.
 ///
 /// Returns void result (`result_void`).
 result_void command_buffer_add_push_clip_rect_command(command_buffer* buffer,
                                                       rect clip_rect);
 
-/// Adds `POP_CLIP_RECT` command to the command buffer.
+/// Adds `POP_CLIP_RECT` command to the command buffer, with the clip rect
+/// which is active again after popping. If nothing is left to pop, nothing
+/// is clipped after popping.
 ///
 /// Returns void result (`result_void`).
 result_void command_buffer_add_pop_clip_rect_command(command_buffer* buffer);
@@ -324,15 +517,62 @@ result_void command_buffer_add_set_cursor_command(command_buffer* buffer,
 
 result_void command_buffer_add_clear_window_command(command_buffer* buffer);
 
-/// Returns the next command in the command buffer.
-/// It's the backend's responsibility to free the command
-/// using `command_free()`.
+/// Gives number of segments holding commands of the command buffer.
+/// Commands are stored in fixed size segments, so large frames never
+/// reallocate (or) copy commands. Backends can process command buffer
+/// one segment at a time.
+/// Returns `0` if pointer to buffer is `NULL`.
+uint32 command_buffer_get_segments_count(const command_buffer* buffer);
+
+/// Gives a contiguous view over commands in segment at `index`, in the
+/// order they were added. Segments are in the order of their commands.
+/// Returns an empty span if pointer to buffer is `NULL`, (or) segment
+/// doesn't exist.
+command_span command_buffer_get_segment(const command_buffer* buffer,
+                                        uint32 index);
+
+/// Gives command at `index` in the command buffer.
+/// Returns `NULL` if pointer to buffer is `NULL`, (or) index is out of
+/// command buffer.
+const command* command_buffer_get_command(const command_buffer* buffer,
+                                          uint32 index);
+
+/// Drops render commands which are fully covered by later opaque
+/// (alpha 255) `RENDER_RECT` commands, as they would be painted over anyway.
+/// Area of an opaque rect is clipped by all clip rects active for it,
+/// before it is used for covering earlier commands.
+/// Order of remaining commands is preserved.
 ///
-/// Returns command pointer result (`result_command_ptr`).
-result_command_ptr command_buffer_get_next_command(command_buffer* buffer);
+/// Returns command culling stats result (`result_command_culling_stats`).
+result_command_culling_stats
+command_buffer_cull_occluded_commands(command_buffer* buffer);
+
+/// Batches commands of command buffer, to minimise state changes in backend:
+/// - `RENDER_RECT` commands of same color are merged into `RENDER_RECTS`
+///   commands (only if `merge_rects` is `true`). A rect is moved up to an
+///   earlier rect of same color, only if it doesn't overlap any command
+///   in between, so the rendered result doesn't change.
+///   Translucent rects are merged only if they don't overlap each other.
+/// - Cursor commands, except the last one, are dropped.
+/// - Empty clip scopes (push followed by pop) are dropped.
+///
+/// Returns command batching stats result (`result_command_batching_stats`).
+result_command_batching_stats
+command_buffer_batch_commands(command_buffer* buffer, bool merge_rects);
 
-/// Clears all commands in the command buffer.
-/// Not just the nodes in the command buffer, but also frees the commands.
+/// Removes commands from command buffer, starting at index `begin`.
+/// `removed` tells for each command from `begin` till the end of command
+/// buffer, if it should be removed. Order of remaining commands is preserved.
+///
+/// Returns void result (`result_void`).
+result_void command_buffer_remove_commands(command_buffer* buffer,
+                                           uint32 begin,
+                                           const bool* removed);
+
+/// Clears all commands in the command buffer, and releases all texts of
+/// the commands at once.
+/// The storage of the buffer is retained, so that next frame's commands
+/// doesn't need to allocate memory again.
 ///
 /// Returns void result (`result_void`).
 result_void command_buffer_clear_commands(command_buffer* buffer);
@@ -340,10 +580,4 @@ result_void command_buffer_clear_commands(command_buffer* buffer);
 /// Frees the command buffer.
 result_void command_buffer_free(command_buffer* buffer);
 
-result_command_buffer_const_iterator_ptr
-command_buffer_const_iterator_new(const command_buffer* buffer);
-
-result_void
-command_buffer_const_iterator_free(command_buffer_const_iterator* iterator);
-
 #endif
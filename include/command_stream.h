@@ -0,0 +1,110 @@
+#ifndef SMOLL_WIDGETS__COMMAND_STREAM_H
+#define SMOLL_WIDGETS__COMMAND_STREAM_H
+
+#include "command_buffer.h"
+#include "types.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Command Stream
+/// Binary recording of command buffers, frame by frame, for replaying them
+/// offline into any render backend.
+///
+/// Format (all integers are little-endian):
+/// - Header: magic `SMOLLREC` (8 bytes), version (u16), flags (u16).
+/// - Frame: tag `F` (u8), timestamp in nanoseconds since start of
+///   recording (u64), number of commands (u32), followed by commands.
+/// - Command: wire type (u8), followed by data of the command:
+///   - line: begin x, y, end x, y (i16 each).
+///   - text: color (4 x u8), font handle (u16, since version 2), x, y (i16
+///     each), w, h of text (u16 each, since version 4), text length (u16),
+///     text bytes without null-terminator.
+///   - rect, outlined rect, clip rect: x, y (i16 each), w, h (u16 each),
+///     color (4 x u8, not present for clip rect).
+///   - rounded rect: rect, border radius (u8), color.
+///   - rects: color, rects count (u16), rects.
+///   - glyph run (since version 3): color, font handle (u16), x, y (i16
+///     each), w, h of text (u16 each, since version 4), glyphs count (u16),
+///     glyphs: index (u32), x, y (f32 each).
+///     Glyph indices are those of the backend which shaped the text.
+///   - pop clip rect, cursor and clear commands have no data.
+/// Wire types are fixed by the format version, and don't depend on
+/// `command_type` values.
+///////////////////////////////////////////////////////////////////////////////
+
+/// Version of command stream format written by this library.
+/// Streams of older versions are read too.
+#define COMMAND_STREAM_VERSION 4
+
+/// Writes command buffers into a command stream file.
+typedef struct command_stream_writer command_stream_writer;
+
+/// Command stream writer pointer result.
+typedef struct result_command_stream_writer_ptr
+{
+  bool ok;
+  union
+  {
+    command_stream_writer* value;
+    const char* error;
+  };
+} result_command_stream_writer_ptr;
+
+/// Reads command buffers from a memory mapped command stream file.
+typedef struct command_stream_reader command_stream_reader;
+
+/// Command stream reader pointer result.
+typedef struct result_command_stream_reader_ptr
+{
+  bool ok;
+  union
+  {
+    command_stream_reader* value;
+    const char* error;
+  };
+} result_command_stream_reader_ptr;
+
+/// Creates (or) truncates the file at `path`, and writes header of
+/// command stream into it.
+///
+/// Returns command stream writer pointer result
+/// (`result_command_stream_writer_ptr`).
+result_command_stream_writer_ptr command_stream_writer_open(const char* path);
+
+/// Writes all commands of command buffer as a frame.
+/// Timestamp of frame is the time elapsed since the writer was opened.
+///
+/// Returns void result (`result_void`).
+result_void command_stream_writer_write_frame(command_stream_writer* writer,
+                                              const command_buffer* buffer);
+
+/// Flushes and closes the file, frees the writer.
+///
+/// Returns void result (`result_void`).
+result_void command_stream_writer_close(command_stream_writer* writer);
+
+/// Memory maps the command stream file at `path`, and validates its header.
+///
+/// Returns command stream reader pointer result
+/// (`result_command_stream_reader_ptr`).
+result_command_stream_reader_ptr command_stream_reader_open(const char* path);
+
+/// Reads next frame into command buffer. Command buffer is cleared before
+/// reading the frame.
+/// `timestamp_ns` is optional, receives timestamp of frame.
+///
+/// Returns bool result (`result_bool`), `false` if there are no more frames.
+result_bool command_stream_reader_read_frame(command_stream_reader* reader,
+                                             command_buffer* buffer,
+                                             uint64* timestamp_ns);
+
+/// Moves reader back to the first frame.
+///
+/// Returns void result (`result_void`).
+result_void command_stream_reader_rewind(command_stream_reader* reader);
+
+/// Unmaps the file, frees the reader.
+///
+/// Returns void result (`result_void`).
+result_void command_stream_reader_close(command_stream_reader* reader);
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef SMOLL_WIDGETS__DAMAGE_REGION_H
+#define SMOLL_WIDGETS__DAMAGE_REGION_H
+
+#include "command_buffer.h"
+#include "types.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Damage Region
+/// Accumulates areas of viewport painted by commands, so backends can upload
+/// only the changed pixels to the screen.
+/// Damaged rects are clamped to clip rects & viewport, and merged with each
+/// other. Region holds at most `DAMAGE_REGION_RECTS_MAX` rects, past that it
+/// collapses into one bounding rect.
+///////////////////////////////////////////////////////////////////////////////
+
+/// Maximum number of rects held by damage region, before it collapses into
+/// one bounding rect.
+#define DAMAGE_REGION_RECTS_MAX 16
+
+typedef struct damage_region damage_region;
+
+/// Damage region pointer result.
+typedef struct result_damage_region_ptr
+{
+  bool ok;
+  union
+  {
+    damage_region* value;
+    const char* error;
+  };
+} result_damage_region_ptr;
+
+/// Contiguous view over the rects of damage region.
+/// The view is valid until the damage region is modified.
+typedef struct damage_span
+{
+  /// Pointer to first rect.
+  const rect* rects;
+
+  /// Number of rects in the span, 0 if nothing is damaged.
+  uint16 length;
+} damage_span;
+
+/**
+ * @brief      Creates a new empty damage region, with empty viewport.
+ *
+ * @return     Damage region pointer result.
+ */
+result_damage_region_ptr damage_region_new();
+
+/**
+ * @brief      Frees damage region.
+ *
+ * @param      region  the damage region to free.
+ *
+ * @return     Void result.
+ */
+result_void damage_region_free(damage_region* region);
+
+/**
+ * @brief      Empties damage region, and sets the viewport to which damaged
+ *             rects are clamped.
+ *
+ * @param      region           the damage region.
+ * @param[in]  viewport_width   the viewport width.
+ * @param[in]  viewport_height  the viewport height.
+ *
+ * @return     Void result.
+ */
+result_void damage_region_reset(damage_region* region,
+                                uint16 viewport_width,
+                                uint16 viewport_height);
+
+/**
+ * @brief      Adds a damaged rect, clamped to viewport, into damage region.
+ *
+ * @param      region        the damage region.
+ * @param[in]  damaged_rect  the damaged rect.
+ *
+ * @return     Void result.
+ */
+result_void damage_region_add_rect(damage_region* region, rect damaged_rect);
+
+/**
+ * @brief      Adds areas painted by commands of command buffer into damage
+ *             region. Painted areas are clamped to clip rects carried by
+ *             clip commands. Area of text commands isn't known, it is
+ *             assumed to span from text coordinates to the end of clip rect.
+ *
+ * @param      region      the damage region.
+ * @param[in]  cmd_buffer  the command buffer.
+ *
+ * @return     Void result.
+ */
+result_void damage_region_add_command_buffer(damage_region* region,
+                                             const command_buffer* cmd_buffer);
+
+/**
+ * @brief      Gives damaged rects. Rects don't overlap each other unless
+ *             merging them would damage a lot more area.
+ *
+ * @param[in]  region  the damage region.
+ *
+ * @return     Damage span, empty if region is `NULL`.
+ */
+damage_span damage_region_get_rects(const damage_region* region);
+
+#endif
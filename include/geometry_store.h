@@ -0,0 +1,141 @@
+#ifndef SMOLL_WIDGETS__GEOMETRY_STORE_H
+#define SMOLL_WIDGETS__GEOMETRY_STORE_H
+
+#include "types.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Geometry Store
+/// Geometry & flex-box parameters of widgets are stored in packed arrays,
+/// indexed by ids of widgets, so layouting and hit-testing loop over arrays
+/// instead of visiting every widget scattered over the heap.
+/// Widgets of a context live in the store of context, ids stay the same
+/// while widget stays in it. A widget without context lives in the store of
+/// its tree, created along with the widget, and moves into the store of
+/// context once it gains a context.
+/// Store is freed once its owner and all of its widgets have left it.
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct base_widget base_widget;
+
+/// Geometry store, arrays are indexed by ids of widgets.
+/// Ids are given out & arrays grow only on UI thread, while no widget of
+/// store is being laid out.
+typedef struct geometry_store
+{
+  /// x-coordinates of widgets, relative to their parent's origin.
+  int32* x;
+
+  /// y-coordinates of widgets, relative to their parent's origin.
+  int32* y;
+
+  /// Widths of widgets.
+  uint32* w;
+
+  /// Heights of widgets.
+  uint32* h;
+
+  /// Visibility of widgets.
+  bool* visible;
+
+  /// Flex-grow of widgets.
+  uint8* flex_grow;
+
+  /// Flex-shrink of widgets.
+  uint8* flex_shrink;
+
+  /// Cross-axis sizing of widgets, values of `flex_cross_axis_sizing`.
+  uint8* cross_axis_sizing;
+
+  /// Widgets stored under ids, `NULL` for free ids.
+  base_widget** widgets;
+
+  /// Ids of widgets which left store, given out again before new ids.
+  uint32* free_ids;
+  uint32 free_ids_count;
+
+  /// Number of ids given out, including free ids.
+  uint32 count;
+
+  /// Number of ids arrays have room for.
+  uint32 capacity;
+
+  /// Number of widgets in store, plus one for its owner.
+  uint32 references;
+} geometry_store;
+
+/// Geometry store pointer result.
+typedef struct result_geometry_store_ptr
+{
+  bool ok;
+  union
+  {
+    geometry_store* value;
+    const char* error;
+  };
+} result_geometry_store_ptr;
+
+/**
+ * @brief      Creates a new empty geometry store, referenced by its owner.
+ *
+ * @param[in]  capacity  the number of widgets to make room for.
+ *
+ * @return     Geometry store pointer result.
+ */
+result_geometry_store_ptr geometry_store_new(uint32 capacity);
+
+/**
+ * @brief      Drops reference of owner to geometry store, freeing it if no
+ *             widget lives in it.
+ *
+ * @param      store  the geometry store.
+ */
+void geometry_store_free(geometry_store* store);
+
+/**
+ * @brief      Makes room for more widgets, so giving out that many ids
+ *             doesn't fail.
+ *
+ * @param      store  the geometry store.
+ * @param[in]  count  the number of widgets to make room for.
+ *
+ * @return     Void result.
+ */
+result_void geometry_store_reserve(geometry_store* store, uint32 count);
+
+/**
+ * @brief      Gives out an id for widget, with default geometry: visible,
+ *             zero sized at origin, neither growing nor shrinking, and
+ *             fitting its content on cross-axis.
+ *
+ * @param      store   the geometry store.
+ * @param      widget  the widget to store.
+ *
+ * @return     Id of widget result.
+ */
+result_uint32 geometry_store_acquire(geometry_store* store,
+                                     base_widget* widget);
+
+/**
+ * @brief      Takes back id of widget leaving store, freeing store if it
+ *             was the last reference to it.
+ *
+ * @param      store  the geometry store.
+ * @param[in]  id     the id of widget.
+ */
+void geometry_store_release(geometry_store* store, uint32 id);
+
+/**
+ * @brief      Copies geometry stored under an id into another id, of the
+ *             same (or) another store.
+ *
+ * @param      to       the store to copy into.
+ * @param[in]  to_id    the id to copy into.
+ * @param[in]  from     the store to copy from.
+ * @param[in]  from_id  the id to copy from.
+ */
+void geometry_store_copy(geometry_store* to,
+                         uint32 to_id,
+                         const geometry_store* from,
+                         uint32 from_id);
+
+#endif
@@ -33,16 +33,29 @@ result_smoll_context_ptr smoll_context_create(uint16 viewport_width,
 /// @return Void result.
 result_void smoll_context_destroy(smoll_context* context);
 
-/// @brief Sets default (or) fallback font for smoll context.
-///        Make sure the backend is attached to smoll context before calling
-///        this function.
+/// @brief Sets default (or) fallback font for smoll context, the font of
+///        `DEFAULT_FONT_HANDLE`. Fonts are loaded into backend when it is
+///        registered, (or) right away if it is already registered.
+///        Clears text cache, if default font is replaced.
 /// @param context pointer to smoll context.
 /// @param font name of font.
+/// @param font_size size of font.
 /// @return Void result.
 result_void smoll_context_set_default_font(smoll_context* context,
                                            const char* font,
                                            uint8 font_size);
 
+/// @brief Registers another font with smoll context, e.g. for headings (or)
+///        monospace texts. Font is loaded into backend once, and texts refer
+///        to it by the returned handle.
+/// @param context pointer to smoll context.
+/// @param font name of font.
+/// @param font_size size of font.
+/// @return Font handle result.
+result_font_handle smoll_context_register_font(smoll_context* context,
+                                               const char* font,
+                                               uint8 font_size);
+
 /// @brief Sets root widget for smoll context.
 ///        Root widget must be set first. Assigning of widgets follows a order,
 ///        it starts from top of UI tree, assign root widget to context, then
@@ -113,4 +126,150 @@ result_void smoll_context_render(smoll_context* context);
 result_void
 smoll_context_render_send_cmd_buffer_to_backend(smoll_context* context);
 
+/// @brief Enables (or) disables occlusion culling pass.
+///        When enabled, commands fully covered by later opaque rects are
+///        dropped from command buffer before it is rendered (or) submitted.
+///        Disabled by default.
+/// @param context pointer to smoll context.
+/// @param enabled whether to cull occluded commands.
+/// @return Void result.
+result_void smoll_context_set_occlusion_culling(smoll_context* context,
+                                               bool enabled);
+
+/// @brief Gives stats of the last occlusion culling pass.
+/// @param context pointer to smoll context.
+/// @return Command culling stats result.
+result_command_culling_stats
+smoll_context_get_culling_stats(const smoll_context* context);
+
+/// @brief Enables (or) disables command batching pass.
+///        When enabled, same colored rects are merged into `RENDER_RECTS`
+///        commands (if backend supports batched rects), and redundant
+///        cursor and clip commands are dropped, before command buffer is
+///        rendered (or) submitted. Runs after occlusion culling pass.
+///        Disabled by default.
+/// @param context pointer to smoll context.
+/// @param enabled whether to batch commands.
+/// @return Void result.
+result_void smoll_context_set_command_batching(smoll_context* context,
+                                              bool enabled);
+
+/// @brief Gives stats of the last command batching pass.
+/// @param context pointer to smoll context.
+/// @return Command batching stats result.
+result_command_batching_stats
+smoll_context_get_batching_stats(const smoll_context* context);
+
+/// @brief Enables (or) disables retained rendering.
+///        When enabled, each widget retains a display list (hash of its own
+///        commands & its geometry), and commands of widgets which would
+///        repaint what is already on screen are dropped after rendering.
+///        Backend must keep contents of window between frames.
+///        Disabled by default.
+/// @param context pointer to smoll context.
+/// @param enabled whether to retain display lists of widgets.
+/// @return Void result.
+result_void smoll_context_set_retained_rendering(smoll_context* context,
+                                                 bool enabled);
+
+/// @brief Gives stats of retained rendering, for the last prepared frame.
+/// @param context pointer to smoll context.
+/// @return Display list stats result.
+result_display_list_stats
+smoll_context_get_display_list_stats(const smoll_context* context);
+
+/// @brief Enables (or) disables parallel layout.
+///        When enabled, context owns a thread pool, and sibling subtrees
+///        large enough to be worth it are re-layouted on it in parallel.
+///        Measuring sizes of widgets still happens on the calling thread.
+///        Disabled by default.
+/// @param context pointer to smoll context.
+/// @param threads_count number of worker threads, `0` disables parallel
+///        layout.
+/// @return Void result.
+result_void smoll_context_set_parallel_layout(smoll_context* context,
+                                              uint16 threads_count);
+
+/// @brief Enables (or) disables deferred updates.
+///        When enabled, changing widgets (e.g. setting text of labels) only
+///        queues them, and `smoll_context_update()` lays out & renders all
+///        of them at once, laying out a subtree shared by many of them only
+///        once. Layout of widgets is stale until then, e.g. for hit-testing.
+///        Pending updates are run when disabling.
+///        Disabled by default.
+/// @param context pointer to smoll context.
+/// @param enabled whether to defer updates of changed widgets.
+/// @return Void result.
+result_void smoll_context_set_deferred_updates(smoll_context* context,
+                                               bool enabled);
+
+/// @brief Lays out & renders widgets changed since last update, if updates
+///        are deferred. Called by `smoll_context_render()`,
+///        `smoll_context_render_send_cmd_buffer_to_backend()` &
+///        `smoll_context_submit_frame()`, so it is needed only for building
+///        a frame's commands without rendering (or) submitting them.
+/// @param context pointer to smoll context.
+/// @return Void result.
+result_void smoll_context_update(smoll_context* context);
+
+/// @brief Gives counters of text cache, which holds dimensions of texts
+///        measured by backend. Cache is cleared when a font is replaced.
+/// @param context pointer to smoll context.
+/// @return Text cache stats result.
+result_text_cache_stats
+smoll_context_get_text_cache_stats(const smoll_context* context);
+
+/// @brief Starts recording frames into a command stream file, which can be
+///        replayed later using `smoll-replay`.
+///        Frames are recorded before occlusion culling & batching passes.
+/// @param context pointer to smoll context.
+/// @param path path of file to record into, truncated if it exists.
+/// @return Void result.
+result_void smoll_context_start_recording(smoll_context* context,
+                                          const char* path);
+
+/// @brief Stops recording frames, and closes the command stream file.
+/// @param context pointer to smoll context.
+/// @return Void result.
+result_void smoll_context_stop_recording(smoll_context* context);
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Frame Handoff
+/// Smoll context owns two command buffers. Widgets build the next frame in
+/// one of them, while the other one can be rendered by the backend on
+/// a render thread. The UI thread submits frames, the render thread acquires
+/// and releases them. Only one UI thread and one render thread are supported.
+///////////////////////////////////////////////////////////////////////////////
+
+/// @brief Submits commands generated so far as a frame for rendering,
+///        and swaps in the other command buffer for building next frame.
+///        Call this from UI thread.
+///        If previously submitted frame is still not released by the render
+///        thread, nothing is swapped and commands keep accumulating for the
+///        next submit, as commands are incremental updates.
+/// @param context pointer to smoll context.
+/// @return Bool result, `true` if a frame was submitted.
+result_bool smoll_context_submit_frame(smoll_context* context);
+
+/// @brief Acquires the submitted frame for rendering.
+///        Call this from render thread, and release the frame using
+///        `smoll_context_release_frame()` after rendering it.
+/// @param context pointer to smoll context.
+/// @return Const command buffer pointer result, value is `NULL` if no frame
+///         is submitted.
+result_const_command_buffer_ptr
+smoll_context_acquire_frame(smoll_context* context);
+
+/// @brief Releases the acquired frame, after rendering it.
+///        Call this from render thread. Command buffer of the frame must not
+///        be accessed after releasing it.
+/// @param context pointer to smoll context.
+/// @return Void result.
+result_void smoll_context_release_frame(smoll_context* context);
+
+/// @brief Tells if a submitted frame is not yet released by render thread.
+/// @param context pointer to smoll context.
+/// @return Bool result.
+result_bool smoll_context_is_frame_in_flight(smoll_context* context);
+
 #endif
\ No newline at end of file
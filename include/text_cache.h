@@ -0,0 +1,140 @@
+#ifndef SMOLL_WIDGETS__TEXT_CACHE_H
+#define SMOLL_WIDGETS__TEXT_CACHE_H
+
+#include "backend.h"
+#include "types.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Text Cache
+/// Caches dimensions of measured texts, keyed by text and font, so the same
+/// text is measured by backend only once.
+/// Cache holds at most `TEXT_CACHE_ENTRIES_MAX` texts. Entries are grouped
+/// into sets of `TEXT_CACHE_SET_SIZE` by hash of their key, and a text
+/// replaces the least recently used text of its set once the set is full.
+///////////////////////////////////////////////////////////////////////////////
+
+/// Maximum number of texts held by text cache.
+#define TEXT_CACHE_ENTRIES_MAX 4096
+
+/// Number of entries a key can be placed in.
+#define TEXT_CACHE_SET_SIZE 4
+
+typedef struct text_cache text_cache;
+
+/// Text cache pointer result.
+typedef struct result_text_cache_ptr
+{
+  bool ok;
+  union
+  {
+    text_cache* value;
+    const char* error;
+  };
+} result_text_cache_ptr;
+
+/// Counters of text cache lookups, since cache was created.
+typedef struct text_cache_stats
+{
+  /// Number of lookups which found the text.
+  uint64 hits;
+
+  /// Number of lookups which didn't find the text.
+  uint64 misses;
+
+  /// Number of texts replaced by other texts.
+  uint64 evictions;
+
+  /// Number of texts held by cache.
+  uint32 entries;
+} text_cache_stats;
+
+/// Text cache stats result.
+typedef struct result_text_cache_stats
+{
+  bool ok;
+  union
+  {
+    text_cache_stats value;
+    const char* error;
+  };
+} result_text_cache_stats;
+
+/**
+ * @brief      Creates a new empty text cache.
+ *
+ * @return     Text cache pointer result.
+ */
+result_text_cache_ptr text_cache_new();
+
+/**
+ * @brief      Frees text cache, along with its texts.
+ *
+ * @param      cache  the text cache to free.
+ *
+ * @return     Void result.
+ */
+result_void text_cache_free(text_cache* cache);
+
+/**
+ * @brief      Looks up dimensions of text, measured with font.
+ *
+ * @param      cache       the text cache.
+ * @param[in]  text        the text.
+ * @param[in]  font        the font.
+ * @param      dimensions  the dimensions of text, set only if found.
+ *
+ * @return     `true` if text is found, else `false`.
+ */
+bool text_cache_lookup(text_cache* cache,
+                       const char* text,
+                       font_handle font,
+                       text_dimensions* dimensions);
+
+/**
+ * @brief      Tells if dimensions of text, measured with font, are cached.
+ *             Unlike lookup, doesn't count as a hit (or) miss.
+ *
+ * @param[in]  cache  the text cache.
+ * @param[in]  text   the text.
+ * @param[in]  font   the font.
+ *
+ * @return     `true` if text is found, else `false`.
+ */
+bool text_cache_contains(const text_cache* cache,
+                         const char* text,
+                         font_handle font);
+
+/**
+ * @brief      Inserts dimensions of text, measured with font, replacing
+ *             least recently used text of its set if set is full.
+ *
+ * @param      cache       the text cache.
+ * @param[in]  text        the text, copied into cache.
+ * @param[in]  font        the font.
+ * @param[in]  dimensions  the dimensions of text.
+ *
+ * @return     Void result, on error text is not cached.
+ */
+result_void text_cache_insert(text_cache* cache,
+                              const char* text,
+                              font_handle font,
+                              text_dimensions dimensions);
+
+/**
+ * @brief      Removes all texts from text cache, e.g. when fonts change.
+ *             Counters are kept.
+ *
+ * @param      cache  the text cache.
+ */
+void text_cache_clear(text_cache* cache);
+
+/**
+ * @brief      Gives counters of text cache.
+ *
+ * @param[in]  cache  the text cache.
+ *
+ * @return     Text cache stats.
+ */
+text_cache_stats text_cache_get_stats(const text_cache* cache);
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef SMOLL_WIDGETS__THREAD_POOL_H
+#define SMOLL_WIDGETS__THREAD_POOL_H
+
+#include "types.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Thread Pool
+/// Runs submitted tasks on worker threads. Tasks are grouped, a thread
+/// waiting for a group runs pending tasks itself instead of blocking, so
+/// tasks can submit and wait for nested tasks without starving the pool.
+/// All threads share one queue guarded by a mutex, taking the most recently
+/// submitted task first. This is not a work-stealing pool with per-thread
+/// deques, layout submits few and coarse tasks (subtrees of siblings), so
+/// contention on the queue is low.
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct thread_pool thread_pool;
+
+/// Thread pool pointer result.
+typedef struct result_thread_pool_ptr
+{
+  bool ok;
+  union
+  {
+    thread_pool* value;
+    const char* error;
+  };
+} result_thread_pool_ptr;
+
+/// Group of tasks, which can be waited for together.
+/// Should be zero initialized before submitting tasks into it.
+typedef struct thread_pool_group
+{
+  /// Number of submitted tasks of group, which haven't finished yet.
+  uint32 pending;
+} thread_pool_group;
+
+/**
+ * @brief      Creates a new thread pool, and starts its worker threads.
+ *
+ * @param[in]  threads_count  the number of worker threads, at least 1.
+ *
+ * @return     Thread pool pointer result.
+ */
+result_thread_pool_ptr thread_pool_new(uint16 threads_count);
+
+/**
+ * @brief      Stops worker threads, after they finish pending tasks, and
+ *             frees thread pool.
+ *
+ * @param      pool  the thread pool to free.
+ *
+ * @return     Void result.
+ */
+result_void thread_pool_free(thread_pool* pool);
+
+/**
+ * @brief      Gives number of worker threads of thread pool.
+ *
+ * @param[in]  pool  the thread pool.
+ *
+ * @return     Number of worker threads, 0 if pool is `NULL`.
+ */
+uint16 thread_pool_get_threads_count(const thread_pool* pool);
+
+/**
+ * @brief      Submits a task into group, to be run by a worker thread (or) by
+ *             a thread waiting for the group.
+ *
+ * @param      pool   the thread pool.
+ * @param      group  the group of task.
+ * @param[in]  run    the function to run.
+ * @param      data   the data passed to function.
+ *
+ * @return     Void result, on error task is not submitted.
+ */
+result_void thread_pool_submit(thread_pool* pool,
+                               thread_pool_group* group,
+                               void (*run)(void* data),
+                               void* data);
+
+/**
+ * @brief      Waits until all tasks of group have finished, running pending
+ *             tasks of the pool meanwhile.
+ *
+ * @param      pool   the thread pool.
+ * @param      group  the group to wait for.
+ *
+ * @return     Void result.
+ */
+result_void thread_pool_wait(thread_pool* pool, thread_pool_group* group);
+
+#endif
@@ -114,6 +114,52 @@ typedef struct rect
   uint16 h;
 } rect;
 
+/**
+ * Virtual point struct, contains 32-bit coordinates of point with origin at
+ * top-left. Used for positions within contents, which can be far larger than
+ * the viewport, e.g. rows of a long list.
+ */
+typedef struct virtual_point
+{
+  /**
+   * X-coordinate of point.
+   */
+  int32 x;
+
+  /**
+   * Y-coordinate of point.
+   */
+  int32 y;
+} virtual_point;
+
+/**
+ * Virtual rect struct, contains 32-bit coordinates and size of rectangle with
+ * origin at top-left. Narrowed to `rect` only after clipping, when sent to
+ * render backends.
+ */
+typedef struct virtual_rect
+{
+  /**
+   * X-coordinate of top-left corner of rectangle.
+   */
+  int32 x;
+
+  /**
+   * Y-coordinate of top-left corner of rectangle.
+   */
+  int32 y;
+
+  /**
+   * Width of rectangle.
+   */
+  uint32 w;
+
+  /**
+   * Height of rectangle.
+   */
+  uint32 h;
+} virtual_rect;
+
 /**
  * Color with RGBA components, each component ranges from [0, 255].
  */
@@ -86,6 +86,17 @@ result_const_char_ptr button_get_text(const button* btn);
 /// @return Void result.
 result_void button_set_text(button* btn, const char* text);
 
+/// @brief Gets font of button text.
+/// @param btn constant pointer to button.
+/// @return Font handle result.
+result_font_handle button_get_font(const button* btn);
+
+/// @brief Sets font of button text, registered with context.
+/// @param btn pointer to button.
+/// @param font handle of font.
+/// @return Void result.
+result_void button_set_font(button* btn, font_handle font);
+
 /// @brief Sets callback for mouse down event.
 ///        Setting button colors to click colors are automatically handled.
 ///        Use this function to do some external calculations.
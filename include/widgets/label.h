@@ -32,6 +32,10 @@ result_const_char_ptr label_get_text(const label* l);
 
 result_bool label_set_text(label* l, const char* text);
 
+result_font_handle label_get_font(const label* l);
+
+result_bool label_set_font(label* l, font_handle font);
+
 result_color label_get_color(const label* l);
 
 result_bool label_set_color(label* l, const color* c);
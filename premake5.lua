@@ -96,3 +96,26 @@ workspace("smoll-widgets")
         "bin/Release" -- smoll-widgets built library path
       })
     filter({})
+
+  -- Command stream replay tool
+  project("smoll-replay")
+    kind("ConsoleApp")
+    language("C")
+    includedirs({
+      "include",
+    })
+    files({
+      "tools/smoll_replay/*.c",
+    })
+    links({
+      "smoll-widgets"
+    })
+    filter("configurations:Debug")
+      libdirs({
+        "bin/Debug" -- smoll-widgets built library path
+      })
+    filter("configurations:Release")
+      libdirs({
+        "bin/Release" -- smoll-widgets built library path
+      })
+    filter({})
@@ -2,8 +2,68 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "../include/macros.h"
 
+/// @brief Minimum number of widgets in a subtree, for it to be laid out on
+///        thread pool of context.
+#define PARALLEL_LAYOUT_MIN_DESCENDANTS 1024
+
+/// @brief Number of frames a traversal stack is first allocated for.
+#define TRAVERSAL_STACK_INITIAL_CAPACITY 64
+
+/// @brief Gives the widget following `widget` in pre-order walk of subtree
+///        of `root`, skipping descendants of `widget` if `skip_children`.
+///        Walks through parent links, so needs no stack.
+/// @return Next widget, `NULL` once subtree of root is walked.
+static base_widget* next_in_subtree(const base_widget* root,
+                                    base_widget* widget,
+                                    bool skip_children)
+{
+  if(!skip_children && widget->children_head)
+  {
+    return widget->children_head->child;
+  }
+
+  while(widget != root)
+  {
+    if(widget->child_node->next)
+    {
+      return widget->child_node->next->child;
+    }
+    widget = widget->parent;
+  }
+
+  return NULL;
+}
+
+/// @brief Pushes frame visiting widget, from its first child, onto stack.
+static result_void traversal_stack_push(traversal_stack* stack,
+                                        base_widget* widget)
+{
+  if(stack->count == stack->capacity)
+  {
+    uint32 capacity = stack->capacity ? stack->capacity * 2
+                                      : TRAVERSAL_STACK_INITIAL_CAPACITY;
+    traversal_frame* frames = (traversal_frame*)realloc(
+      stack->frames, capacity * sizeof(traversal_frame));
+    if(!frames)
+    {
+      return error(result_void,
+                   "Unable to allocate memory for traversal stack!");
+    }
+    stack->frames = frames;
+    stack->capacity = capacity;
+  }
+
+  stack->frames[stack->count++] =
+    (traversal_frame){.widget = widget,
+                      .node = widget->children_head,
+                      .parallel_children = NULL};
+
+  return ok_void();
+}
+
 result_base_widget_child_node_ptr base_widget_child_node_new(base_widget* child)
 {
   if(!child)
@@ -21,6 +81,7 @@ result_base_widget_child_node_ptr base_widget_child_node_new(base_widget* child)
   }
 
   node->child = child;
+  node->prev = NULL;
   node->next = NULL;
 
   return ok(result_base_widget_child_node_ptr, node);
@@ -47,10 +108,23 @@ result_base_widget_ptr base_widget_new(widget_type type)
                  "Unable to allocate memory for base_widget!");
   }
 
-  widget->x = 0;
-  widget->y = 0;
-  widget->w = 0;
-  widget->h = 0;
+  // widget starts a tree of its own, whose store is referenced only by
+  // widgets living in it
+  result_geometry_store_ptr _ = geometry_store_new(1);
+  if(!_.ok)
+  {
+    free(widget);
+    return error(result_base_widget_ptr, _.error);
+  }
+  result_uint32 __ = geometry_store_acquire(_.value, widget);
+  geometry_store_free(_.value);
+  if(!__.ok)
+  {
+    free(widget);
+    return error(result_base_widget_ptr, __.error);
+  }
+  widget->geometry = _.value;
+  widget->geometry_id = __.value;
 
   widget->type = type;
   if(type == FLEX_CONTAINER)
@@ -60,32 +134,29 @@ result_base_widget_ptr base_widget_new(widget_type type)
                             .direction = FLEX_DIRECTION_ROW,
                             .justify_content = JUSTIFY_CONTENT_START,
                             .align_items = ALIGN_ITEMS_START,
-                            .flex_grow = 0,
-                            .flex_shrink = 0,
-                            .gap = 0,
-                            .cross_axis_sizing = CROSS_AXIS_SIZING_FIT_CONTENT};
-  }
-  else
-  {
-    widget->flexbox_data.item =
-      (flex_item_data){.flex_grow = 0,
-                       .flex_shrink = 0,
-                       .cross_axis_sizing = CROSS_AXIS_SIZING_FIT_CONTENT};
+                            .gap = 0};
   }
 
   widget->need_resizing = true;
 
-  widget->visible = true;
+  // children of a new widget have never been laid out
+  widget->layout.layout_dirty = true;
 
   widget->derived = NULL;
   widget->parent = NULL;
   widget->children_head = NULL;
+  widget->children_tail = NULL;
+  widget->children_count = 0;
+  widget->descendants_count = 0;
+  widget->descendants_count_valid = true;
+  widget->child_node = NULL;
 
   widget->context = NULL;
 
   widget->pre_internal_relayout_hook = NULL;
   widget->internal_get_background_callback = NULL;
   widget->internal_fit_layout_callback = NULL;
+  widget->internal_get_text_callback = NULL;
   widget->internal_render_callback = NULL;
 
   widget->internal_derived_free_callback = NULL;
@@ -99,55 +170,355 @@ result_base_widget_ptr base_widget_new(widget_type type)
   return ok(result_base_widget_ptr, widget);
 }
 
-result_void base_widget_add_child(base_widget* base, base_widget* child)
+/// @brief Invalidates absolute positions of all widgets of context, as a
+///        position of widget (or) of one of its ancestors has changed.
+static void invalidate_absolute_positions(base_widget* widget)
 {
-  if(!base)
+  // re-layout on layout pool invalidates positions when it finishes, not
+  // letting its worker threads write to context
+  if(widget->context && !widget->context->parallel_relayout)
   {
-    return error(result_void,
-                 "Cannot attach child to NULL pointed parent widget!");
+    widget->context->position_generation++;
   }
+}
 
-  if(base->type == FLEX_ITEM)
+/// @brief Sets context of widget and its descendants, which may have been
+///        created before their ancestor was added to a context.
+static void set_subtree_context(base_widget* widget, internal_context* context)
+{
+  base_widget* descendant = widget;
+  while(descendant)
   {
-    return error(result_void,
-                 "Cannot attach child to widget of type FLEX_ITEM!");
+    if(descendant->pending_updates && descendant->context)
+    {
+      // updates are queued in the context widget is leaving
+      internal_context_dequeue_update(descendant->context, descendant);
+    }
+    descendant->context = context;
+    descendant = next_in_subtree(widget, descendant, false);
   }
+}
 
-  if(!child)
+/// @brief Moves geometry of widget and its descendants into store, under
+///        new ids. Store they leave is freed once no widget lives in it.
+///        On error, nothing is moved.
+static result_void move_subtree_geometry(base_widget* widget,
+                                         geometry_store* store)
+{
+  if(widget->geometry == store)
   {
-    return error(result_void,
-                 "Cannot attach NULL pointed child to parent widget!");
+    return ok_void();
   }
 
-  child->context = base->context;
+  uint32 count = 0;
+  base_widget* descendant = widget;
+  while(descendant)
+  {
+    count++;
+    descendant = next_in_subtree(widget, descendant, false);
+  }
 
-  if(!base->children_head)
+  result_void _ = geometry_store_reserve(store, count);
+  if(!_.ok)
+  {
+    return _;
+  }
+
+  descendant = widget;
+  while(descendant)
+  {
+    // store has room for the whole subtree
+    uint32 id = geometry_store_acquire(store, descendant).value;
+    geometry_store_copy(
+      store, id, descendant->geometry, descendant->geometry_id);
+    geometry_store_release(descendant->geometry, descendant->geometry_id);
+    descendant->geometry = store;
+    descendant->geometry_id = id;
+
+    // ids of children have changed
+    descendant->children_index_valid = false;
+
+    descendant = next_in_subtree(widget, descendant, false);
+  }
+
+  return ok_void();
+}
+
+result_void common_internal_set_context(base_widget* widget,
+                                        internal_context* context)
+{
+  if(context)
   {
-    result_base_widget_child_node_ptr _ = base_widget_child_node_new(child);
+    result_void _ = move_subtree_geometry(widget, context->geometry);
     if(!_.ok)
     {
-      return error(result_void, _.error);
+      return _;
     }
+  }
 
-    child->parent = base;
-    base->children_head = _.value;
+  if(widget->context != context)
+  {
+    set_subtree_context(widget, context);
+  }
 
-    return ok_void();
+  return ok_void();
+}
+
+/// @brief Marks descendants count of widget and its ancestors stale, to be
+///        computed again by `update_descendants_count()`.
+static void invalidate_descendants_count(base_widget* widget)
+{
+  // ancestors of a stale ancestor are already stale, as counts are
+  // computed from bottom to top
+  while(widget && widget->descendants_count_valid)
+  {
+    widget->descendants_count_valid = false;
+    widget = widget->parent;
+  }
+}
+
+/// @brief Links child node into children list of widget, after the given
+///        node (or) at the head of list if `after` is `NULL`. Subtree of
+///        child moves into geometry store of widget.
+///        Index of children is to be patched by caller.
+/// @return Void result, on error node is not linked.
+static result_void link_child_node(base_widget* base,
+                                   base_widget_child_node* node,
+                                   base_widget_child_node* after)
+{
+  result_void _ = move_subtree_geometry(node->child, base->geometry);
+  if(!_.ok)
+  {
+    return _;
+  }
+
+  node->prev = after;
+  node->next = after ? after->next : base->children_head;
+
+  if(node->next)
+  {
+    node->next->prev = node;
+  }
+  else
+  {
+    base->children_tail = node;
+  }
+
+  if(after)
+  {
+    after->next = node;
+  }
+  else
+  {
+    base->children_head = node;
+  }
+
+  base->children_count++;
+
+  invalidate_descendants_count(base);
+
+  node->child->parent = base;
+  if(node->child->context != base->context)
+  {
+    set_subtree_context(node->child, base->context);
+  }
+  node->child->child_node = node;
+
+  common_internal_mark_layout_dirty(base);
+  invalidate_absolute_positions(base);
+
+  return ok_void();
+}
+
+/// @brief Unlinks child node from children list of widget, node is not freed.
+///        Index of children is to be patched by caller.
+static void unlink_child_node(base_widget* base, base_widget_child_node* node)
+{
+  if(node->prev)
+  {
+    node->prev->next = node->next;
+  }
+  else
+  {
+    base->children_head = node->next;
+  }
+
+  if(node->next)
+  {
+    node->next->prev = node->prev;
+  }
+  else
+  {
+    base->children_tail = node->prev;
+  }
+
+  base->children_count--;
+
+  invalidate_descendants_count(base);
+
+  node->child->parent = NULL;
+  node->child->child_node = NULL;
+
+  // area painted by child is to be repainted by parent
+  base->display_list.valid = false;
+
+  common_internal_mark_layout_dirty(base);
+  invalidate_absolute_positions(base);
+}
+
+/// @brief Grows index of children to hold all children of widget.
+/// @return `false` if there is no memory for growing it.
+static bool reserve_children_index(base_widget* base)
+{
+  if(base->children_index_capacity >= base->children_count)
+  {
+    return true;
+  }
+
+  uint32 capacity =
+    max(base->children_index_capacity * 2, base->children_count);
+  uint32* children_index =
+    (uint32*)realloc(base->children_index, capacity * sizeof(uint32));
+  if(!children_index)
+  {
+    return false;
+  }
+  base->children_index = children_index;
+  base->children_index_capacity = capacity;
+
+  return true;
+}
+
+/// @brief Patches index of children, for a run of `count` nodes linked at
+///        `index`, starting with `first`. Nodes after the run are moved,
+///        so appending takes amortized constant time.
+///        Index is left to be rebuilt by `get_child_node()` if it is
+///        already stale, (or) can't be grown.
+static void children_index_insert(base_widget* base,
+                                  uint32 index,
+                                  base_widget_child_node* first,
+                                  uint32 count)
+{
+  if(!base->children_index_valid)
+  {
+    return;
+  }
+
+  if(!reserve_children_index(base))
+  {
+    base->children_index_valid = false;
+    return;
+  }
+
+  // children count already includes the run
+  memmove(&base->children_index[index + count],
+          &base->children_index[index],
+          (base->children_count - count - index) * sizeof(uint32));
+
+  base_widget_child_node* node = first;
+  for(uint32 i = 0; i < count; i++)
+  {
+    base->children_index[index + i] = node->child->geometry_id;
+    node = node->next;
+  }
+}
+
+/// @brief Patches index of children, for a run of `count` nodes unlinked
+///        from `index`. Nodes after the run are moved, so removing the
+///        last child takes constant time.
+static void
+children_index_remove(base_widget* base, uint32 index, uint32 count)
+{
+  if(!base->children_index_valid)
+  {
+    return;
+  }
+
+  // children count already excludes the run
+  memmove(&base->children_index[index],
+          &base->children_index[index + count],
+          (base->children_count - index) * sizeof(uint32));
+}
+
+bool common_internal_index_children(base_widget* widget)
+{
+  if(widget->children_index_valid)
+  {
+    return true;
+  }
+
+  if(!reserve_children_index(widget))
+  {
+    return false;
+  }
+
+  uint32 i = 0;
+  base_widget_child_node* node = widget->children_head;
+  while(node)
+  {
+    widget->children_index[i++] = node->child->geometry_id;
+    node = node->next;
+  }
+  widget->children_index_valid = true;
+
+  return true;
+}
+
+/// @brief Gives node of child at index, rebuilding index of children if it
+///        is stale.
+static result_base_widget_child_node_ptr get_child_node(base_widget* base,
+                                                        uint32 index)
+{
+  if(index >= base->children_count)
+  {
+    return error(result_base_widget_child_node_ptr,
+                 "Child index is out of bounds of children list!");
+  }
+
+  if(!common_internal_index_children(base))
+  {
+    return error(result_base_widget_child_node_ptr,
+                 "Unable to allocate memory for index of children!");
+  }
+
+  base_widget* child = base->geometry->widgets[base->children_index[index]];
+
+  return ok(result_base_widget_child_node_ptr, child->child_node);
+}
+
+result_void base_widget_add_child(base_widget* base, base_widget* child)
+{
+  if(!base)
+  {
+    return error(result_void,
+                 "Cannot attach child to NULL pointed parent widget!");
+  }
+
+  if(base->type == FLEX_ITEM)
+  {
+    return error(result_void,
+                 "Cannot attach child to widget of type FLEX_ITEM!");
   }
 
-  base_widget_child_node* temp = base->children_head;
-  while(temp->next)
+  if(!child)
   {
-    temp = temp->next;
+    return error(result_void,
+                 "Cannot attach NULL pointed child to parent widget!");
   }
+
   result_base_widget_child_node_ptr _ = base_widget_child_node_new(child);
   if(!_.ok)
   {
     return error(result_void, _.error);
   }
 
-  child->parent = base;
-  temp->next = _.value;
+  result_void __ = link_child_node(base, _.value, base->children_tail);
+  if(!__.ok)
+  {
+    base_widget_child_node_free(_.value);
+    return __;
+  }
+  children_index_insert(base, base->children_count - 1, _.value, 1);
 
   return ok_void();
 }
@@ -181,12 +552,7 @@ result_void base_widget_add_child_after(base_widget* base,
       "Cannot attach child after a widget, which is pointing to NULL!");
   }
 
-  base_widget_child_node* temp = base->children_head;
-  while(temp && temp->child != after_this_widget)
-  {
-    temp = temp->next;
-  }
-  if(!temp)
+  if(after_this_widget->parent != base || !after_this_widget->child_node)
   {
     return error(result_void,
                  "Cannot find the 'after_this_widget' in children of the given "
@@ -199,85 +565,333 @@ result_void base_widget_add_child_after(base_widget* base,
     return error(result_void, _.error);
   }
 
-  _.value->next = temp->next;
-  temp->next = _.value;
-  child->context = base->context;
-  child->parent = base;
+  // position of an inner child is not known, index of children is rebuilt
+  // on next lookup
+  base_widget_child_node* after = after_this_widget->child_node;
+  bool append = after == base->children_tail;
+  result_void __ = link_child_node(base, _.value, after);
+  if(!__.ok)
+  {
+    base_widget_child_node_free(_.value);
+    return __;
+  }
+  if(append)
+  {
+    children_index_insert(base, base->children_count - 1, _.value, 1);
+  }
+  else
+  {
+    base->children_index_valid = false;
+  }
 
   return ok_void();
 }
 
-result_void base_widget_remove_child(base_widget* base, base_widget* child)
+result_void
+base_widget_insert_child(base_widget* base, base_widget* child, uint32 index)
 {
   if(!base)
   {
     return error(result_void,
-                 "Cannot remove child from NULL pointed parent widget!");
+                 "Cannot insert child into NULL pointed parent widget!");
   }
 
-  if(!child)
+  if(base->type == FLEX_ITEM)
   {
     return error(result_void,
-                 "Cannot remove NULL pointed child from parent widget!");
+                 "Cannot insert child into widget of type FLEX_ITEM!");
   }
 
-  if(!base->children_head)
+  if(!child)
   {
     return error(result_void,
-                 "Cannot remove child from empty children list of parent!");
+                 "Cannot insert NULL pointed child into parent widget!");
   }
 
-  base_widget_child_node* temp = base->children_head;
-  base_widget_child_node* prev_temp = NULL;
-  while(temp && temp->child != child)
+  if(index > base->children_count)
   {
-    prev_temp = temp;
-    temp = temp->next;
+    return error(result_void,
+                 "Cannot insert child past the end of children list!");
   }
 
-  if(!temp)
+  base_widget_child_node* after = NULL;
+  if(index == base->children_count)
   {
-    // child node not found with given child
-    return error(result_void,
-                 "Child node not found with given child to remove!");
+    after = base->children_tail;
+  }
+  else if(index > 0)
+  {
+    result_base_widget_child_node_ptr _ = get_child_node(base, index - 1);
+    if(!_.ok)
+    {
+      return error(result_void, _.error);
+    }
+    after = _.value;
   }
 
-  if(!prev_temp)
+  result_base_widget_child_node_ptr _ = base_widget_child_node_new(child);
+  if(!_.ok)
   {
-    // first child is to be deleted
-    base_widget_child_node* _ = base->children_head;
-    base->children_head = _->next;
-    base_widget_child_node_free(_);
-    return ok_void();
+    return error(result_void, _.error);
   }
 
-  prev_temp->next = temp->next;
-  temp->child->parent = NULL;
-  base_widget_child_node_free(temp);
+  result_void __ = link_child_node(base, _.value, after);
+  if(!__.ok)
+  {
+    base_widget_child_node_free(_.value);
+    return __;
+  }
+  children_index_insert(base, index, _.value, 1);
 
   return ok_void();
 }
 
-result_void base_widget_free(base_widget* widget)
+result_void base_widget_insert_children(base_widget* base,
+                                        uint32 index,
+                                        base_widget** children,
+                                        uint32 children_count)
 {
-  if(!widget)
+  if(!base)
   {
-    return error(result_void, "Attempt to free a NULL pointed base widget!");
+    return error(result_void,
+                 "Cannot insert children into NULL pointed parent widget!");
   }
 
-  free(widget);
-
-  return ok_void();
-}
-
-result_bool widget_set_visibility(base_widget* widget, bool visible)
-{
-  if(!widget)
+  if(base->type == FLEX_ITEM)
   {
-    return error(result_bool, "Cannot set visibility of NULL pointed widget!");
+    return error(result_void,
+                 "Cannot insert children into widget of type FLEX_ITEM!");
   }
 
-  widget->visible = visible;
+  if(!children && children_count)
+  {
+    return error(result_void,
+                 "Cannot insert NULL pointed children into parent widget!");
+  }
+
+  if(index > base->children_count)
+  {
+    return error(result_void,
+                 "Cannot insert children past the end of children list!");
+  }
+
+  for(uint32 i = 0; i < children_count; i++)
+  {
+    if(!children[i])
+    {
+      return error(result_void,
+                   "Cannot insert NULL pointed child into parent widget!");
+    }
+  }
+
+  if(!children_count)
+  {
+    return ok_void();
+  }
+
+  // resolving the anchor once, children are linked one after the other
+  base_widget_child_node* after = NULL;
+  if(index == base->children_count)
+  {
+    after = base->children_tail;
+  }
+  else if(index > 0)
+  {
+    result_base_widget_child_node_ptr _ = get_child_node(base, index - 1);
+    if(!_.ok)
+    {
+      return error(result_void, _.error);
+    }
+    after = _.value;
+  }
+
+  base_widget_child_node* first = NULL;
+  for(uint32 i = 0; i < children_count; i++)
+  {
+    result_base_widget_child_node_ptr _ =
+      base_widget_child_node_new(children[i]);
+    result_void __ = _.ok ? link_child_node(base, _.value, after)
+                          : error(result_void, _.error);
+    if(!__.ok)
+    {
+      if(_.ok)
+      {
+        base_widget_child_node_free(_.value);
+      }
+
+      // children linked so far stay, and are in the index
+      if(first)
+      {
+        children_index_insert(base, index, first, i);
+      }
+      return __;
+    }
+
+    after = _.value;
+    first = first ? first : _.value;
+  }
+
+  children_index_insert(base, index, first, children_count);
+
+  return ok_void();
+}
+
+result_void base_widget_add_children(base_widget* base,
+                                     base_widget** children,
+                                     uint32 children_count)
+{
+  if(!base)
+  {
+    return error(result_void,
+                 "Cannot attach children to NULL pointed parent widget!");
+  }
+
+  return base_widget_insert_children(
+    base, base->children_count, children, children_count);
+}
+
+result_base_widget_ptr base_widget_get_child(base_widget* base, uint32 index)
+{
+  if(!base)
+  {
+    return error(result_base_widget_ptr,
+                 "Cannot get child of NULL pointed parent widget!");
+  }
+
+  result_base_widget_child_node_ptr _ = get_child_node(base, index);
+  if(!_.ok)
+  {
+    return error(result_base_widget_ptr, _.error);
+  }
+
+  return ok(result_base_widget_ptr, _.value->child);
+}
+
+result_void base_widget_remove_child(base_widget* base, base_widget* child)
+{
+  if(!base)
+  {
+    return error(result_void,
+                 "Cannot remove child from NULL pointed parent widget!");
+  }
+
+  if(!child)
+  {
+    return error(result_void,
+                 "Cannot remove NULL pointed child from parent widget!");
+  }
+
+  if(!base->children_head)
+  {
+    return error(result_void,
+                 "Cannot remove child from empty children list of parent!");
+  }
+
+  if(child->parent != base || !child->child_node)
+  {
+    // child node not found with given child
+    return error(result_void,
+                 "Child node not found with given child to remove!");
+  }
+
+  // position of an inner child is not known, index of children is rebuilt
+  // on next lookup
+  base_widget_child_node* node = child->child_node;
+  bool known_position =
+    node == base->children_head || node == base->children_tail;
+  uint32 index = node == base->children_head ? 0 : base->children_count - 1;
+  unlink_child_node(base, node);
+  base_widget_child_node_free(node);
+  if(known_position)
+  {
+    children_index_remove(base, index, 1);
+  }
+  else
+  {
+    base->children_index_valid = false;
+  }
+
+  return ok_void();
+}
+
+result_void base_widget_remove_children(base_widget* base,
+                                        uint32 index,
+                                        uint32 children_count)
+{
+  if(!base)
+  {
+    return error(result_void,
+                 "Cannot remove children from NULL pointed parent widget!");
+  }
+
+  if(!children_count)
+  {
+    return ok_void();
+  }
+
+  if(index > base->children_count ||
+     children_count > base->children_count - index)
+  {
+    return error(result_void,
+                 "Cannot remove children past the end of children list!");
+  }
+
+  result_base_widget_child_node_ptr _ = get_child_node(base, index);
+  if(!_.ok)
+  {
+    return error(result_void, _.error);
+  }
+
+  base_widget_child_node* node = _.value;
+  for(uint32 i = 0; i < children_count; i++)
+  {
+    base_widget_child_node* next = node->next;
+    unlink_child_node(base, node);
+    base_widget_child_node_free(node);
+    node = next;
+  }
+  children_index_remove(base, index, children_count);
+
+  return ok_void();
+}
+
+result_void base_widget_free(base_widget* widget)
+{
+  if(!widget)
+  {
+    return error(result_void, "Attempt to free a NULL pointed base widget!");
+  }
+
+  if(widget->pending_updates && widget->context)
+  {
+    // queued updates would outlive widget
+    internal_context_dequeue_update(widget->context, widget);
+  }
+
+  geometry_store_release(widget->geometry, widget->geometry_id);
+  free(widget->children_index);
+  free(widget);
+
+  return ok_void();
+}
+
+result_bool widget_set_visibility(base_widget* widget, bool visible)
+{
+  if(!widget)
+  {
+    return error(result_bool, "Cannot set visibility of NULL pointed widget!");
+  }
+
+  widget_visible(widget) = visible;
+
+  if(widget->parent)
+  {
+    // area painted by widget is to be repainted by parent
+    widget->parent->display_list.valid = false;
+  }
+
+  // space of widget is to be shared among its siblings
+  common_internal_mark_layout_dirty(widget);
 
   // calling internal adjust layout callback
   // on parent widget as visibility of one of its child has changed
@@ -299,251 +913,931 @@ result_bool widget_set_flex_direction(base_widget* widget,
                  "Cannot set flex-drection of NULL pointed widget!");
   }
 
-  if(widget->type != FLEX_CONTAINER)
-  {
-    return ok(result_bool, false);
+  if(widget->type != FLEX_CONTAINER)
+  {
+    return ok(result_bool, false);
+  }
+
+  widget->flexbox_data.container.direction = direction;
+  common_internal_mark_layout_dirty(widget);
+
+  // triggering re-adjust layout on this widget
+  common_internal_adjust_layout(widget);
+
+  return ok(result_bool, true);
+}
+
+result_bool widget_set_justify_content(base_widget* widget,
+                                       flex_justify_content justify_content)
+{
+  if(!widget)
+  {
+    return error(result_bool,
+                 "Cannot set justify-container of NULL pointed widget!");
+  }
+
+  if(widget->type != FLEX_CONTAINER)
+  {
+    return ok(result_bool, false);
+  }
+
+  widget->flexbox_data.container.justify_content = justify_content;
+  common_internal_mark_layout_dirty(widget);
+
+  // triggering re-adjust layout on this widget
+  common_internal_adjust_layout(widget);
+
+  return ok(result_bool, true);
+}
+
+result_bool widget_set_align_items(base_widget* widget,
+                                   flex_align_items align_items)
+{
+  if(!widget)
+  {
+    return error(result_bool, "Cannot set align-items of NULL pointed widget!");
+  }
+
+  if(widget->type != FLEX_CONTAINER)
+  {
+    return ok(result_bool, false);
+  }
+
+  widget->flexbox_data.container.align_items = align_items;
+  common_internal_mark_layout_dirty(widget);
+
+  // triggering re-adjust layout on this widget
+  common_internal_adjust_layout(widget);
+
+  return ok(result_bool, true);
+}
+
+result_bool widget_set_gap(base_widget* widget, uint8 gap)
+{
+  if(!widget)
+  {
+    return error(result_bool, "Cannot set gap of NULL pointed widget!");
+  }
+
+  if(widget->type != FLEX_CONTAINER)
+  {
+    return ok(result_bool, false);
+  }
+
+  widget->flexbox_data.container.gap = gap;
+  common_internal_mark_layout_dirty(widget);
+
+  // triggering re-adjust layout on this widget
+  common_internal_adjust_layout(widget);
+
+  return ok(result_bool, true);
+}
+
+result_void widget_set_flex_grow(base_widget* widget, uint8 flex_grow)
+{
+  if(!widget)
+  {
+    return error(result_void, "Cannot set flex-grow of NULL pointed widget!");
+  }
+
+  widget_flex_grow(widget) = flex_grow;
+  common_internal_mark_layout_dirty(widget);
+
+  if(widget->type == FLEX_CONTAINER)
+  {
+    // triggering re-adjust layout on this widget
+    common_internal_adjust_layout(widget);
+  }
+
+  return ok_void();
+}
+
+result_void widget_set_flex_shrink(base_widget* widget, uint8 flex_shrink)
+{
+  if(!widget)
+  {
+    return error(result_void, "Cannot set flex-shrink of NULL pointed widget!");
+  }
+
+  widget_flex_shrink(widget) = flex_shrink;
+  common_internal_mark_layout_dirty(widget);
+
+  if(widget->type == FLEX_CONTAINER)
+  {
+    // triggering re-adjust layout on this widget
+    common_internal_adjust_layout(widget);
+  }
+
+  return ok_void();
+}
+
+result_void
+widget_set_cross_axis_sizing(base_widget* widget,
+                             flex_cross_axis_sizing cross_axis_sizing)
+{
+  if(!widget)
+  {
+    return error(result_void,
+                 "Cannot set cross-axis-sizing of NULL pointed widget!");
+  }
+
+  widget_cross_axis_sizing(widget) = cross_axis_sizing;
+  common_internal_mark_layout_dirty(widget);
+
+  if(widget->type == FLEX_CONTAINER)
+  {
+    // triggering re-adjust layout on this widget
+    common_internal_adjust_layout(widget);
+  }
+
+  return ok_void();
+}
+
+rect default_internal_get_bounding_rect_callback(const base_widget* widget)
+{
+  return common_internal_get_bounding_rect(widget);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Common functions implementation
+///////////////////////////////////////////////////////////////////////////////
+
+rect common_internal_get_bounding_rect(const base_widget* widget)
+{
+  return common_internal_clip_virtual_rect(
+    common_internal_get_virtual_rect(widget));
+}
+
+rect common_internal_clip_virtual_rect(virtual_rect bounds)
+{
+  // clipping to the range of `rect`, which is still far beyond viewport
+  int64 left = max((int64)bounds.x, (int64)INT16_MIN);
+  int64 top = max((int64)bounds.y, (int64)INT16_MIN);
+  int64 right = min((int64)bounds.x + bounds.w, (int64)INT16_MAX);
+  int64 bottom = min((int64)bounds.y + bounds.h, (int64)INT16_MAX);
+
+  return (rect){.x = (int16)min(left, (int64)INT16_MAX),
+                .y = (int16)min(top, (int64)INT16_MAX),
+                .w = (uint16)max(right - left, (int64)0),
+                .h = (uint16)max(bottom - top, (int64)0)};
+}
+
+virtual_rect common_internal_get_virtual_rect(const base_widget* widget)
+{
+  virtual_point position = common_internal_get_absolute_position(widget);
+
+  return (virtual_rect){.x = position.x,
+                        .y = position.y,
+                        .w = widget_w(widget),
+                        .h = widget_h(widget)};
+}
+
+virtual_point common_internal_get_absolute_position(const base_widget* widget)
+{
+  internal_context* context = widget->context;
+  if(context && widget->absolute.generation == context->position_generation)
+  {
+    return widget->absolute.position;
+  }
+
+  // summing relative positions up to the nearest ancestor whose absolute
+  // position is memoized, which is the parent when walking down the tree
+  virtual_point position = {.x = widget_x(widget), .y = widget_y(widget)};
+  const base_widget* ancestor = widget->parent;
+  while(ancestor)
+  {
+    position.x += ancestor->children_offset.x;
+    position.y += ancestor->children_offset.y;
+    if(context && ancestor->absolute.generation == context->position_generation)
+    {
+      position.x += ancestor->absolute.position.x;
+      position.y += ancestor->absolute.position.y;
+      break;
+    }
+    position.x += widget_x(ancestor);
+    position.y += widget_y(ancestor);
+    ancestor = ancestor->parent;
+  }
+
+  if(context)
+  {
+    // memoizing is not a visible change of widget
+    base_widget* memoized = (base_widget*)widget;
+    memoized->absolute =
+      (absolute_position){.generation = context->position_generation,
+                          .position = position};
+  }
+
+  return position;
+}
+
+void common_internal_set_children_offset(base_widget* widget,
+                                         virtual_point offset)
+{
+  if(widget->children_offset.x == offset.x &&
+     widget->children_offset.y == offset.y)
+  {
+    return;
+  }
+
+  widget->children_offset = offset;
+  invalidate_absolute_positions(widget);
+}
+
+/// @brief Tells if size of child has to be calculated, before the size of
+///        its parent is.
+static bool calculate_size_visits_child(const base_widget* widget,
+                                        const base_widget* child)
+{
+  if(widget->type == FLEX_ITEM || !widget_visible(child))
+  {
+    return false;
+  }
+
+  // sizes of fluid containers depend only on children which need resizing,
+  // non-fluid containers are skipped, but their children are visited
+  return !widget->flexbox_data.container.is_fluid || child->need_resizing;
+}
+
+/// @brief Calculates size of widget, from the calculated sizes of its
+///        children.
+static void calculate_own_size(base_widget* widget)
+{
+  if(widget->type == FLEX_ITEM)
+  {
+    if(widget->need_resizing)
+    {
+      if(widget->internal_fit_layout_callback)
+      {
+        widget->internal_fit_layout_callback(widget, false);
+      }
+      widget->need_resizing = false;
+
+      // size of widget may have changed, parent has to lay it out again
+      if(widget->parent)
+      {
+        common_internal_mark_layout_dirty(widget->parent);
+      }
+    }
+    return;
+  }
+
+  if(!widget->flexbox_data.container.is_fluid)
+  {
+    return;
+  }
+
+  uint32 main_axis_length = 0, cross_axis_length = 0;
+  base_widget_child_node* node = widget->children_head;
+  while(node)
+  {
+    // skipping invisible nodes
+    if(!widget_visible(node->child))
+    {
+      node = node->next;
+      continue;
+    }
+
+    if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
+    {
+      main_axis_length += widget_w(node->child);
+      cross_axis_length = max(cross_axis_length, widget_h(node->child));
+    }
+    else
+    {
+      main_axis_length += widget_h(node->child);
+      cross_axis_length = max(cross_axis_length, widget_w(node->child));
+    }
+    main_axis_length += widget->flexbox_data.container.gap;
+    node = node->next;
+  }
+  if(main_axis_length)
+  {
+    main_axis_length -= widget->flexbox_data.container.gap;
+  }
+
+  // assigning calculated axes lengths to widget's dimensions.
+  if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
+  {
+    widget_w(widget) = main_axis_length;
+    widget_h(widget) = cross_axis_length;
+  }
+  else
+  {
+    widget_w(widget) = cross_axis_length;
+    widget_h(widget) = main_axis_length;
+  }
+
+  debug("Widget: (%s), w: %d, h: %d",
+        widget->debug_name,
+        widget_w(widget),
+        widget_h(widget));
+}
+
+/// @brief Visits widgets whose sizes are to be calculated, in post-order,
+///        children before their parent.
+static result_void visit_in_calculate_size_order(base_widget* widget,
+                                                 void (*visit)(base_widget*))
+{
+  traversal_stack local_stack = {0};
+  traversal_stack* stack =
+    widget->context ? &widget->context->traversal_stack : &local_stack;
+  uint32 base = stack->count;
+
+  result_void _ = traversal_stack_push(stack, widget);
+  while(_.ok && stack->count > base)
+  {
+    traversal_frame* frame = &stack->frames[stack->count - 1];
+
+    base_widget_child_node* node = frame->node;
+    while(node && !calculate_size_visits_child(frame->widget, node->child))
+    {
+      node = node->next;
+    }
+
+    if(node)
+    {
+      frame->node = node->next;
+      _ = traversal_stack_push(stack, node->child);
+      continue;
+    }
+
+    stack->count--;
+    visit(frame->widget);
+  }
+
+  stack->count = base;
+  free(local_stack.frames);
+
+  return _;
+}
+
+/// @brief Computes stale descendants counts in subtree of widget, in
+///        post-order, summing counts of children into their parent.
+///        Only subtrees whose children were linked (or) unlinked are visited.
+static result_void update_descendants_count(base_widget* widget)
+{
+  traversal_stack local_stack = {0};
+  traversal_stack* stack =
+    widget->context ? &widget->context->traversal_stack : &local_stack;
+  uint32 base = stack->count;
+
+  result_void _ = ok_void();
+  if(!widget->descendants_count_valid)
+  {
+    _ = traversal_stack_push(stack, widget);
+  }
+  while(_.ok && stack->count > base)
+  {
+    traversal_frame* frame = &stack->frames[stack->count - 1];
+
+    base_widget_child_node* node = frame->node;
+    while(node && node->child->descendants_count_valid)
+    {
+      node = node->next;
+    }
+
+    if(node)
+    {
+      frame->node = node->next;
+      _ = traversal_stack_push(stack, node->child);
+      continue;
+    }
+
+    stack->count--;
+
+    base_widget* counted = frame->widget;
+    counted->descendants_count = 0;
+    for(node = counted->children_head; node; node = node->next)
+    {
+      counted->descendants_count += node->child->descendants_count + 1;
+    }
+    counted->descendants_count_valid = true;
   }
 
-  widget->flexbox_data.container.direction = direction;
-
-  // triggering re-adjust layout on this widget
-  common_internal_adjust_layout(widget);
+  stack->count = base;
+  free(local_stack.frames);
 
-  return ok(result_bool, true);
+  return _;
 }
 
-result_bool widget_set_justify_content(base_widget* widget,
-                                       flex_justify_content justify_content)
+/// @brief Gathers text of widget to be measured in batch, if it is going to
+///        be fit.
+static void batch_text_of_resized_item(base_widget* widget)
 {
-  if(!widget)
+  if(widget->type == FLEX_ITEM && widget->need_resizing)
   {
-    return error(result_bool,
-                 "Cannot set justify-container of NULL pointed widget!");
+    // ignoring errors, texts left out are measured while fitting
+    result_void _ = common_internal_batch_text(widget);
+    (void)_;
   }
+}
 
-  if(widget->type != FLEX_CONTAINER)
+result_void common_internal_calculate_size(base_widget* widget)
+{
+  if(!widget_visible(widget))
   {
-    return ok(result_bool, false);
+    // avoiding calculations when widget is not visible
+    return ok_void();
   }
 
-  widget->flexbox_data.container.justify_content = justify_content;
+  // counts are read while re-layouting, which follows calculating sizes
+  result_void _ = update_descendants_count(widget);
+  if(!_.ok)
+  {
+    return _;
+  }
 
-  // triggering re-adjust layout on this widget
-  common_internal_adjust_layout(widget);
+  internal_context* context = widget->context;
+  if(context && context->backend && context->backend->get_texts_dimensions)
+  {
+    // measuring texts of all items to be fit in one go, before fitting them.
+    // ignoring errors, texts left out are measured while fitting
+    _ = visit_in_calculate_size_order(widget, batch_text_of_resized_item);
+    _ = internal_context_measure_batched_texts(context);
+    (void)_;
+  }
 
-  return ok(result_bool, true);
+  return visit_in_calculate_size_order(widget, calculate_own_size);
 }
 
-result_bool widget_set_align_items(base_widget* widget,
-                                   flex_align_items align_items)
+bool common_internal_get_measured_size(const base_widget* widget,
+                                       text_dimensions* dimensions)
 {
-  if(!widget)
+  if(!widget->measured.valid || !widget->context ||
+     widget->measured.font_generation != widget->context->font_generation)
   {
-    return error(result_bool, "Cannot set align-items of NULL pointed widget!");
+    return false;
   }
 
-  if(widget->type != FLEX_CONTAINER)
+  *dimensions = widget->measured.dimensions;
+
+  return true;
+}
+
+void common_internal_set_measured_size(base_widget* widget,
+                                       text_dimensions dimensions)
+{
+  widget->measured.valid = true;
+  widget->measured.font_generation =
+    widget->context ? widget->context->font_generation : 0;
+  widget->measured.dimensions = dimensions;
+}
+
+result_void common_internal_batch_text(base_widget* widget)
+{
+  text_dimensions dimensions;
+  if(!widget->internal_get_text_callback || !widget->context ||
+     common_internal_get_measured_size(widget, &dimensions))
   {
-    return ok(result_bool, false);
+    return ok_void();
   }
 
-  widget->flexbox_data.container.align_items = align_items;
+  font_handle font = DEFAULT_FONT_HANDLE;
+  const char* text = widget->internal_get_text_callback(widget, &font);
 
-  // triggering re-adjust layout on this widget
-  common_internal_adjust_layout(widget);
+  return internal_context_batch_text(widget->context, widget, text, font);
+}
 
-  return ok(result_bool, true);
+void common_internal_invalidate_measured_size(base_widget* widget)
+{
+  widget->measured.valid = false;
 }
 
-result_bool widget_set_gap(base_widget* widget, uint8 gap)
+/// @brief Grows storage of glyph run to hold `capacity` glyphs.
+static result_void reserve_glyph_run(glyph_run* run, uint32 capacity)
 {
-  if(!widget)
+  if(run->capacity >= capacity)
   {
-    return error(result_bool, "Cannot set gap of NULL pointed widget!");
+    return ok_void();
   }
 
-  if(widget->type != FLEX_CONTAINER)
+  positioned_glyph* glyphs = (positioned_glyph*)realloc(
+    run->glyphs, (size_t)capacity * sizeof(positioned_glyph));
+  if(!glyphs)
   {
-    return ok(result_bool, false);
+    return error(result_void, "Unable to allocate memory for glyph run!");
   }
 
-  widget->flexbox_data.container.gap = gap;
-
-  // triggering re-adjust layout on this widget
-  common_internal_adjust_layout(widget);
+  run->glyphs = glyphs;
+  run->capacity = capacity;
 
-  return ok(result_bool, true);
+  return ok_void();
 }
 
-result_void widget_set_flex_grow(base_widget* widget, uint8 flex_grow)
+/// @brief Shapes text into glyph run using backend.
+static result_void shape_glyph_run(const render_backend* backend,
+                                   glyph_run* run,
+                                   const char* text,
+                                   font_handle font)
 {
-  if(!widget)
+  // texts rarely have more glyphs than bytes, so they are shaped only once
+  result_void _ = reserve_glyph_run(run, (uint32)strlen(text));
+  if(!_.ok)
   {
-    return error(result_void, "Cannot set flex-grow of NULL pointed widget!");
+    return _;
   }
 
-  if(widget->type == FLEX_CONTAINER)
+  uint32 glyphs_count = 0;
+  _ = backend->shape_text(
+    text, font, run->glyphs, run->capacity, &glyphs_count);
+  if(!_.ok)
   {
-    widget->flexbox_data.container.flex_grow = flex_grow;
+    return _;
+  }
 
-    // triggering re-adjust layout on this widget
-    common_internal_adjust_layout(widget);
+  if(glyphs_count > run->capacity)
+  {
+    _ = reserve_glyph_run(run, glyphs_count);
+    if(!_.ok)
+    {
+      return _;
+    }
+
+    _ = backend->shape_text(
+      text, font, run->glyphs, run->capacity, &glyphs_count);
+    if(!_.ok)
+    {
+      return _;
+    }
   }
-  else
+
+  if(glyphs_count > UINT16_MAX)
   {
-    widget->flexbox_data.item.flex_grow = flex_grow;
+    return error(result_void, "Cannot render glyph run, text is too long!");
   }
 
+  run->glyphs_count = glyphs_count;
+
   return ok_void();
 }
 
-result_void widget_set_flex_shrink(base_widget* widget, uint8 flex_shrink)
+result_void common_internal_render_text(const base_widget* widget,
+                                        glyph_run* run,
+                                        const char* text,
+                                        font_handle font,
+                                        color text_color,
+                                        point text_coordinates)
 {
-  if(!widget)
+  internal_context* context = widget->context;
+  const render_backend* backend = context->backend;
+
+  if(backend && backend->shape_text &&
+     (!run->valid || run->font_generation != context->font_generation))
   {
-    return error(result_void, "Cannot set flex-shrink of NULL pointed widget!");
+    run->valid = shape_glyph_run(backend, run, text, font).ok;
+    run->font_generation = context->font_generation;
   }
 
-  if(widget->type == FLEX_CONTAINER)
+  // dimensions bound the area painted by text, text measured by layout is
+  // given as it is, and text measured otherwise is mostly in text cache
+  text_dimensions dimensions = {0};
+  if(!common_internal_get_measured_size(widget, &dimensions) && backend)
   {
-    widget->flexbox_data.container.flex_shrink = flex_shrink;
-
-    // triggering re-adjust layout on this widget
-    common_internal_adjust_layout(widget);
+    result_text_dimensions _ =
+      internal_context_measure_text(context, text, font);
+    dimensions = _.ok ? _.value : (text_dimensions){0};
   }
-  else
+
+  if(!backend || !backend->shape_text || !run->valid)
   {
-    widget->flexbox_data.item.flex_shrink = flex_shrink;
+    // texts which couldn't be shaped are rendered as they are
+    return command_buffer_add_render_text_command(context->cmd_buffer,
+                                                  text,
+                                                  font,
+                                                  text_color,
+                                                  text_coordinates,
+                                                  dimensions);
   }
 
-  return ok_void();
+  return command_buffer_add_render_glyph_run_command(context->cmd_buffer,
+                                                     run->glyphs,
+                                                     (uint16)run->glyphs_count,
+                                                     font,
+                                                     text_color,
+                                                     text_coordinates,
+                                                     dimensions);
 }
 
-result_void
-widget_set_cross_axis_sizing(base_widget* widget,
-                             flex_cross_axis_sizing cross_axis_sizing)
+void common_internal_invalidate_glyph_run(glyph_run* run)
 {
-  if(!widget)
+  run->valid = false;
+}
+
+void common_internal_free_glyph_run(glyph_run* run)
+{
+  free(run->glyphs);
+  *run = (glyph_run){0};
+}
+
+void common_internal_mark_layout_dirty(base_widget* widget)
+{
+  widget->layout.layout_dirty = true;
+
+  // ancestors are marked too, so re-layouting from any of them
+  // reaches this widget. ancestors of a dirty ancestor are already dirty,
+  // as re-layouts clear flags from top to bottom, so marking stops at it
+  base_widget* ancestor = widget->parent;
+  while(ancestor && !ancestor->layout.layout_dirty)
   {
-    return error(result_void,
-                 "Cannot set cross-axis-sizing of NULL pointed widget!");
+    ancestor->layout.layout_dirty = true;
+    ancestor = ancestor->parent;
   }
+}
 
-  if(widget->type == FLEX_CONTAINER)
+void common_internal_invalidate_display_list(base_widget* widget)
+{
+  base_widget* descendant = widget;
+  while(descendant)
+  {
+    descendant->display_list.valid = false;
+    descendant = next_in_subtree(widget, descendant, false);
+  }
+}
+
+/// @brief Grows scratch memory for diffing display lists, to hold
+///        `length` commands.
+static result_void reserve_diff_scratch(internal_context* context,
+                                        uint32 length)
+{
+  if(context->diff_scratch_capacity >= length)
   {
-    widget->flexbox_data.container.cross_axis_sizing = cross_axis_sizing;
+    return ok_void();
+  }
 
-    // triggering re-adjust layout on this widget
-    common_internal_adjust_layout(widget);
+  uint32* owners =
+    (uint32*)realloc(context->command_owners, length * sizeof(uint32));
+  if(!owners)
+  {
+    return error(result_void,
+                 "Unable to allocate memory for diffing display lists!");
   }
-  else
+  context->command_owners = owners;
+
+  bool* removed =
+    (bool*)realloc(context->removed_commands, length * sizeof(bool));
+  if(!removed)
   {
-    widget->flexbox_data.item.cross_axis_sizing = cross_axis_sizing;
+    return error(result_void,
+                 "Unable to allocate memory for diffing display lists!");
   }
+  context->removed_commands = removed;
+
+  context->diff_scratch_capacity = length;
 
   return ok_void();
 }
 
-rect default_internal_get_bounding_rect_callback(const base_widget* widget)
+static bool rect_equals(rect a, rect b)
 {
-  return (rect){.x = widget->x, .y = widget->y, .w = widget->w, .h = widget->h};
+  return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
 }
 
-///////////////////////////////////////////////////////////////////////////////
-/// Common functions implementation
-///////////////////////////////////////////////////////////////////////////////
-
-rect common_internal_get_bounding_rect(const base_widget* widget)
+/// @brief Tells if area of widget previously painted by a child is to be
+///        repainted by the widget, as the child has moved, resized, or
+///        isn't rendered anymore.
+static bool children_uncovered_area(const base_widget* widget, uint32 pass)
 {
-  return (rect){.x = widget->x, .y = widget->y, .w = widget->w, .h = widget->h};
+  base_widget_child_node* node = widget->children_head;
+  while(node)
+  {
+    const base_widget* child = node->child;
+    if(child->display_list.valid &&
+       (child->display_list.render_pass != pass ||
+        !rect_equals(child->display_list.geometry,
+                     common_internal_get_bounding_rect(child))))
+    {
+      return true;
+    }
+    node = node->next;
+  }
+
+  return false;
 }
 
-result_void common_internal_calculate_size(base_widget* widget)
+/// @brief Drops commands of render pass, which are already on screen.
+///        A widget's commands are emitted if its own commands or geometry
+///        changed, (or) an ancestor's commands are emitted, as they paint
+///        over the widget.
+static result_void diff_display_lists(internal_context* context)
 {
-  if(!widget->visible)
+  render_record* records = context->render_records;
+  uint32 records_count = context->render_records_count;
+  uint32 begin = records[0].begin;
+  uint32 end = records[0].end;
+  uint32 pass = context->render_pass;
+
+  result_void _ = reserve_diff_scratch(context, end - begin);
+  if(!_.ok)
   {
-    // avoiding calculations when widget is not visible
-    return ok_void();
+    return _;
   }
 
-  if(widget->type == FLEX_ITEM)
+  // finding deepest record owning each command, records are in pre-order
+  uint32* owners = context->command_owners;
+  uint32 current = RENDER_RECORD_NONE;
+  uint32 next = 0;
+  for(uint32 i = begin; i < end; i++)
   {
-    if(widget->need_resizing)
+    while(current != RENDER_RECORD_NONE && records[current].end <= i)
     {
-      if(widget->internal_fit_layout_callback)
+      current = records[current].parent;
+    }
+    while(next < records_count && records[next].begin <= i)
+    {
+      if(records[next].end > i)
       {
-        widget->internal_fit_layout_callback(widget, false);
+        current = next;
       }
-      widget->need_resizing = false;
+      next++;
     }
-    return ok_void();
+    owners[i - begin] = current;
   }
 
-  if(!widget->flexbox_data.container.is_fluid)
+  // hashing own commands of each record
+  const command_buffer* cmd_buffer = context->cmd_buffer;
+  for(uint32 r = 0; r < records_count; r++)
   {
-    // skip this widget but call calculate sizing on children widgets
-    base_widget_child_node* node = widget->children_head;
+    records[r].hash = COMMAND_HASH_SEED;
+  }
+  for(uint32 i = begin; i < end; i++)
+  {
+    render_record* owner = &records[owners[i - begin]];
+    owner->hash =
+      command_hash(command_buffer_get_command(cmd_buffer, i), owner->hash);
+  }
+
+  for(uint32 r = 0; r < records_count; r++)
+  {
+    render_record* record = &records[r];
+    base_widget* widget = record->widget;
+    display_list* list = &widget->display_list;
+    rect geometry = common_internal_get_bounding_rect(widget);
+
+    bool ancestor_emitted =
+      record->parent != RENDER_RECORD_NONE && records[record->parent].emitted;
+    record->emitted = ancestor_emitted || !list->valid ||
+                      list->hash != record->hash ||
+                      !rect_equals(list->geometry, geometry) ||
+                      children_uncovered_area(widget, pass);
+
+    list->valid = true;
+    list->hash = record->hash;
+    list->geometry = geometry;
+  }
+
+  // children which were not rendered are not on screen anymore
+  for(uint32 r = 0; r < records_count; r++)
+  {
+    base_widget_child_node* node = records[r].widget->children_head;
     while(node)
     {
-      if(node->child->visible)
+      if(node->child->display_list.render_pass != pass)
       {
-        result_void _ = common_internal_calculate_size(node->child);
-        if(!_.ok)
-        {
-          return _;
-        }
+        common_internal_invalidate_display_list(node->child);
       }
       node = node->next;
     }
+  }
+
+  // dropping draw commands of widgets which were not emitted,
+  // clip and cursor commands are kept as they change state of backend
+  bool* removed = context->removed_commands;
+  uint32 removed_count = 0;
+  uint32 emitted_count = 0;
+  for(uint32 i = begin; i < end; i++)
+  {
+    command_type type = command_buffer_get_command(cmd_buffer, i)->type;
+    bool draw = type == RENDER_LINE || type == RENDER_TEXT ||
+                type == RENDER_RECT || type == RENDER_ROUNDED_RECT ||
+                type == RENDER_RECT_OUTLINED || type == RENDER_RECTS ||
+                type == RENDER_GLYPH_RUN;
+    removed[i - begin] = draw && !records[owners[i - begin]].emitted;
+    removed_count += removed[i - begin];
+  }
+  for(uint32 r = 0; r < records_count; r++)
+  {
+    emitted_count += records[r].emitted;
+  }
 
+  context->display_list_stats.widgets_rendered += records_count;
+  context->display_list_stats.widgets_emitted += emitted_count;
+  context->display_list_stats.commands_dropped += removed_count;
+
+  if(!removed_count)
+  {
     return ok_void();
   }
 
-  uint16 main_axis_length = 0, cross_axis_length = 0;
-  base_widget_child_node* node = widget->children_head;
-  while(node)
+  return command_buffer_remove_commands(context->cmd_buffer, begin, removed);
+}
+
+result_bool common_internal_render(base_widget* widget)
+{
+  if(!widget)
   {
-    // skipping invisible nodes
-    if(!node->child->visible)
-    {
-      node = node->next;
-      continue;
-    }
+    return error(result_bool, "Cannot render NULL pointed widget!");
+  }
 
-    if(node->child->need_resizing)
-    {
-      common_internal_calculate_size(node->child);
-    }
-    if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
+  if(!widget->internal_render_callback)
+  {
+    return ok(result_bool, false);
+  }
+
+  internal_context* context = widget->context;
+  if(context && context->deferred_updates && !context->updating &&
+     context->render_depth == 0)
+  {
+    result_void _ =
+      internal_context_queue_update(context, widget, PENDING_UPDATE_RENDER);
+    if(!_.ok)
     {
-      main_axis_length += node->child->w;
-      cross_axis_length = max(cross_axis_length, node->child->h);
+      return error(result_bool, _.error);
     }
-    else
+
+    return ok(result_bool, true);
+  }
+
+  if(!context)
+  {
+    return widget->internal_render_callback(widget);
+  }
+
+  if(!context->retained_rendering)
+  {
+    // tracking depth, so renders of children are not deferred
+    context->render_depth += 1;
+    result_bool _ = widget->internal_render_callback(widget);
+    context->render_depth -= 1;
+    return _;
+  }
+
+  if(context->render_depth == 0)
+  {
+    context->render_pass += 1;
+    context->render_records_count = 0;
+  }
+
+  // recording range of commands rendered by widget
+  if(context->render_records_count == context->render_records_capacity)
+  {
+    uint32 capacity = context->render_records_capacity
+                        ? context->render_records_capacity * 2
+                        : 64;
+    render_record* records = (render_record*)realloc(
+      context->render_records, capacity * sizeof(render_record));
+    if(!records)
     {
-      main_axis_length += node->child->h;
-      cross_axis_length = max(cross_axis_length, node->child->w);
+      return error(result_bool,
+                   "Unable to allocate memory for render records!");
     }
-    main_axis_length += widget->flexbox_data.container.gap;
-    node = node->next;
+    context->render_records = records;
+    context->render_records_capacity = capacity;
   }
-  main_axis_length -= widget->flexbox_data.container.gap;
 
-  // assigning calculated axes lengths to widget's dimensions.
-  if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
+  uint32 index = context->render_records_count++;
+  uint32 parent =
+    context->render_depth > 0 ? context->render_record_current
+                              : RENDER_RECORD_NONE;
+
+  uint32 begin = command_buffer_length(context->cmd_buffer);
+  context->render_records[index] = (render_record){.widget = widget,
+                                                   .begin = begin,
+                                                   .end = begin,
+                                                   .parent = parent,
+                                                   .hash = 0,
+                                                   .emitted = true};
+  widget->display_list.render_pass = context->render_pass;
+
+  context->render_depth += 1;
+  context->render_record_current = index;
+  result_bool _ = widget->internal_render_callback(widget);
+  context->render_record_current = parent;
+  context->render_depth -= 1;
+
+  context->render_records[index].end =
+    command_buffer_length(context->cmd_buffer);
+
+  if(context->render_depth > 0)
   {
-    widget->w = main_axis_length;
-    widget->h = cross_axis_length;
+    return _;
   }
-  else
+
+  if(!_.ok)
   {
-    widget->w = cross_axis_length;
-    widget->h = main_axis_length;
+    // commands of failed render may be incomplete, nothing is on screen
+    // as it was hashed
+    common_internal_invalidate_display_list(widget);
+    return _;
   }
 
-  debug("Widget: (%s), w: %d, h: %d", widget->debug_name, widget->w, widget->h);
+  result_void __ = diff_display_lists(context);
+  if(!__.ok)
+  {
+    return error(result_bool, __.error);
+  }
 
-  return ok_void();
+  return _;
 }
 
 void common_internal_free(base_widget* widget)
@@ -553,22 +1847,31 @@ void common_internal_free(base_widget* widget)
     return;
   }
 
-  // freeing children widgets (not children nodes, node will be free later
-  // in base_widget_free)
-  base_widget_child_node* node = widget->children_head;
-  while(node)
+  // freeing in post-order, descending into the first child still linked,
+  // and unlinking it, until a widget without children is reached
+  base_widget* descendant = widget;
+  while(descendant)
   {
-    common_internal_free(node->child);
-    node = node->next;
-  }
+    base_widget_child_node* node = descendant->children_head;
+    if(node)
+    {
+      descendant->children_head = node->next;
+      descendant = node->child;
+      base_widget_child_node_free(node);
+      continue;
+    }
 
-  // freeing derived widget fields
-  if(widget->derived && widget->internal_derived_free_callback)
-  {
-    widget->internal_derived_free_callback(widget);
-  }
+    base_widget* parent = descendant != widget ? descendant->parent : NULL;
+
+    // freeing derived widget fields
+    if(descendant->derived && descendant->internal_derived_free_callback)
+    {
+      descendant->internal_derived_free_callback(descendant);
+    }
 
-  base_widget_free(widget);
+    base_widget_free(descendant);
+    descendant = parent;
+  }
 }
 
 result_bool
@@ -584,22 +1887,19 @@ common_internal_mouse_motion(base_widget* widget,
 
   if(internal_event->state == BUBBLING_UP)
   {
-    // call callbacks if present
+    // call callbacks if present, on widget and all of its ancestors
     // setting context's mouse focused widget has already been done by
     // some child widget down somewhere and set state to BUBBLING_UP.
-    if(widget->mouse_enter_callback)
+    while(widget)
     {
-      widget->mouse_enter_callback(widget, internal_event->event);
-    }
-
-    // return if parent doesn't exist (root element)
-    if(!widget->parent)
-    {
-      return ok(result_bool, true);
+      if(widget->mouse_enter_callback)
+      {
+        widget->mouse_enter_callback(widget, internal_event->event);
+      }
+      widget = widget->parent;
     }
 
-    // still bubble up if parent exists
-    return common_internal_mouse_motion(widget->parent, internal_event);
+    return ok(result_bool, true);
   }
 
   // this widget is target
@@ -658,44 +1958,46 @@ common_internal_mouse_motion(base_widget* widget,
   return common_internal_mouse_motion(widget->parent, internal_event);
 }
 
-result_base_widget_ptr common_internal_mark_need_resizing(base_widget* widget,
-                                                          int16 delta_x,
-                                                          int16 delta_y)
+/// @brief Consumes deltas of a child's size by the remaining space of widget.
+/// @return `true` if widget takes up the deltas, its ancestors don't have
+///         to be resized, else `false` with the deltas left to its parent.
+static bool consume_sizing_deltas(base_widget* widget,
+                                  int32* delta_x_ptr,
+                                  int32* delta_y_ptr)
 {
   if(widget->type == FLEX_ITEM)
   {
     widget->need_resizing = false;
-    if(widget->parent)
-    {
-      return common_internal_mark_need_resizing(
-        widget->parent, delta_x, delta_y);
-    }
-    return ok(result_base_widget_ptr, widget);
+    return false;
   }
 
   if(!widget->flexbox_data.container.is_fluid)
   {
     // widget is not fluid, doesn't resize
     debug("Encountered non-fluid widget.");
-    return ok(result_base_widget_ptr, widget);
+    return true;
   }
 
+  int32 delta_x = *delta_x_ptr, delta_y = *delta_y_ptr;
+
   if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
   {
     // consume delta_x from main axis, delta_y from cross axis
-    uint16 main_axis_length = widget->w, cross_axis_length = widget->h;
-    uint16 needed_main_axis_length = 0, needed_cross_axis_length = 0;
+    uint32 main_axis_length = widget_w(widget),
+           cross_axis_length = widget_h(widget);
+    uint32 needed_main_axis_length = 0, needed_cross_axis_length = 0;
     base_widget_child_node* node = widget->children_head;
     while(node)
     {
       needed_main_axis_length +=
-        node->child->w + widget->flexbox_data.container.gap;
-      needed_cross_axis_length = max(needed_cross_axis_length, node->child->h);
+        widget_w(node->child) + widget->flexbox_data.container.gap;
+      needed_cross_axis_length =
+        max(needed_cross_axis_length, widget_h(node->child));
       node = node->next;
     }
     needed_main_axis_length -= widget->flexbox_data.container.gap;
-    int16 remaining_main_axis_length =
-      main_axis_length - needed_main_axis_length;
+    int32 remaining_main_axis_length =
+      (int32)(main_axis_length - needed_main_axis_length);
     if(remaining_main_axis_length > 0)
     {
       // main axis size needs to be decreased
@@ -723,8 +2025,8 @@ result_base_widget_ptr common_internal_mark_need_resizing(base_widget* widget,
         delta_x -= remaining_main_axis_length;
       }
     }
-    int16 remaining_cross_axis_length =
-      cross_axis_length - needed_cross_axis_length;
+    int32 remaining_cross_axis_length =
+      (int32)(cross_axis_length - needed_cross_axis_length);
     if(remaining_cross_axis_length > 0)
     {
       // main axis size needs to be decreased
@@ -756,19 +2058,21 @@ result_base_widget_ptr common_internal_mark_need_resizing(base_widget* widget,
   else
   {
     // consume delta_y from main axis, delta_x from cross axis
-    uint16 main_axis_length = widget->h, cross_axis_length = widget->w;
-    uint16 needed_main_axis_length = 0, needed_cross_axis_length = 0;
+    uint32 main_axis_length = widget_h(widget),
+           cross_axis_length = widget_w(widget);
+    uint32 needed_main_axis_length = 0, needed_cross_axis_length = 0;
     base_widget_child_node* node = widget->children_head;
     while(node)
     {
       needed_main_axis_length +=
-        node->child->h + widget->flexbox_data.container.gap;
-      needed_cross_axis_length = max(needed_cross_axis_length, node->child->w);
+        widget_h(node->child) + widget->flexbox_data.container.gap;
+      needed_cross_axis_length =
+        max(needed_cross_axis_length, widget_w(node->child));
       node = node->next;
     }
     needed_main_axis_length -= widget->flexbox_data.container.gap;
-    int16 remaining_main_axis_length =
-      main_axis_length - needed_main_axis_length;
+    int32 remaining_main_axis_length =
+      (int32)(main_axis_length - needed_main_axis_length);
     if(remaining_main_axis_length > 0)
     {
       // main axis should be shrinked
@@ -796,8 +2100,8 @@ result_base_widget_ptr common_internal_mark_need_resizing(base_widget* widget,
         delta_y -= remaining_main_axis_length;
       }
     }
-    int16 remaining_cross_axis_length =
-      cross_axis_length - needed_cross_axis_length;
+    int32 remaining_cross_axis_length =
+      (int32)(cross_axis_length - needed_cross_axis_length);
     if(remaining_cross_axis_length > 0)
     {
       // cross axis should be shrinked
@@ -830,14 +2134,20 @@ result_base_widget_ptr common_internal_mark_need_resizing(base_widget* widget,
     }
   }
 
-  if(delta_x == 0 && delta_y == 0)
-  {
-    return ok(result_base_widget_ptr, widget);
-  }
+  *delta_x_ptr = delta_x;
+  *delta_y_ptr = delta_y;
+
+  return delta_x == 0 && delta_y == 0;
+}
 
-  if(widget->parent)
+result_base_widget_ptr common_internal_mark_need_resizing(base_widget* widget,
+                                                          int32 delta_x,
+                                                          int32 delta_y)
+{
+  // walking up ancestors, until one of them takes up the deltas
+  while(widget->parent && !consume_sizing_deltas(widget, &delta_x, &delta_y))
   {
-    return common_internal_mark_need_resizing(widget->parent, delta_x, delta_y);
+    widget = widget->parent;
   }
 
   return ok(result_base_widget_ptr, widget);
@@ -856,30 +2166,27 @@ common_internal_mouse_button(base_widget* widget,
 
   if(internal_event->state == BUBBLING_UP)
   {
-    // call callbacks if present
-    if(internal_event->event.button_state == MOUSE_BUTTON_DOWN)
+    // call callbacks if present, on widget and all of its ancestors
+    while(widget)
     {
-      if(widget->mouse_button_down_callback)
+      if(internal_event->event.button_state == MOUSE_BUTTON_DOWN)
       {
-        widget->mouse_button_down_callback(widget, internal_event->event);
+        if(widget->mouse_button_down_callback)
+        {
+          widget->mouse_button_down_callback(widget, internal_event->event);
+        }
       }
-    }
-    else
-    {
-      if(widget->mouse_button_up_callback)
+      else
       {
-        widget->mouse_button_up_callback(widget, internal_event->event);
+        if(widget->mouse_button_up_callback)
+        {
+          widget->mouse_button_up_callback(widget, internal_event->event);
+        }
       }
+      widget = widget->parent;
     }
 
-    // return if parent doesn't exist (root element)
-    if(!widget->parent)
-    {
-      return ok(result_bool, true);
-    }
-
-    // still bubble up if parent exists
-    return common_internal_mouse_button(widget->parent, internal_event);
+    return ok(result_bool, true);
   }
 
   // this widget is target
@@ -948,202 +2255,117 @@ common_internal_mouse_scroll(base_widget* widget,
   return ok(result_bool, false);
 }
 
-result_void common_internal_relayout(const base_widget* widget)
+/// @brief Retains current size of widget, as the one its children are laid
+///        out with.
+static void layout_state_commit(base_widget* widget)
 {
-  trace("Widget(%s): w: %d, h: %d", widget->debug_name, widget->w, widget->h);
+  widget->layout.layout_dirty = false;
+  widget->layout.w = widget_w(widget);
+  widget->layout.h = widget_h(widget);
+}
 
-  if(!widget->visible)
-  {
-    // avoiding calculations when widget is not visible
-    return ok_void();
-  }
+/// @brief Sizes and positions children of container widget, within its
+///        size. Subtrees of children are not laid out.
+///        Children are looped over by their ids, so only their geometry in
+///        store of widget is touched, not the children themselves.
+static result_void layout_children(base_widget* widget)
+{
+  trace("Widget(%s): w: %d, h: %d",
+        widget->debug_name,
+        widget_w(widget),
+        widget_h(widget));
 
-  if(widget->type == FLEX_ITEM)
+  if(!common_internal_index_children(widget))
   {
-    return error(
-      result_void,
-      "Should not call internal relayout callback on FLEX_ITEM widget!");
+    return error(result_void,
+                 "Unable to allocate memory for index of children!");
   }
 
-  uint16 main_axis_length =
-    widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW ? widget->w
-                                                                   : widget->h;
-  uint16 cross_axis_length =
-    widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW ? widget->h
-                                                                   : widget->w;
+  geometry_store* store = widget->geometry;
+  const uint32* ids = widget->children_index;
+  uint32 children_count = widget->children_count;
+  uint8 gap = widget->flexbox_data.container.gap;
+
+  // sizes & positions of children along main-axis and cross-axis
+  bool row = widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW;
+  uint32* main_lengths = row ? store->w : store->h;
+  uint32* cross_lengths = row ? store->h : store->w;
+  int32* main_positions = row ? store->x : store->y;
+  int32* cross_positions = row ? store->y : store->x;
 
-  uint16 needed_main_axis_length = 0, needed_cross_axis_length = 0;
+  uint32 main_axis_length = row ? widget_w(widget) : widget_h(widget);
+  uint32 cross_axis_length = row ? widget_h(widget) : widget_w(widget);
+
+  uint32 needed_main_axis_length = 0, needed_cross_axis_length = 0;
   uint16 total_flex_grow = 0, total_flex_shrink = 0;
 
-  base_widget_child_node* node = widget->children_head;
-  while(node)
+  for(uint32 i = 0; i < children_count; i++)
   {
+    uint32 id = ids[i];
+
     // avoiding invisible children in layout tree
-    if(!node->child->visible)
+    if(!store->visible[id])
     {
-      node = node->next;
       continue;
     }
 
-    if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-    {
-      needed_main_axis_length += node->child->w;
-      needed_cross_axis_length = max(needed_cross_axis_length, node->child->h);
-    }
-    else
-    {
-      needed_main_axis_length += node->child->h;
-      needed_cross_axis_length = max(needed_cross_axis_length, node->child->w);
-    }
-    needed_main_axis_length += widget->flexbox_data.container.gap;
-    total_flex_grow += node->child->type == FLEX_CONTAINER
-                         ? node->child->flexbox_data.container.flex_grow
-                         : node->child->flexbox_data.item.flex_grow;
-    total_flex_shrink += node->child->type == FLEX_CONTAINER
-                           ? node->child->flexbox_data.container.flex_shrink
-                           : node->child->flexbox_data.item.flex_shrink;
-    node = node->next;
+    needed_main_axis_length += main_lengths[id] + gap;
+    needed_cross_axis_length =
+      max(needed_cross_axis_length, cross_lengths[id]);
+    total_flex_grow += store->flex_grow[id];
+    total_flex_shrink += store->flex_shrink[id];
   }
-  needed_main_axis_length -= widget->flexbox_data.container.gap;
+  needed_main_axis_length -= gap;
 
   debug("Needed main, cross axes lengths: %d, %d",
         needed_main_axis_length,
         needed_cross_axis_length);
 
   // adjusting sizing in main axis
-  int16 remaining_main_axis_length = main_axis_length - needed_main_axis_length;
+  int32 remaining_main_axis_length =
+    (int32)(main_axis_length - needed_main_axis_length);
   if(remaining_main_axis_length > 0 && total_flex_grow > 0)
   {
     // share remaining space according to flex-grow of each child.
-    node = widget->children_head;
-    while(node)
+    for(uint32 i = 0; i < children_count; i++)
     {
-      // avoiding invisible children in layout tree
-      if(!node->child->visible)
-      {
-        node = node->next;
-        continue;
-      }
-
-      if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-      {
-        node->child->w += ((node->child->type == FLEX_CONTAINER
-                              ? node->child->flexbox_data.container.flex_grow
-                              : node->child->flexbox_data.item.flex_grow) /
-                           total_flex_grow) *
-                          remaining_main_axis_length;
-      }
-      else
+      uint32 id = ids[i];
+      if(store->visible[id])
       {
-        node->child->h += ((node->child->type == FLEX_CONTAINER
-                              ? node->child->flexbox_data.container.flex_grow
-                              : node->child->flexbox_data.item.flex_grow) /
-                           total_flex_grow) *
-                          remaining_main_axis_length;
+        main_lengths[id] += (store->flex_grow[id] / total_flex_grow) *
+                            remaining_main_axis_length;
       }
-      node = node->next;
     }
   }
-  else if(remaining_main_axis_length < 0)
+  else if(remaining_main_axis_length < 0 && total_flex_shrink > 0)
   {
-    if(total_flex_shrink == 0)
-    {
-      // node = widget->children_head;
-      // while(node)
-      // {
-      //   if(node->child->type == FLEX_ITEM)
-      //   {
-      //     node = node->next;
-      //     continue;
-      //   }
-
-      //   if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-      //   {
-      //     node->child->w = widget->w;
-      //   }
-      //   else
-      //   {
-      //     node->child->h = widget->h;
-      //   }
-      //   node = node->next;
-      // }
-    }
-    else
+    // acquire needed space by shrinking children according
+    // to their flex-shrink
+    for(uint32 i = 0; i < children_count; i++)
     {
-      // acquire needed space by shrinking children according
-      // to their flex-shrink
-      node = widget->children_head;
-      while(node)
+      uint32 id = ids[i];
+      if(store->visible[id])
       {
-        // avoiding invisible children in layout tree
-        if(!node->child->visible)
-        {
-          node = node->next;
-          continue;
-        }
-
-        if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-        {
-          node->child->w +=
-            ((node->child->type == FLEX_CONTAINER
-                ? node->child->flexbox_data.container.flex_shrink
-                : node->child->flexbox_data.item.flex_shrink) /
-             total_flex_shrink) *
-            remaining_main_axis_length;
-        }
-        else
-        {
-          node->child->h +=
-            ((node->child->type == FLEX_CONTAINER
-                ? node->child->flexbox_data.container.flex_shrink
-                : node->child->flexbox_data.item.flex_shrink) /
-             total_flex_shrink) *
-            remaining_main_axis_length;
-        }
-        node = node->next;
+        main_lengths[id] += (store->flex_shrink[id] / total_flex_shrink) *
+                            remaining_main_axis_length;
       }
     }
   }
 
-  // adjusting sizing in cross axis
-  node = widget->children_head;
-  while(node)
+  // adjusting sizing in cross axis, expanding children to cross-axis length
+  for(uint32 i = 0; i < children_count; i++)
   {
-    // avoiding invisible children in layout tree
-    if(!node->child->visible)
-    {
-      node = node->next;
-      continue;
-    }
-
-    flex_cross_axis_sizing cross_axis_sizing =
-      node->child->type == FLEX_CONTAINER
-        ? node->child->flexbox_data.container.cross_axis_sizing
-        : node->child->flexbox_data.item.cross_axis_sizing;
-
-    if(cross_axis_sizing == CROSS_AXIS_SIZING_FIT_CONTENT)
-    {
-      node = node->next;
-      continue;
-    }
-
-    // expand child widget's width or height to cross-axis length
-    if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-    {
-      debug("Height expanded!");
-      node->child->h = cross_axis_length;
-    }
-    else
+    uint32 id = ids[i];
+    if(store->visible[id] &&
+       store->cross_axis_sizing[id] == CROSS_AXIS_SIZING_EXPAND)
     {
-      debug("Width expanded!");
-      node->child->w = cross_axis_length;
+      debug("%s expanded!", row ? "Height" : "Width");
+      cross_lengths[id] = cross_axis_length;
     }
-
-    node = node->next;
   }
 
-  // assigning positions
-  int16 x = widget->x, y = widget->y;
+  // assigning positions, relative to widget
+  int32 main_position = 0;
 
   // justify-content flex-align
   switch(widget->flexbox_data.container.justify_content)
@@ -1153,25 +2375,11 @@ result_void common_internal_relayout(const base_widget* widget)
     break;
   }
   case JUSTIFY_CONTENT_CENTER: {
-    if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-    {
-      x += remaining_main_axis_length / 2;
-    }
-    else
-    {
-      y += remaining_main_axis_length / 2;
-    }
+    main_position += remaining_main_axis_length / 2;
     break;
   }
   case JUSTIFY_CONTENT_END: {
-    if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-    {
-      x += remaining_main_axis_length;
-    }
-    else
-    {
-      y += remaining_main_axis_length;
-    }
+    main_position += remaining_main_axis_length;
     break;
   }
   case JUSTIFY_CONTENT_SPACE_BETWEEN: {
@@ -1187,113 +2395,268 @@ result_void common_internal_relayout(const base_widget* widget)
     break;
   }
 
-  node = widget->children_head;
-  while(node)
+  for(uint32 i = 0; i < children_count; i++)
   {
+    uint32 id = ids[i];
+
     // avoiding invisible children in layout tree
-    if(!node->child->visible)
+    if(!store->visible[id])
     {
-      node = node->next;
       continue;
     }
 
-    debug("assigning positions x, y: %d, %d", x, y);
-    if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-    {
-      node->child->x = x;
-    }
-    else
-    {
-      node->child->y = y;
-    }
+    debug("assigning position along main axis: %d", main_position);
+    main_positions[id] = main_position;
 
     // flex-align in cross-axis
+    int32 remaining_space = (int32)cross_axis_length - (int32)cross_lengths[id];
     switch(widget->flexbox_data.container.align_items)
     {
     case ALIGN_ITEMS_START: {
-      if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-      {
-        node->child->y = y;
-      }
-      else
-      {
-        node->child->x = x;
-      }
+      cross_positions[id] = 0;
       break;
     }
     case ALIGN_ITEMS_CENTER: {
-      if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-      {
-        uint16 remaining_space = cross_axis_length - node->child->h;
-        node->child->y = y + (remaining_space / 2);
-      }
-      else
-      {
-        uint16 remaining_space = cross_axis_length - node->child->w;
-        node->child->x = x + (remaining_space / 2);
-      }
+      cross_positions[id] = remaining_space / 2;
       break;
     }
     case ALIGN_ITEMS_END: {
-      if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-      {
-        uint16 remaining_space = cross_axis_length - node->child->h;
-        node->child->y = y + remaining_space;
-      }
-      else
-      {
-        uint16 remaining_space = cross_axis_length - node->child->w;
-        node->child->x = x + remaining_space;
-      }
+      cross_positions[id] = remaining_space;
       break;
     }
     default:
       break;
     }
 
-    if(widget->flexbox_data.container.direction == FLEX_DIRECTION_ROW)
-    {
-      x += node->child->w + widget->flexbox_data.container.gap;
-    }
-    else
+    main_position += main_lengths[id] + gap;
+  }
+
+  return ok_void();
+}
+
+/// @brief Compares child with the size its subtree was laid out with, and
+///        commits child if its children don't have to be laid out again.
+///        Subtree of a child which only moved is left as it is, as positions
+///        are relative to parent.
+/// @return `true` if child is a container whose children have to be laid
+///         out again.
+static bool child_needs_relayout(base_widget* child)
+{
+  if(widget_w(child) != child->layout.w || widget_h(child) != child->layout.h)
+  {
+    child->layout.layout_dirty = true;
+  }
+
+  if(child->type == FLEX_CONTAINER && child->layout.layout_dirty)
+  {
+    return true;
+  }
+
+  layout_state_commit(child);
+
+  return false;
+}
+
+static result_void relayout_subtree(base_widget* widget,
+                                    uint32 generation,
+                                    traversal_stack* stack);
+
+/// @brief Thread pool task, re-layouting the container child passed as data.
+///        Subtrees of siblings don't share any widgets, and text is not
+///        measured while re-layouting, so siblings can be laid out in
+///        parallel.
+static void relayout_child_task(void* data)
+{
+  base_widget* child = (base_widget*)data;
+
+  // scratch stack of context belongs to its thread
+  traversal_stack stack = {0};
+  if(child->pre_internal_relayout_hook)
+  {
+    child->pre_internal_relayout_hook(child);
+  }
+  relayout_subtree(child, child->context->layout_generation, &stack);
+  if(child->post_internal_relayout_hook)
+  {
+    child->post_internal_relayout_hook(child);
+  }
+  free(stack.frames);
+}
+
+/// @brief Submits re-layout of large child to thread pool, into group of
+///        children of frame.
+/// @return `true` if submitted, else child is to be laid out by caller.
+static bool submit_parallel_relayout(traversal_frame* frame,
+                                     thread_pool* layout_pool,
+                                     base_widget* child)
+{
+  if(!layout_pool ||
+     child->descendants_count < PARALLEL_LAYOUT_MIN_DESCENDANTS)
+  {
+    return false;
+  }
+
+  // group lives outside of stack, as frames move when stack grows
+  if(!frame->parallel_children)
+  {
+    frame->parallel_children =
+      (thread_pool_group*)calloc(1, sizeof(thread_pool_group));
+    if(!frame->parallel_children)
     {
-      y += node->child->h + widget->flexbox_data.container.gap;
+      return false;
     }
-    node = node->next;
   }
 
-  // calling re-layout on children which are container widgets
-  node = widget->children_head;
-  while(node)
+  return thread_pool_submit(
+           layout_pool, frame->parallel_children, relayout_child_task, child)
+    .ok;
+}
+
+/// @brief Waits for children of frame being laid out on thread pool.
+static void wait_parallel_relayouts(traversal_frame* frame,
+                                    thread_pool* layout_pool)
+{
+  if(frame->parallel_children)
   {
-    // avoiding invisible children in layout tree
-    if(!node->child->visible)
+    thread_pool_wait(layout_pool, frame->parallel_children);
+    free(frame->parallel_children);
+    frame->parallel_children = NULL;
+  }
+}
+
+/// @brief Lays out children of widget, then descends into container children
+///        which have to be laid out again, using stack above its current
+///        frames. Relayout hooks of descendants are called around laying
+///        them out, but not of widget itself.
+static result_void relayout_subtree(base_widget* widget,
+                                    uint32 generation,
+                                    traversal_stack* stack)
+{
+  thread_pool* layout_pool =
+    widget->context ? widget->context->layout_pool : NULL;
+  uint32 base = stack->count;
+
+  result_void _ = layout_children(widget);
+  if(!_.ok)
+  {
+    return _;
+  }
+
+  _ = traversal_stack_push(stack, widget);
+  while(_.ok && stack->count > base)
+  {
+    traversal_frame* frame = &stack->frames[stack->count - 1];
+
+    // finding next child to descend into, large subtrees are laid out
+    // on thread pool, if there is one
+    base_widget* descend_child = NULL;
+    base_widget_child_node* node = frame->node;
+    while(node && !descend_child)
     {
+      base_widget* child = node->child;
       node = node->next;
-      continue;
+
+      // avoiding invisible children in layout tree
+      if(widget_visible(child) && child_needs_relayout(child) &&
+         !submit_parallel_relayout(frame, layout_pool, child))
+      {
+        descend_child = child;
+      }
     }
+    frame->node = node;
 
-    if(node->child->type == FLEX_CONTAINER)
+    if(descend_child)
     {
-      if(node->child->pre_internal_relayout_hook)
+      if(descend_child->pre_internal_relayout_hook)
+      {
+        descend_child->pre_internal_relayout_hook(descend_child);
+      }
+      result_void __ = layout_children(descend_child);
+      if(__.ok)
       {
-        node->child->pre_internal_relayout_hook(node->child);
+        _ = traversal_stack_push(stack, descend_child);
       }
-      common_internal_relayout(node->child);
-      if(node->child->post_internal_relayout_hook)
+      else if(descend_child->post_internal_relayout_hook)
       {
-        node->child->post_internal_relayout_hook(node->child);
+        // child is left dirty, siblings are still laid out
+        descend_child->post_internal_relayout_hook(descend_child);
       }
+      continue;
+    }
+
+    // all children are laid out
+    wait_parallel_relayouts(frame, layout_pool);
+    base_widget* laid_out = frame->widget;
+    stack->count--;
+
+    layout_state_commit(laid_out);
+    laid_out->layout.layout_generation = generation;
+
+    if(stack->count > base && laid_out->post_internal_relayout_hook)
+    {
+      laid_out->post_internal_relayout_hook(laid_out);
     }
-    node = node->next;
   }
 
-  return ok_void();
+  // on error, not waiting for tasks of remaining frames would leave them
+  // running on widgets
+  while(stack->count > base)
+  {
+    wait_parallel_relayouts(&stack->frames[--stack->count], layout_pool);
+  }
+
+  return _;
+}
+
+result_void common_internal_relayout(base_widget* widget)
+{
+  if(!widget_visible(widget))
+  {
+    // avoiding calculations when widget is not visible
+    return ok_void();
+  }
+
+  if(widget->type == FLEX_ITEM)
+  {
+    return error(
+      result_void,
+      "Should not call internal relayout callback on FLEX_ITEM widget!");
+  }
+
+  internal_context* context = widget->context;
+  uint32 generation = 0;
+  traversal_stack local_stack = {0};
+  traversal_stack* stack = &local_stack;
+  bool parallel = false;
+  if(context)
+  {
+    generation = ++context->layout_generation;
+    stack = &context->traversal_stack;
+
+    parallel = context->layout_pool && !context->parallel_relayout;
+    if(parallel)
+    {
+      context->parallel_relayout = true;
+    }
+  }
+
+  result_void _ = relayout_subtree(widget, generation, stack);
+  free(local_stack.frames);
+
+  if(parallel)
+  {
+    context->parallel_relayout = false;
+  }
+
+  // children have moved
+  invalidate_absolute_positions(widget);
+
+  return _;
 }
 
 result_bool common_internal_adjust_layout(base_widget* widget)
 {
-  if(!widget->visible)
+  while(!widget_visible(widget))
   {
     // escalate this call to its parent
     if(!widget->parent)
@@ -1303,7 +2666,7 @@ result_bool common_internal_adjust_layout(base_widget* widget)
       return ok(result_bool, true);
     }
 
-    return common_internal_adjust_layout(widget->parent);
+    widget = widget->parent;
   }
 
   if(!widget->internal_fit_layout_callback)
@@ -1311,45 +2674,102 @@ result_bool common_internal_adjust_layout(base_widget* widget)
     return ok(result_bool, false);
   }
 
+  internal_context* context = widget->context;
+  if(context && context->deferred_updates && !context->updating)
+  {
+    result_void _ =
+      internal_context_queue_update(context, widget, PENDING_UPDATE_LAYOUT);
+    if(!_.ok)
+    {
+      return error(result_bool, _.error);
+    }
+
+    return ok(result_bool, true);
+  }
+
+  result_base_widget_ptr _ = common_internal_fit_to_content(widget);
+  if(!_.ok)
+  {
+    return error(result_bool, _.error);
+  }
+
+  // widget is laid out again even if its size didn't change, as its
+  // children (or) their arrangement may have changed
+  base_widget* subtree = _.value ? _.value : widget;
+
+  result_void __ = common_internal_update_layout(subtree);
+  if(!__.ok)
+  {
+    return error(result_bool, __.error);
+  }
+
+  common_internal_render(subtree);
+
+  return ok(result_bool, true);
+}
+
+result_base_widget_ptr common_internal_fit_to_content(base_widget* widget)
+{
+  if(!widget->internal_fit_layout_callback)
+  {
+    return ok(result_base_widget_ptr, NULL);
+  }
+
   // call fit layout on this widget, that should return the delta_x, delta_y
   // using these deltas, mark need resizing from this widget, that should
   // return the lowest ancestor which satisfies these deltas
-  // now call calculate sizing on this ancestor
-  // then call relayout on this ancestor
-  // then call internal render on this ancestor.
   result_sizing_delta _ = widget->internal_fit_layout_callback(widget, false);
   if(!_.ok)
   {
-    return error(result_bool, _.error);
+    return error(result_base_widget_ptr, _.error);
   }
 
   if(_.value.x == 0 && _.value.y == 0)
   {
     // deltas are 0
-    return ok(result_bool, true);
+    return ok(result_base_widget_ptr, NULL);
   }
 
+  // marking ancestors too, so re-layouting the ancestor which takes up the
+  // deltas reaches the parent of widget
+  common_internal_mark_layout_dirty(widget);
+
   result_base_widget_ptr __ =
     common_internal_mark_need_resizing(widget, _.value.x, _.value.y);
   if(!__.ok)
   {
-    return error(result_bool, __.error);
+    return __;
   }
 
-  base_widget* ancestor = __.value;
-  debug("Ancestor parent: %s", ancestor->parent ? "EXISTS" : "(NULL)");
-  // ancestor->internal_calculate_size(ancestor);
-  common_internal_calculate_size(ancestor);
-  if(ancestor->pre_internal_relayout_hook)
+  debug("Ancestor parent: %s", __.value->parent ? "EXISTS" : "(NULL)");
+
+  return __;
+}
+
+result_void common_internal_update_layout(base_widget* widget)
+{
+  // calculate sizing on this widget, then relayout it
+  result_void _ = common_internal_calculate_size(widget);
+  if(!_.ok || widget->type == FLEX_ITEM)
   {
-    ancestor->pre_internal_relayout_hook(ancestor);
+    return _;
   }
-  common_internal_relayout(ancestor);
-  ancestor->internal_render_callback(ancestor);
-  if(ancestor->post_internal_relayout_hook)
+
+  if(widget->pre_internal_relayout_hook)
   {
-    ancestor->post_internal_relayout_hook(ancestor);
+    widget->pre_internal_relayout_hook(widget);
   }
 
-  return ok(result_bool, true);
+  _ = common_internal_relayout(widget);
+  if(!_.ok)
+  {
+    return _;
+  }
+
+  if(widget->post_internal_relayout_hook)
+  {
+    widget->post_internal_relayout_hook(widget);
+  }
+
+  return ok_void();
 }
@@ -3,28 +3,213 @@
 #include <string.h>
 #include "../include/macros.h"
 
-/// Command node for linked list of command buffer.
-struct command_node
+/// Number of commands in a segment of command buffer, power of two.
+#define COMMAND_SEGMENT_SHIFT 10
+#define COMMAND_SEGMENT_CAPACITY (1u << COMMAND_SEGMENT_SHIFT)
+#define COMMAND_SEGMENT_MASK (COMMAND_SEGMENT_CAPACITY - 1)
+
+/// Initial number of clip rects the clip stack of command buffer can hold.
+#define CLIP_STACK_INITIAL_CAPACITY 16
+
+/// Minimum size of a chunk in arena of command buffer.
+#define ARENA_CHUNK_SIZE 4096
+
+/// Chunk of arena, holding texts and rects of commands.
+/// Chunks are never reallocated, so data stored in them keep their
+/// addresses until the arena is reset.
+typedef struct arena_chunk
 {
-  command* cmd;
+  struct arena_chunk* next;
 
-  struct command_node* next;
-};
+  uint32 capacity;
+  uint32 used;
+
+  char data[];
+} arena_chunk;
+
+/// Maximum number of opaque rects tracked while culling occluded commands.
+#define OCCLUDERS_MAX 64
+
+/// Per command data used by occlusion culling pass.
+typedef struct cull_entry
+{
+  /// Intersection of all clip rects active for the command.
+  rect clip;
+
+  /// Whether the command is culled.
+  bool culled;
+} cull_entry;
+
+/// Maximum number of draw commands tracked while batching commands.
+/// Reaching this limit acts like a barrier, nothing is moved across it.
+#define BATCH_WINDOW_MAX 64
+
+/// Marks end of list of batched commands.
+#define BATCH_NONE UINT32_MAX
+
+/// Role of a command in batching pass.
+typedef enum batch_role
+{
+  /// Command is kept as it is.
+  BATCH_KEEP,
+
+  /// Command leads a group of `RENDER_RECT` commands of same color.
+  BATCH_LEADER,
+
+  /// Command is merged into its group leader.
+  BATCH_MEMBER,
+
+  /// Command is redundant, and is dropped.
+  BATCH_DROP
+} batch_role;
+
+/// Per command data used by batching pass.
+typedef struct batch_entry
+{
+  batch_role role;
+
+  /// Next command in the group, `BATCH_NONE` if this is the last one.
+  uint32 next;
+
+  /// For group leaders: last command in the group, and size of group.
+  uint32 last;
+  uint16 count;
+
+  /// For group leaders: rects of the group, allocated in arena.
+  rect* rects;
+} batch_entry;
+
+/// Draw command seen by batching pass, in current ordering-safe region.
+typedef struct batch_draw
+{
+  /// Area the command may paint.
+  rect bounds;
+
+  /// Index of the command.
+  uint32 index;
+
+  /// Index of group leader, `BATCH_NONE` if command is not a `RENDER_RECT`.
+  uint32 leader;
+} batch_draw;
 
 /// Buffer for holding all commands produced by widgets.
+/// Commands are stored inline in fixed size segments, which are allocated
+/// as needed and retained between frames, so storage grows without
+/// reallocating (or) copying commands. Texts of `RENDER_TEXT` commands,
+/// rects of `RENDER_RECTS` commands and glyphs of `RENDER_GLYPH_RUN`
+/// commands are bump-allocated in an arena owned by the buffer.
 /// This is cleaned up for every frame.
 struct command_buffer
 {
-  command_node* head;
-  command_node* tail;
+  /// Segments of `COMMAND_SEGMENT_CAPACITY` commands each.
+  command** segments;
+  uint32 segments_count;
+  uint32 segments_capacity;
+
+  uint32 length;
+
+  /// First chunk of arena.
+  arena_chunk* arena_chunks;
+
+  /// Chunk in which data is being allocated.
+  arena_chunk* current_arena_chunk;
 
-  uint16 length;
+  /// Clip rects pushed so far, each one is the intersection of all clip
+  /// rects pushed before it. Storage is retained between frames.
+  rect* clip_stack;
+  uint16 clip_depth;
+  uint16 clip_capacity;
+
+  /// Scratch memory for culling & batching passes, retained between frames.
+  cull_entry* cull_entries;
+  batch_entry* batch_entries;
+  uint32 scratch_capacity;
 };
 
-struct command_buffer_const_iterator_private_data
+/// Gives command at `index` in command buffer.
+static inline command* command_buffer_at(const command_buffer* buffer,
+                                         uint32 index)
 {
-  command_node* node;
-};
+  return &buffer->segments[index >> COMMAND_SEGMENT_SHIFT]
+                          [index & COMMAND_SEGMENT_MASK];
+}
+
+/// Rect which doesn't clip anything.
+static const rect unbounded_rect = {
+  .x = INT16_MIN, .y = INT16_MIN, .w = UINT16_MAX, .h = UINT16_MAX};
+
+/// Intersection of two rects, gives empty rect if they don't intersect.
+static rect rect_intersect(rect a, rect b)
+{
+  int32 x1 = max((int32)a.x, (int32)b.x);
+  int32 y1 = max((int32)a.y, (int32)b.y);
+  int32 x2 = min((int32)a.x + a.w, (int32)b.x + b.w);
+  int32 y2 = min((int32)a.y + a.h, (int32)b.y + b.h);
+
+  if(x2 <= x1 || y2 <= y1)
+  {
+    return (rect){.x = 0, .y = 0, .w = 0, .h = 0};
+  }
+
+  return (rect){.x = (int16)x1,
+                .y = (int16)y1,
+                .w = (uint16)min(x2 - x1, UINT16_MAX),
+                .h = (uint16)min(y2 - y1, UINT16_MAX)};
+}
+
+/// Tells if `outer` rect fully contains `inner` rect.
+static bool rect_contains(rect outer, rect inner)
+{
+  return (int32)outer.x <= (int32)inner.x &&
+         (int32)outer.y <= (int32)inner.y &&
+         (int32)inner.x + inner.w <= (int32)outer.x + outer.w &&
+         (int32)inner.y + inner.h <= (int32)outer.y + outer.h;
+}
+
+/// Grows rect by one pixel on every side.
+static rect rect_grow(rect r)
+{
+  int32 x1 = max((int32)r.x - 1, INT16_MIN);
+  int32 y1 = max((int32)r.y - 1, INT16_MIN);
+  int32 x2 = min((int32)r.x + r.w + 1, (int32)INT16_MIN + UINT16_MAX);
+  int32 y2 = min((int32)r.y + r.h + 1, (int32)INT16_MIN + UINT16_MAX);
+
+  return (rect){.x = (int16)x1,
+                .y = (int16)y1,
+                .w = (uint16)(x2 - x1),
+                .h = (uint16)(y2 - y1)};
+}
+
+/// Gives bounding rect of the area a command paints.
+/// Returns `false` if the area is not known, or command doesn't paint.
+static bool command_painted_rect(const command* cmd, rect* bounds)
+{
+  switch(cmd->type)
+  {
+  case RENDER_RECT:
+  case RENDER_RECT_OUTLINED: {
+    *bounds = cmd->data.render_rect.bounding_rect;
+    return true;
+  }
+  case RENDER_ROUNDED_RECT: {
+    *bounds = cmd->data.render_rounded_rect.bounding_rect;
+    return true;
+  }
+  case RENDER_LINE: {
+    point begin = cmd->data.render_line.begin;
+    point end = cmd->data.render_line.end;
+    *bounds = (rect){.x = min(begin.x, end.x),
+                     .y = min(begin.y, end.y),
+                     .w = (uint16)(abs(end.x - begin.x) + 1),
+                     .h = (uint16)(abs(end.y - begin.y) + 1)};
+    return true;
+  }
+  default:
+    // text extents are not always known, so texts are neither culled nor
+    // moved, clip, cursor & clear commands change backend state
+    return false;
+  }
+}
 
 result_command_ptr command_new_render_rect(const rect bounding_rect,
                                            const color rect_color)
@@ -93,8 +278,10 @@ result_command_ptr command_new_render_line(point begin, point end)
 }
 
 result_command_ptr command_new_render_text(const char* text,
+                                           font_handle font,
                                            const color text_color,
-                                           point text_coordinates)
+                                           point text_coordinates,
+                                           text_dimensions dimensions)
 {
   if(!text)
   {
@@ -112,8 +299,11 @@ result_command_ptr command_new_render_text(const char* text,
   cmd->type = RENDER_TEXT;
   cmd->data.render_text =
     (render_text_data){.text = strdup(text),
+                       .text_length = (uint16)strlen(text),
+                       .font = font,
                        .text_color = text_color,
-                       .text_coordinates = text_coordinates};
+                       .text_coordinates = text_coordinates,
+                       .dimensions = dimensions};
 
   return ok(result_command_ptr, cmd);
 }
@@ -141,6 +331,7 @@ result_command_ptr command_new_pop_clip_rect()
   }
 
   cmd->type = POP_CLIP_RECT;
+  cmd->data.clip_rect = unbounded_rect;
 
   return ok(result_command_ptr, cmd);
 }
@@ -178,65 +369,313 @@ result_void command_free(command* cmd)
     return error(result_void, "Attempt to free a NULL pointed command!");
   }
 
+  if(cmd->type == RENDER_TEXT)
+  {
+    free((char*)cmd->data.render_text.text);
+  }
+
   free(cmd);
 
   return ok_void();
 }
 
-typedef struct result_command_node_ptr
+/// FNV-1a hashing of bytes.
+static uint64 hash_bytes(uint64 hash, const void* bytes, size_t size)
 {
-  bool ok;
-  union
+  const uint8* data = (const uint8*)bytes;
+  for(size_t i = 0; i < size; i++)
   {
-    command_node* value;
-    const char* error;
-  };
-} result_command_node_ptr;
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+
+static uint64 hash_rect(uint64 hash, rect r)
+{
+  int16 fields[4] = {r.x, r.y, (int16)r.w, (int16)r.h};
+  return hash_bytes(hash, fields, sizeof(fields));
+}
+
+static uint64 hash_color(uint64 hash, color c)
+{
+  uint8 fields[4] = {c.r, c.g, c.b, c.a};
+  return hash_bytes(hash, fields, sizeof(fields));
+}
+
+uint64 command_hash(const command* cmd, uint64 hash)
+{
+  // hashing fields one by one, as padding bytes of command are undefined
+  uint8 type = (uint8)cmd->type;
+  hash = hash_bytes(hash, &type, 1);
+
+  switch(cmd->type)
+  {
+  case RENDER_LINE: {
+    const render_line_data* data = &cmd->data.render_line;
+    int16 fields[4] = {data->begin.x, data->begin.y, data->end.x, data->end.y};
+    return hash_bytes(hash, fields, sizeof(fields));
+  }
+  case RENDER_TEXT: {
+    const render_text_data* data = &cmd->data.render_text;
+    int16 fields[2] = {data->text_coordinates.x, data->text_coordinates.y};
+    hash = hash_bytes(hash, fields, sizeof(fields));
+    hash = hash_bytes(hash, &data->font, sizeof(data->font));
+    hash = hash_color(hash, data->text_color);
+    return hash_bytes(hash, data->text, data->text_length);
+  }
+  case RENDER_GLYPH_RUN: {
+    const render_glyph_run_data* data = &cmd->data.render_glyph_run;
+    int16 fields[2] = {data->text_coordinates.x, data->text_coordinates.y};
+    hash = hash_bytes(hash, fields, sizeof(fields));
+    hash = hash_bytes(hash, &data->font, sizeof(data->font));
+    hash = hash_color(hash, data->text_color);
+    // glyphs have no padding bytes
+    return hash_bytes(
+      hash, data->glyphs, data->glyphs_count * sizeof(positioned_glyph));
+  }
+  case RENDER_RECT:
+  case RENDER_RECT_OUTLINED: {
+    hash = hash_rect(hash, cmd->data.render_rect.bounding_rect);
+    return hash_color(hash, cmd->data.render_rect.rect_color);
+  }
+  case RENDER_ROUNDED_RECT: {
+    const render_rounded_rect_data* data = &cmd->data.render_rounded_rect;
+    hash = hash_rect(hash, data->bounding_rect);
+    hash = hash_bytes(hash, &data->border_radius, 1);
+    return hash_color(hash, data->rect_color);
+  }
+  case RENDER_RECTS: {
+    const render_rects_data* data = &cmd->data.render_rects;
+    for(uint16 i = 0; i < data->rects_count; i++)
+    {
+      hash = hash_rect(hash, data->rects[i]);
+    }
+    return hash_color(hash, data->rects_color);
+  }
+  case PUSH_CLIP_RECT:
+  case POP_CLIP_RECT: {
+    return hash_rect(hash, cmd->data.clip_rect);
+  }
+  default:
+    return hash;
+  }
+}
 
-result_command_node_ptr command_node_new(command* cmd)
+bool command_text_rect(const command* cmd, rect* bounds)
 {
-  command_node* cmd_node = (command_node*)calloc(1, sizeof(command_node));
-  if(!cmd_node)
+  point coordinates;
+  text_dimensions dimensions;
+  if(cmd->type == RENDER_TEXT)
+  {
+    coordinates = cmd->data.render_text.text_coordinates;
+    dimensions = cmd->data.render_text.dimensions;
+  }
+  else if(cmd->type == RENDER_GLYPH_RUN)
+  {
+    coordinates = cmd->data.render_glyph_run.text_coordinates;
+    dimensions = cmd->data.render_glyph_run.dimensions;
+  }
+  else
   {
-    return error(result_command_node_ptr,
-                 "Unable to allocate memory for command node!");
+    return false;
   }
 
-  cmd_node->cmd = cmd;
-  cmd_node->next = NULL;
+  if(!dimensions.w && !dimensions.h)
+  {
+    return false;
+  }
+
+  *bounds = (rect){.x = coordinates.x,
+                   .y = coordinates.y,
+                   .w = dimensions.w,
+                   .h = dimensions.h};
 
-  return ok(result_command_node_ptr, cmd_node);
+  return true;
 }
 
-result_void command_node_free(command_node* node)
+/// Allocates one more segment for command buffer.
+static result_void command_buffer_add_segment(command_buffer* buffer)
 {
-  if(!node)
+  if(buffer->segments_count == buffer->segments_capacity)
   {
-    return error(result_void, "Attempt to free a NULL pointing command node!");
+    uint32 new_capacity =
+      buffer->segments_capacity ? buffer->segments_capacity * 2 : 8;
+    command** segments =
+      (command**)realloc(buffer->segments, new_capacity * sizeof(command*));
+    if(!segments)
+    {
+      return error(result_void,
+                   "Unable to grow memory for segments of command buffer!");
+    }
+
+    buffer->segments = segments;
+    buffer->segments_capacity = new_capacity;
   }
 
-  result_void _ = command_free(node->cmd);
-  if(!_.ok)
+  command* segment =
+    (command*)malloc(COMMAND_SEGMENT_CAPACITY * sizeof(command));
+  if(!segment)
   {
-    return _;
+    return error(result_void,
+                 "Unable to allocate memory for commands of command buffer!");
   }
 
-  free(node);
+  buffer->segments[buffer->segments_count++] = segment;
 
   return ok_void();
 }
 
-result_void command_node_shallow_free(command_node* node)
+/// Gives pointer to a new command slot at the end of command buffer,
+/// adding a segment to command buffer if it's full.
+static result_command_ptr command_buffer_push(command_buffer* buffer)
 {
-  if(!node)
+  if(buffer->length == UINT32_MAX)
   {
-    return error(result_void,
-                 "Attempt to shallow-free a NULL pointing command node!");
+    return error(result_command_ptr,
+                 "Command buffer is full, cannot add more commands!");
+  }
+
+  if(buffer->length == buffer->segments_count * COMMAND_SEGMENT_CAPACITY)
+  {
+    result_void _ = command_buffer_add_segment(buffer);
+    if(!_.ok)
+    {
+      return error(result_command_ptr, _.error);
+    }
   }
 
-  free(node);
+  command* cmd = command_buffer_at(buffer, buffer->length);
+  buffer->length += 1;
 
-  return ok_void();
+  return ok(result_command_ptr, cmd);
+}
+
+static arena_chunk* arena_chunk_new(uint32 capacity)
+{
+  arena_chunk* chunk =
+    (arena_chunk*)malloc(sizeof(arena_chunk) + capacity);
+  if(!chunk)
+  {
+    return NULL;
+  }
+
+  chunk->next = NULL;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+
+  return chunk;
+}
+
+/// Allocates memory from arena of command buffer.
+/// Returns `NULL` if unable to allocate memory.
+static void*
+command_buffer_arena_alloc(command_buffer* buffer, size_t size, size_t align)
+{
+  arena_chunk* chunk = buffer->current_arena_chunk;
+  uint32 offset = (uint32)((chunk->used + align - 1) & ~(align - 1));
+  if(offset > chunk->capacity || chunk->capacity - offset < size)
+  {
+    // moving to next chunk, which is reused from previous frames
+    if(chunk->next && chunk->next->capacity >= size)
+    {
+      chunk = chunk->next;
+    }
+    else
+    {
+      arena_chunk* new_chunk =
+        arena_chunk_new(max((uint32)size, ARENA_CHUNK_SIZE));
+      if(!new_chunk)
+      {
+        return NULL;
+      }
+      new_chunk->next = chunk->next;
+      chunk->next = new_chunk;
+      chunk = new_chunk;
+    }
+    chunk->used = 0;
+    offset = 0;
+    buffer->current_arena_chunk = chunk;
+  }
+
+  chunk->used = offset + (uint32)size;
+
+  return chunk->data + offset;
+}
+
+/// Copies the text into arena of command buffer.
+/// Returns pointer to the copied null-terminated text, `NULL` if unable to
+/// allocate memory.
+static const char*
+command_buffer_copy_text(command_buffer* buffer, const char* text, size_t length)
+{
+  char* copy = (char*)command_buffer_arena_alloc(buffer, length + 1, 1);
+  if(!copy)
+  {
+    return NULL;
+  }
+
+  memcpy(copy, text, length);
+  copy[length] = '\0';
+
+  return copy;
+}
+
+/// Gives the clip rect active for commands being added into command buffer.
+static rect command_buffer_current_clip(const command_buffer* buffer)
+{
+  return buffer->clip_depth ? buffer->clip_stack[buffer->clip_depth - 1]
+                            : unbounded_rect;
+}
+
+/// Tells if command paints nothing within the clip rect active in command
+/// buffer. Such commands are not added into command buffer.
+static bool command_buffer_is_clipped_out(const command_buffer* buffer,
+                                          const command* cmd)
+{
+  rect clip = command_buffer_current_clip(buffer);
+  if(!clip.w || !clip.h)
+  {
+    return true;
+  }
+
+  rect bounds;
+  if(command_text_rect(cmd, &bounds))
+  {
+    return !rect_intersect(bounds, clip).w;
+  }
+
+  if(cmd->type == RENDER_TEXT || cmd->type == RENDER_GLYPH_RUN)
+  {
+    // text of unknown dimensions extends right & down from its coordinates
+    point coordinates = cmd->type == RENDER_TEXT
+                          ? cmd->data.render_text.text_coordinates
+                          : cmd->data.render_glyph_run.text_coordinates;
+    return (int32)coordinates.x >= (int32)clip.x + clip.w ||
+           (int32)coordinates.y >= (int32)clip.y + clip.h;
+  }
+
+  if(cmd->type == RENDER_RECTS)
+  {
+    const render_rects_data* data = &cmd->data.render_rects;
+    for(uint16 i = 0; i < data->rects_count; i++)
+    {
+      if(rect_intersect(data->rects[i], clip).w)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if(!command_painted_rect(cmd, &bounds))
+  {
+    return false;
+  }
+
+  // strokes of outlines & lines may spill a pixel around their bounds
+  return !rect_intersect(rect_grow(bounds), clip).w;
 }
 
 result_command_buffer_ptr command_buffer_new()
@@ -248,24 +687,39 @@ result_command_buffer_ptr command_buffer_new()
                  "Unable to allocate memory for command buffer!");
   }
 
-  buffer->head = NULL;
-  buffer->tail = NULL;
-  buffer->length = 0;
+  result_void _ = command_buffer_add_segment(buffer);
+  if(!_.ok)
+  {
+    free(buffer);
+    return error(result_command_buffer_ptr, _.error);
+  }
+
+  buffer->arena_chunks = arena_chunk_new(ARENA_CHUNK_SIZE);
+  if(!buffer->arena_chunks)
+  {
+    free(buffer->segments[0]);
+    free(buffer->segments);
+    free(buffer);
+    return error(result_command_buffer_ptr,
+                 "Unable to allocate memory for texts of command buffer!");
+  }
+  buffer->current_arena_chunk = buffer->arena_chunks;
 
   return ok(result_command_buffer_ptr, buffer);
 }
 
-int16 command_buffer_length(const command_buffer* buffer)
+uint32 command_buffer_length(const command_buffer* buffer)
 {
   if(!buffer)
   {
-    return -1;
+    return 0;
   }
 
   return buffer->length;
 }
 
-result_void command_buffer_add_command(command_buffer* buffer, command* cmd)
+result_void command_buffer_add_command(command_buffer* buffer,
+                                       const command* cmd)
 {
   if(!buffer)
   {
@@ -279,26 +733,74 @@ result_void command_buffer_add_command(command_buffer* buffer, command* cmd)
                  "Cannot add NULL pointed command to command buffer!");
   }
 
-  result_command_node_ptr _ = command_node_new(cmd);
-  if(!_.ok)
+  if(cmd->type == PUSH_CLIP_RECT)
   {
-    return error(result_void, _.error);
+    return command_buffer_add_push_clip_rect_command(buffer,
+                                                     cmd->data.clip_rect);
   }
 
-  command_node* cmd_node = _.value;
+  if(cmd->type == POP_CLIP_RECT)
+  {
+    return command_buffer_add_pop_clip_rect_command(buffer);
+  }
 
-  buffer->length += 1;
+  if(cmd->type == RENDER_TEXT)
+  {
+    // command buffer owns the text of its commands
+    return command_buffer_add_render_text_command(
+      buffer,
+      cmd->data.render_text.text,
+      cmd->data.render_text.font,
+      cmd->data.render_text.text_color,
+      cmd->data.render_text.text_coordinates,
+      cmd->data.render_text.dimensions);
+  }
 
-  if(!buffer->head)
+  if(cmd->type == RENDER_GLYPH_RUN)
   {
-    buffer->head = cmd_node;
-    buffer->tail = cmd_node;
+    // command buffer owns the glyphs of its commands
+    return command_buffer_add_render_glyph_run_command(
+      buffer,
+      cmd->data.render_glyph_run.glyphs,
+      cmd->data.render_glyph_run.glyphs_count,
+      cmd->data.render_glyph_run.font,
+      cmd->data.render_glyph_run.text_color,
+      cmd->data.render_glyph_run.text_coordinates,
+      cmd->data.render_glyph_run.dimensions);
+  }
 
+  if(command_buffer_is_clipped_out(buffer, cmd))
+  {
     return ok_void();
   }
 
-  buffer->tail->next = cmd_node;
-  buffer->tail = cmd_node;
+  const rect* rects = NULL;
+  if(cmd->type == RENDER_RECTS)
+  {
+    // command buffer owns the rects of its commands
+    size_t rects_size = cmd->data.render_rects.rects_count * sizeof(rect);
+    rect* rects_copy = (rect*)command_buffer_arena_alloc(
+      buffer, rects_size, _Alignof(rect));
+    if(!rects_copy)
+    {
+      return error(result_void,
+                   "Unable to allocate memory for rects of command!");
+    }
+    memcpy(rects_copy, cmd->data.render_rects.rects, rects_size);
+    rects = rects_copy;
+  }
+
+  result_command_ptr _ = command_buffer_push(buffer);
+  if(!_.ok)
+  {
+    return error(result_void, _.error);
+  }
+
+  *_.value = *cmd;
+  if(cmd->type == RENDER_RECTS)
+  {
+    _.value->data.render_rects.rects = rects;
+  }
 
   return ok_void();
 }
@@ -313,19 +815,22 @@ result_void command_buffer_add_render_rect_command(command_buffer* buffer,
                  "Cannot add command to NULL pointed command buffer!");
   }
 
-  result_command_ptr _ = command_new_render_rect(bounding_rect, rect_color);
-  if(!_.ok)
+  command cmd = {.type = RENDER_RECT,
+                 .data.render_rect = {.bounding_rect = bounding_rect,
+                                      .rect_color = rect_color}};
+  if(command_buffer_is_clipped_out(buffer, &cmd))
   {
-    return error(result_void, _.error);
+    return ok_void();
   }
 
-  command* cmd = _.value;
-  result_void __ = command_buffer_add_command(buffer, cmd);
-  if(!__.ok)
+  result_command_ptr _ = command_buffer_push(buffer);
+  if(!_.ok)
   {
-    return __;
+    return error(result_void, _.error);
   }
 
+  *_.value = cmd;
+
   return ok_void();
 }
 
@@ -341,20 +846,24 @@ command_buffer_add_render_rounded_rect_command(command_buffer* buffer,
                  "Cannot add command to NULL pointed command buffer!");
   }
 
-  result_command_ptr _ =
-    command_new_render_rounded_rect(bounding_rect, border_radius, rect_color);
-  if(!_.ok)
+  command cmd = {
+    .type = RENDER_ROUNDED_RECT,
+    .data.render_rounded_rect = {.bounding_rect = bounding_rect,
+                                 .border_radius = border_radius,
+                                 .rect_color = rect_color}};
+  if(command_buffer_is_clipped_out(buffer, &cmd))
   {
-    return error(result_void, _.error);
+    return ok_void();
   }
 
-  command* cmd = _.value;
-  result_void __ = command_buffer_add_command(buffer, cmd);
-  if(!__.ok)
+  result_command_ptr _ = command_buffer_push(buffer);
+  if(!_.ok)
   {
-    return __;
+    return error(result_void, _.error);
   }
 
+  *_.value = cmd;
+
   return ok_void();
 }
 
@@ -369,20 +878,22 @@ command_buffer_add_render_rect_outline_command(command_buffer* buffer,
                  "Cannot add command to NULL pointed command buffer!");
   }
 
-  result_command_ptr _ =
-    command_new_render_rect_outlined(bounding_rect, rect_outline_color);
-  if(!_.ok)
+  command cmd = {.type = RENDER_RECT_OUTLINED,
+                 .data.render_rect = {.bounding_rect = bounding_rect,
+                                      .rect_color = rect_outline_color}};
+  if(command_buffer_is_clipped_out(buffer, &cmd))
   {
-    return error(result_void, _.error);
+    return ok_void();
   }
 
-  command* cmd = _.value;
-  result_void __ = command_buffer_add_command(buffer, cmd);
-  if(!__.ok)
+  result_command_ptr _ = command_buffer_push(buffer);
+  if(!_.ok)
   {
-    return __;
+    return error(result_void, _.error);
   }
 
+  *_.value = cmd;
+
   return ok_void();
 }
 
@@ -396,26 +907,30 @@ result_void command_buffer_add_render_line_command(command_buffer* buffer,
                  "Cannot add command to NULL pointed command buffer!");
   }
 
-  result_command_ptr _ = command_new_render_line(begin, end);
-  if(!_.ok)
+  command cmd = {.type = RENDER_LINE,
+                 .data.render_line = {.begin = begin, .end = end}};
+  if(command_buffer_is_clipped_out(buffer, &cmd))
   {
-    return error(result_void, _.error);
+    return ok_void();
   }
 
-  command* cmd = _.value;
-  result_void __ = command_buffer_add_command(buffer, cmd);
-  if(!__.ok)
+  result_command_ptr _ = command_buffer_push(buffer);
+  if(!_.ok)
   {
-    return __;
+    return error(result_void, _.error);
   }
 
+  *_.value = cmd;
+
   return ok_void();
 }
 
 result_void command_buffer_add_render_text_command(command_buffer* buffer,
                                                    const char* text,
+                                                   font_handle font,
                                                    const color text_color,
-                                                   point text_coordinates)
+                                                   point text_coordinates,
+                                                   text_dimensions dimensions)
 {
   if(!buffer)
   {
@@ -430,20 +945,101 @@ result_void command_buffer_add_render_text_command(command_buffer* buffer,
       "Cannot add a render text command, with text pointing to NULL!");
   }
 
-  result_command_ptr _ =
-    command_new_render_text(text, text_color, text_coordinates);
+  command cmd = {.type = RENDER_TEXT,
+                 .data.render_text = {.text_coordinates = text_coordinates,
+                                      .dimensions = dimensions}};
+  if(command_buffer_is_clipped_out(buffer, &cmd))
+  {
+    return ok_void();
+  }
+
+  size_t text_length = strlen(text);
+  if(text_length > UINT16_MAX)
+  {
+    return error(result_void,
+                 "Cannot add a render text command, text is too long!");
+  }
+
+  const char* text_copy = command_buffer_copy_text(buffer, text, text_length);
+  if(!text_copy)
+  {
+    return error(result_void, "Unable to make a copy of text for command!");
+  }
+
+  result_command_ptr _ = command_buffer_push(buffer);
   if(!_.ok)
   {
     return error(result_void, _.error);
   }
 
-  command* cmd = _.value;
-  result_void __ = command_buffer_add_command(buffer, cmd);
-  if(!__.ok)
+  cmd.data.render_text =
+    (render_text_data){.text = text_copy,
+                       .text_length = (uint16)text_length,
+                       .font = font,
+                       .text_color = text_color,
+                       .text_coordinates = text_coordinates,
+                       .dimensions = dimensions};
+  *_.value = cmd;
+
+  return ok_void();
+}
+
+result_void
+command_buffer_add_render_glyph_run_command(command_buffer* buffer,
+                                            const positioned_glyph* glyphs,
+                                            uint16 glyphs_count,
+                                            font_handle font,
+                                            const color text_color,
+                                            point text_coordinates,
+                                            text_dimensions dimensions)
+{
+  if(!buffer)
   {
-    return __;
+    return error(result_void,
+                 "Cannot add command to NULL pointed command buffer!");
   }
 
+  if(!glyphs && glyphs_count)
+  {
+    return error(
+      result_void,
+      "Cannot add a render glyph run command, with glyphs pointing to NULL!");
+  }
+
+  command cmd = {.type = RENDER_GLYPH_RUN,
+                 .data.render_glyph_run = {.text_coordinates = text_coordinates,
+                                           .dimensions = dimensions}};
+  // glyph run without glyphs paints nothing
+  if(!glyphs_count || command_buffer_is_clipped_out(buffer, &cmd))
+  {
+    return ok_void();
+  }
+
+  size_t glyphs_size = glyphs_count * sizeof(positioned_glyph);
+  positioned_glyph* glyphs_copy = (positioned_glyph*)command_buffer_arena_alloc(
+    buffer, glyphs_size, _Alignof(positioned_glyph));
+  if(!glyphs_copy)
+  {
+    return error(result_void,
+                 "Unable to allocate memory for glyphs of command!");
+  }
+  memcpy(glyphs_copy, glyphs, glyphs_size);
+
+  result_command_ptr _ = command_buffer_push(buffer);
+  if(!_.ok)
+  {
+    return error(result_void, _.error);
+  }
+
+  cmd.data.render_glyph_run =
+    (render_glyph_run_data){.glyphs = glyphs_copy,
+                            .glyphs_count = glyphs_count,
+                            .font = font,
+                            .text_color = text_color,
+                            .text_coordinates = text_coordinates,
+                            .dimensions = dimensions};
+  *_.value = cmd;
+
   return ok_void();
 }
 
@@ -456,18 +1052,44 @@ result_void command_buffer_add_push_clip_rect_command(command_buffer* buffer,
                  "Cannot add command to NULL pointed command buffer!");
   }
 
-  result_command_ptr _ = command_new_push_clip_rect(clip_rect);
+  if(buffer->clip_depth == buffer->clip_capacity)
+  {
+    if(buffer->clip_capacity == UINT16_MAX)
+    {
+      return error(result_void,
+                   "Clip stack is full, cannot push more clip rects!");
+    }
+
+    uint32 new_capacity = buffer->clip_capacity
+                            ? (uint32)buffer->clip_capacity * 2
+                            : CLIP_STACK_INITIAL_CAPACITY;
+    new_capacity = min(new_capacity, UINT16_MAX);
+
+    rect* clip_stack =
+      (rect*)realloc(buffer->clip_stack, new_capacity * sizeof(rect));
+    if(!clip_stack)
+    {
+      return error(result_void,
+                   "Unable to grow memory for clip stack of command buffer!");
+    }
+
+    buffer->clip_stack = clip_stack;
+    buffer->clip_capacity = (uint16)new_capacity;
+  }
+
+  result_command_ptr _ = command_buffer_push(buffer);
   if(!_.ok)
   {
     return error(result_void, _.error);
   }
 
+  // clip rect is clipped by the enclosing clip rects
+  rect clip = rect_intersect(command_buffer_current_clip(buffer), clip_rect);
+  buffer->clip_stack[buffer->clip_depth++] = clip;
+
   command* cmd = _.value;
-  result_void __ = command_buffer_add_command(buffer, cmd);
-  if(!__.ok)
-  {
-    return __;
-  }
+  cmd->type = PUSH_CLIP_RECT;
+  cmd->data.clip_rect = clip;
 
   return ok_void();
 }
@@ -480,19 +1102,22 @@ result_void command_buffer_add_pop_clip_rect_command(command_buffer* buffer)
                  "Cannot add command to NULL pointed command buffer!");
   }
 
-  result_command_ptr _ = command_new_pop_clip_rect();
+  result_command_ptr _ = command_buffer_push(buffer);
   if(!_.ok)
   {
     return error(result_void, _.error);
   }
 
-  command* cmd = _.value;
-  result_void __ = command_buffer_add_command(buffer, cmd);
-  if(!__.ok)
+  // popping more than pushed in this buffer happens with incremental
+  // updates, enclosing clip rects are not known then
+  if(buffer->clip_depth)
   {
-    return __;
+    buffer->clip_depth -= 1;
   }
 
+  _.value->type = POP_CLIP_RECT;
+  _.value->data.clip_rect = command_buffer_current_clip(buffer);
+
   return ok_void();
 }
 
@@ -505,18 +1130,13 @@ result_void command_buffer_add_set_cursor_command(command_buffer* buffer,
                  "Cannot add command to NULL pointed command buffer!");
   }
 
-  result_command_ptr _ = command_new_set_cursor(cursor_type);
+  result_command_ptr _ = command_buffer_push(buffer);
   if(!_.ok)
   {
     return error(result_void, _.error);
   }
 
-  command* cmd = _.value;
-  result_void __ = command_buffer_add_command(buffer, cmd);
-  if(!__.ok)
-  {
-    return __;
-  }
+  _.value->type = cursor_type;
 
   return ok_void();
 }
@@ -529,211 +1149,534 @@ result_void command_buffer_add_clear_window_command(command_buffer* buffer)
                  "Cannot add command to NULL pointed command buffer!");
   }
 
-  result_command_ptr _ = command_new_clear_window();
+  result_command_ptr _ = command_buffer_push(buffer);
   if(!_.ok)
   {
     return error(result_void, _.error);
   }
 
-  command* cmd = _.value;
-  result_void __ = command_buffer_add_command(buffer, cmd);
-  if(!__.ok)
-  {
-    return __;
-  }
+  _.value->type = CLEAR_WINDOW;
 
   return ok_void();
 }
 
-result_command_ptr command_buffer_get_next_command(command_buffer* buffer)
+uint32 command_buffer_get_segments_count(const command_buffer* buffer)
 {
   if(!buffer)
   {
-    return error(
-      result_command_ptr,
-      "Cannot get next command from a NULL pointing command buffer!");
+    return 0;
   }
 
-  if(!buffer->length)
+  return (buffer->length + COMMAND_SEGMENT_MASK) >> COMMAND_SEGMENT_SHIFT;
+}
+
+command_span command_buffer_get_segment(const command_buffer* buffer,
+                                        uint32 index)
+{
+  if(!buffer || index >= command_buffer_get_segments_count(buffer))
   {
-    return error(result_command_ptr,
-                 "Command buffer is empty, cannot get next command!");
+    return (command_span){.commands = NULL, .length = 0};
   }
 
-  command_node* cmd_node = buffer->head;
-  command* cmd = cmd_node->cmd;
-  buffer->head = cmd_node->next;
-  buffer->length -= 1;
+  uint32 begin = index << COMMAND_SEGMENT_SHIFT;
+  return (command_span){
+    .commands = buffer->segments[index],
+    .length = min(buffer->length - begin, COMMAND_SEGMENT_CAPACITY)};
+}
 
-  // shallow freeing command node
-  command_node_shallow_free(cmd_node);
+const command* command_buffer_get_command(const command_buffer* buffer,
+                                          uint32 index)
+{
+  if(!buffer || index >= buffer->length)
+  {
+    return NULL;
+  }
 
-  // need to free cmd externally
-  return ok(result_command_ptr, cmd);
+  return command_buffer_at(buffer, index);
 }
 
-result_void command_buffer_clear_commands(command_buffer* buffer)
+/// Grows scratch memory of culling & batching passes to hold
+/// all commands of command buffer.
+static result_void command_buffer_reserve_scratch(command_buffer* buffer)
 {
-  if(!buffer)
+  if(buffer->scratch_capacity >= buffer->length)
+  {
+    return ok_void();
+  }
+
+  // reserving scratch memory for all allocated segments
+  uint32 capacity = buffer->segments_count * COMMAND_SEGMENT_CAPACITY;
+
+  cull_entry* entries = (cull_entry*)realloc(
+    buffer->cull_entries, capacity * sizeof(cull_entry));
+  if(!entries)
   {
     return error(result_void,
-                 "Cannot clear commands in NULL pointed command buffer!");
+                 "Unable to allocate memory for culling occluded commands!");
   }
+  buffer->cull_entries = entries;
+
+  batch_entry* batch_entries = (batch_entry*)realloc(
+    buffer->batch_entries, capacity * sizeof(batch_entry));
+  if(!batch_entries)
+  {
+    return error(result_void,
+                 "Unable to allocate memory for batching commands!");
+  }
+  buffer->batch_entries = batch_entries;
+
+  buffer->scratch_capacity = capacity;
 
-  // TODO: Maybe we should use dynamic array
-  // for storing these commands
-  // as this linked list entirely depends on speed
-  // of random access of memory
+  return ok_void();
+}
 
-  if(!buffer->head)
+result_command_culling_stats
+command_buffer_cull_occluded_commands(command_buffer* buffer)
+{
+  if(!buffer)
   {
-    return ok_void();
+    return error(result_command_culling_stats,
+                 "Cannot cull commands of NULL pointed command buffer!");
+  }
+
+  command_culling_stats stats = {.commands_total = buffer->length,
+                                 .commands_culled = 0};
+  if(buffer->length < 2)
+  {
+    return ok(result_command_culling_stats, stats);
   }
 
-  command_node* prev_cmd_node = buffer->head;
-  command_node* cmd_node = prev_cmd_node->next;
+  result_void _ = command_buffer_reserve_scratch(buffer);
+  if(!_.ok)
+  {
+    return error(result_command_culling_stats, _.error);
+  }
 
-  while(cmd_node)
+  // forward pass: finding clip rect active for each command,
+  // clip commands carry the clip rect active after them
+  cull_entry* entries = buffer->cull_entries;
+  rect clip = unbounded_rect;
+  for(uint32 i = 0; i < buffer->length; i++)
   {
-    result_void _ = command_node_free(prev_cmd_node);
-    if(!_.ok)
+    const command* cmd = command_buffer_at(buffer, i);
+    if(cmd->type == PUSH_CLIP_RECT || cmd->type == POP_CLIP_RECT)
+    {
+      clip = cmd->data.clip_rect;
+    }
+    entries[i] = (cull_entry){.clip = clip, .culled = false};
+  }
+
+  // backward pass: dropping commands covered by later opaque rects
+  rect occluders[OCCLUDERS_MAX];
+  uint8 occluders_count = 0;
+  for(uint32 i = buffer->length; i-- > 0;)
+  {
+    const command* cmd = command_buffer_at(buffer, i);
+
+    rect bounds;
+    if(!command_painted_rect(cmd, &bounds))
+    {
+      continue;
+    }
+
+    bool covered = false;
+    for(uint8 j = 0; j < occluders_count; j++)
     {
-      return _;
+      if(rect_contains(occluders[j], bounds))
+      {
+        covered = true;
+        break;
+      }
     }
 
-    prev_cmd_node = cmd_node;
-    cmd_node = cmd_node->next;
+    if(covered)
+    {
+      entries[i].culled = true;
+      stats.commands_culled += 1;
+      continue;
+    }
+
+    if(cmd->type == RENDER_RECT && cmd->data.render_rect.rect_color.a == 255 &&
+       occluders_count < OCCLUDERS_MAX)
+    {
+      // only the clipped area of rect is painted
+      rect painted_area = rect_intersect(bounds, entries[i].clip);
+      if(painted_area.w && painted_area.h)
+      {
+        occluders[occluders_count++] = painted_area;
+      }
+    }
   }
-  result_void _ = command_node_free(prev_cmd_node);
-  if(!_.ok)
+
+  if(!stats.commands_culled)
   {
-    return _;
+    return ok(result_command_culling_stats, stats);
   }
 
-  buffer->head = NULL;
-  buffer->tail = NULL;
-  buffer->length = 0;
+  // compacting remaining commands, preserving their order
+  uint32 length = 0;
+  for(uint32 i = 0; i < buffer->length; i++)
+  {
+    if(!entries[i].culled)
+    {
+      *command_buffer_at(buffer, length++) = *command_buffer_at(buffer, i);
+    }
+  }
+  buffer->length = length;
 
-  return ok_void();
+  return ok(result_command_culling_stats, stats);
 }
 
-result_void command_buffer_free(command_buffer* buffer)
+/// Tells if two rects overlap.
+static bool rect_overlaps(rect a, rect b)
 {
-  if(!buffer)
+  rect intersection = rect_intersect(a, b);
+  return intersection.w && intersection.h;
+}
+
+/// Tells if two colors are same.
+static bool color_equals(color a, color b)
+{
+  return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+/// Tells if command is a set cursor command.
+static bool command_is_set_cursor(const command* cmd)
+{
+  return cmd->type >= SET_CURSOR_ARROW && cmd->type <= SET_CURSOR_PROHIBITED;
+}
+
+/// Tells if rect overlaps any rect in the group led by `leader`.
+static bool batch_group_overlaps(const command_buffer* buffer,
+                                 uint32 leader,
+                                 rect bounds)
+{
+  for(uint32 i = leader; i != BATCH_NONE; i = buffer->batch_entries[i].next)
   {
-    return error(result_void, "Attempt to free a NULL pointed command buffer!");
+    const command* cmd = command_buffer_at(buffer, i);
+    if(rect_overlaps(cmd->data.render_rect.bounding_rect, bounds))
+    {
+      return true;
+    }
   }
 
-  if(buffer->head)
+  return false;
+}
+
+/// Finds group of `RENDER_RECT` commands, which the rect command at `index`
+/// can be merged into, without changing rendered result.
+/// Returns index of group leader, `BATCH_NONE` if there is no such group.
+static uint32 batch_find_group(const command_buffer* buffer,
+                               const batch_draw* draws,
+                               uint8 draws_count,
+                               uint32 index)
+{
+  const render_rect_data* data =
+    &command_buffer_at(buffer, index)->data.render_rect;
+
+  // finding latest group of same color, in current region
+  int32 i = (int32)draws_count - 1;
+  uint32 leader = BATCH_NONE;
+  for(; i >= 0; i--)
   {
-    command_node* prev_cmd_node = buffer->head;
-    command_node* cmd_node = prev_cmd_node->next;
-    while(cmd_node)
+    if(draws[i].leader != BATCH_NONE)
     {
-      result_void _ = command_node_free(prev_cmd_node);
-      if(!_.ok)
+      const command* leader_cmd = command_buffer_at(buffer, draws[i].leader);
+      if(color_equals(leader_cmd->data.render_rect.rect_color,
+                      data->rect_color))
       {
-        return _;
+        leader = draws[i].leader;
+        break;
       }
+    }
 
-      prev_cmd_node = cmd_node;
-      cmd_node = cmd_node->next;
+    if(rect_overlaps(draws[i].bounds, data->bounding_rect))
+    {
+      // rect cannot be moved above a command it overlaps
+      return BATCH_NONE;
     }
-    result_void _ = command_node_free(prev_cmd_node);
-    if(!_.ok)
+  }
+
+  if(leader == BATCH_NONE)
+  {
+    return BATCH_NONE;
+  }
+
+  // rect is moved up to the group leader, so it must not overlap
+  // any other command after the group leader
+  for(; i >= 0 && draws[i].index >= leader; i--)
+  {
+    if(draws[i].leader != leader &&
+       rect_overlaps(draws[i].bounds, data->bounding_rect))
     {
-      return _;
+      return BATCH_NONE;
     }
   }
 
-  free(buffer);
+  // translucent rects of a group are filled at once, overlapping area
+  // would be blended only once
+  if(data->rect_color.a != 255 &&
+     batch_group_overlaps(buffer, leader, data->bounding_rect))
+  {
+    return BATCH_NONE;
+  }
 
-  return ok_void();
+  return leader;
 }
 
-static result_const_command_ptr
-const_iterator_next_command(command_buffer_const_iterator* iterator)
+result_command_batching_stats
+command_buffer_batch_commands(command_buffer* buffer, bool merge_rects)
 {
-  if(!iterator)
+  if(!buffer)
   {
-    return error(result_const_command_ptr,
-                 "Cannot get next command from NULL pointing const iterator of "
-                 "command buffer!");
+    return error(result_command_batching_stats,
+                 "Cannot batch commands of NULL pointed command buffer!");
   }
 
-  if(!iterator->private_data->node)
+  command_batching_stats stats = {
+    .commands_total = buffer->length, .commands_merged = 0,
+    .commands_dropped = 0};
+  if(buffer->length < 2)
   {
-    return error(result_const_command_ptr,
-                 "Cannot get next command, as iterator is not good. Verify "
-                 "const_iterator->good before calling for next command!");
+    return ok(result_command_batching_stats, stats);
   }
 
-  const command* next_cmd = iterator->private_data->node->cmd;
+  result_void _ = command_buffer_reserve_scratch(buffer);
+  if(!_.ok)
+  {
+    return error(result_command_batching_stats, _.error);
+  }
 
-  /// moving to next node
-  iterator->private_data->node = iterator->private_data->node->next;
-  if(!iterator->private_data->node)
+  // first pass: grouping rects, finding redundant commands
+  batch_entry* entries = buffer->batch_entries;
+  batch_draw draws[BATCH_WINDOW_MAX];
+  uint8 draws_count = 0;
+  uint32 last_cursor = BATCH_NONE;
+  uint32 empty_clip_push = BATCH_NONE;
+  for(uint32 i = 0; i < buffer->length; i++)
   {
-    iterator->good = false;
+    const command* cmd = command_buffer_at(buffer, i);
+    entries[i] = (batch_entry){.role = BATCH_KEEP,
+                               .next = BATCH_NONE,
+                               .last = i,
+                               .count = 1,
+                               .rects = NULL};
+
+    if(command_is_set_cursor(cmd))
+    {
+      // only the last cursor of frame is visible
+      if(last_cursor != BATCH_NONE)
+      {
+        entries[last_cursor].role = BATCH_DROP;
+        stats.commands_dropped += 1;
+      }
+      last_cursor = i;
+      continue;
+    }
+
+    if(cmd->type == PUSH_CLIP_RECT)
+    {
+      empty_clip_push = i;
+      draws_count = 0;
+      continue;
+    }
+
+    if(cmd->type == POP_CLIP_RECT)
+    {
+      // pop restores the clip rect active before push, so push & pop
+      // with nothing in between are dropped
+      if(empty_clip_push != BATCH_NONE)
+      {
+        entries[empty_clip_push].role = BATCH_DROP;
+        entries[i].role = BATCH_DROP;
+        stats.commands_dropped += 2;
+      }
+      empty_clip_push = BATCH_NONE;
+      draws_count = 0;
+      continue;
+    }
+
+    empty_clip_push = BATCH_NONE;
+
+    rect bounds;
+    if(!merge_rects || !command_painted_rect(cmd, &bounds))
+    {
+      // text extents are unknown, nothing is moved across it
+      draws_count = 0;
+      continue;
+    }
+
+    if(cmd->type == RENDER_RECT_OUTLINED || cmd->type == RENDER_LINE)
+    {
+      // strokes paint half of line width outside their path
+      bounds = (rect){.x = bounds.x - 1,
+                      .y = bounds.y - 1,
+                      .w = bounds.w + 2,
+                      .h = bounds.h + 2};
+    }
+
+    uint32 leader = BATCH_NONE;
+    if(cmd->type == RENDER_RECT)
+    {
+      leader = batch_find_group(buffer, draws, draws_count, i);
+      if(leader == BATCH_NONE)
+      {
+        leader = i;
+      }
+      else
+      {
+        entries[i].role = BATCH_MEMBER;
+        entries[entries[leader].last].next = i;
+        entries[leader].last = i;
+        entries[leader].count += 1;
+        entries[leader].role = BATCH_LEADER;
+        stats.commands_merged += 1;
+      }
+    }
+
+    if(draws_count == BATCH_WINDOW_MAX)
+    {
+      draws_count = 0;
+    }
+    draws[draws_count++] =
+      (batch_draw){.bounds = bounds, .index = i, .leader = leader};
   }
 
-  return ok(result_const_command_ptr, next_cmd);
+  if(!stats.commands_merged && !stats.commands_dropped)
+  {
+    return ok(result_command_batching_stats, stats);
+  }
+
+  // gathering rects of groups, before any command is overwritten
+  for(uint32 i = 0; i < buffer->length; i++)
+  {
+    if(entries[i].role != BATCH_LEADER)
+    {
+      continue;
+    }
+
+    rect* rects = (rect*)command_buffer_arena_alloc(
+      buffer, entries[i].count * sizeof(rect), _Alignof(rect));
+    if(!rects)
+    {
+      return error(result_command_batching_stats,
+                   "Unable to allocate memory for batching commands!");
+    }
+
+    uint16 rects_count = 0;
+    for(uint32 j = i; j != BATCH_NONE; j = entries[j].next)
+    {
+      const command* member = command_buffer_at(buffer, j);
+      rects[rects_count++] = member->data.render_rect.bounding_rect;
+    }
+    entries[i].rects = rects;
+  }
+
+  // second pass: writing batched commands in place
+  uint32 length = 0;
+  for(uint32 i = 0; i < buffer->length; i++)
+  {
+    const batch_entry* entry = &entries[i];
+    if(entry->role == BATCH_DROP || entry->role == BATCH_MEMBER)
+    {
+      continue;
+    }
+
+    if(entry->role == BATCH_KEEP)
+    {
+      *command_buffer_at(buffer, length++) = *command_buffer_at(buffer, i);
+      continue;
+    }
+
+    color rects_color =
+      command_buffer_at(buffer, i)->data.render_rect.rect_color;
+    command* cmd = command_buffer_at(buffer, length++);
+    cmd->type = RENDER_RECTS;
+    cmd->data.render_rects = (render_rects_data){.rects = entry->rects,
+                                                 .rects_count = entry->count,
+                                                 .rects_color = rects_color};
+  }
+  buffer->length = length;
+
+  return ok(result_command_batching_stats, stats);
 }
 
-result_command_buffer_const_iterator_ptr
-command_buffer_const_iterator_new(const command_buffer* buffer)
+result_void command_buffer_remove_commands(command_buffer* buffer,
+                                           uint32 begin,
+                                           const bool* removed)
 {
   if(!buffer)
   {
-    return error(
-      result_command_buffer_const_iterator_ptr,
-      "Cannot create const iterator for NULL pointing command buffer!");
+    return error(result_void,
+                 "Cannot remove commands of NULL pointed command buffer!");
   }
 
-  command_buffer_const_iterator* iterator =
-    (command_buffer_const_iterator*)calloc(
-      1, sizeof(command_buffer_const_iterator));
-  if(!iterator)
+  if(!removed)
   {
-    return error(
-      result_command_buffer_const_iterator_ptr,
-      "Unable to allocate memory for const iterator of command buffer!");
+    return error(result_void,
+                 "Cannot remove commands with NULL pointing removed flags!");
   }
 
-  command_buffer_const_iterator_private_data* private_data =
-    (command_buffer_const_iterator_private_data*)calloc(
-      1, sizeof(command_buffer_const_iterator_private_data));
-  if(!private_data)
+  if(begin > buffer->length)
   {
-    free(iterator);
-    return error(result_command_buffer_const_iterator_ptr,
-                 "Unable to allocate memory for private data of const iterator "
-                 "for command buffer!");
+    return error(result_void, "Cannot remove commands out of command buffer!");
   }
 
-  iterator->cmd_buffer = buffer;
-  iterator->next_cmd = const_iterator_next_command;
-  private_data->node = buffer->head;
-  iterator->private_data = private_data;
-  iterator->good = buffer->head ? true : false;
+  uint32 length = begin;
+  for(uint32 i = begin; i < buffer->length; i++)
+  {
+    if(!removed[i - begin])
+    {
+      *command_buffer_at(buffer, length++) = *command_buffer_at(buffer, i);
+    }
+  }
+  buffer->length = length;
 
-  return ok(result_command_buffer_const_iterator_ptr, iterator);
+  return ok_void();
 }
 
-result_void
-command_buffer_const_iterator_free(command_buffer_const_iterator* iterator)
+result_void command_buffer_clear_commands(command_buffer* buffer)
 {
-  if(!iterator)
+  if(!buffer)
   {
-    return error(
-      result_void,
-      "Attempt to free NULL pointing command buffer const iterator!");
+    return error(result_void,
+                 "Cannot clear commands in NULL pointed command buffer!");
   }
 
-  /// freeing private data of iterator
-  free(iterator->private_data);
+  // retaining storage of commands and texts, for next frame
+  buffer->length = 0;
+  buffer->clip_depth = 0;
+  buffer->current_arena_chunk = buffer->arena_chunks;
+  buffer->current_arena_chunk->used = 0;
 
-  free(iterator);
+  return ok_void();
+}
+
+result_void command_buffer_free(command_buffer* buffer)
+{
+  if(!buffer)
+  {
+    return error(result_void, "Attempt to free a NULL pointed command buffer!");
+  }
+
+  arena_chunk* chunk = buffer->arena_chunks;
+  while(chunk)
+  {
+    arena_chunk* next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+
+  for(uint32 i = 0; i < buffer->segments_count; i++)
+  {
+    free(buffer->segments[i]);
+  }
+  free(buffer->segments);
+
+  free(buffer->clip_stack);
+  free(buffer->cull_entries);
+  free(buffer->batch_entries);
+  free(buffer);
 
   return ok_void();
 }
@@ -0,0 +1,910 @@
+#include "../include/command_stream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/macros.h"
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/// Magic bytes at the start of command stream.
+#define COMMAND_STREAM_MAGIC "SMOLLREC"
+#define COMMAND_STREAM_MAGIC_SIZE 8
+
+/// Size of command stream header: magic, version, flags.
+#define COMMAND_STREAM_HEADER_SIZE (COMMAND_STREAM_MAGIC_SIZE + 2 + 2)
+
+/// Tag of frame record.
+#define COMMAND_STREAM_FRAME_TAG 'F'
+
+/// Command types, indexed by their wire type minus one.
+/// Only append to this table, wire types must never change.
+static const command_type wire_command_types[] = {
+  RENDER_LINE,
+  RENDER_TEXT,
+  RENDER_RECT,
+  RENDER_ROUNDED_RECT,
+  RENDER_RECT_OUTLINED,
+  RENDER_RECTS,
+  PUSH_CLIP_RECT,
+  POP_CLIP_RECT,
+  SET_CURSOR_ARROW,
+  SET_CURSOR_IBEAM,
+  SET_CURSOR_MOVE,
+  SET_CURSOR_CROSSHAIR,
+  SET_CURSOR_RESIZE_LEFT_RIGHT,
+  SET_CURSOR_RESIZE_TOP_LEFT__BOTTOM_RIGHT,
+  SET_CURSOR_RESIZE_TOP_RIGHT__BOTTOM_LEFT,
+  SET_CURSOR_RESIZE_TOP_BOTTOM,
+  SET_CURSOR_HAND,
+  SET_CURSOR_PROCESSING,
+  SET_CURSOR_LOADING,
+  SET_CURSOR_PROHIBITED,
+  CLEAR_WINDOW,
+  RENDER_GLYPH_RUN,
+};
+
+#define WIRE_COMMAND_TYPES_COUNT                                               \
+  (sizeof(wire_command_types) / sizeof(wire_command_types[0]))
+
+/// Gives wire type of command type, 0 if command type is unknown.
+static uint8 command_type_to_wire(command_type type)
+{
+  for(uint8 i = 0; i < WIRE_COMMAND_TYPES_COUNT; i++)
+  {
+    if(wire_command_types[i] == type)
+    {
+      return i + 1;
+    }
+  }
+
+  return 0;
+}
+
+/// Gives current time in nanoseconds.
+static uint64 timestamp_now_ns()
+{
+  struct timespec now;
+  timespec_get(&now, TIME_UTC);
+  return (uint64)now.tv_sec * 1000000000ull + (uint64)now.tv_nsec;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Writer
+///////////////////////////////////////////////////////////////////////////////
+
+struct command_stream_writer
+{
+  FILE* file;
+
+  /// Time at which the writer was opened.
+  uint64 start_ns;
+
+  /// Bytes of frame being written, retained between frames.
+  uint8* bytes;
+  size_t length;
+  size_t capacity;
+};
+
+/// Grows bytes of writer to hold `size` more bytes.
+static bool writer_reserve(command_stream_writer* writer, size_t size)
+{
+  if(writer->length + size <= writer->capacity)
+  {
+    return true;
+  }
+
+  size_t new_capacity = writer->capacity ? writer->capacity * 2 : 4096;
+  while(new_capacity < writer->length + size)
+  {
+    new_capacity *= 2;
+  }
+
+  uint8* bytes = (uint8*)realloc(writer->bytes, new_capacity);
+  if(!bytes)
+  {
+    return false;
+  }
+
+  writer->bytes = bytes;
+  writer->capacity = new_capacity;
+
+  return true;
+}
+
+static void write_u8(command_stream_writer* writer, uint8 value)
+{
+  writer->bytes[writer->length++] = value;
+}
+
+static void write_u16(command_stream_writer* writer, uint16 value)
+{
+  write_u8(writer, (uint8)(value & 0xff));
+  write_u8(writer, (uint8)(value >> 8));
+}
+
+static void write_u32(command_stream_writer* writer, uint32 value)
+{
+  write_u16(writer, (uint16)(value & 0xffff));
+  write_u16(writer, (uint16)(value >> 16));
+}
+
+static void write_u64(command_stream_writer* writer, uint64 value)
+{
+  write_u32(writer, (uint32)(value & 0xffffffff));
+  write_u32(writer, (uint32)(value >> 32));
+}
+
+static void write_f32(command_stream_writer* writer, float32 value)
+{
+  uint32 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  write_u32(writer, bits);
+}
+
+static void write_color(command_stream_writer* writer, color c)
+{
+  write_u8(writer, c.r);
+  write_u8(writer, c.g);
+  write_u8(writer, c.b);
+  write_u8(writer, c.a);
+}
+
+static void write_rect(command_stream_writer* writer, rect r)
+{
+  write_u16(writer, (uint16)r.x);
+  write_u16(writer, (uint16)r.y);
+  write_u16(writer, r.w);
+  write_u16(writer, r.h);
+}
+
+/// Size of encoded rect, color and glyph.
+#define WIRE_RECT_SIZE 8
+#define WIRE_COLOR_SIZE 4
+#define WIRE_GLYPH_SIZE 12
+
+/// Encodes a command at the end of bytes of writer.
+static result_void writer_encode_command(command_stream_writer* writer,
+                                         const command* cmd)
+{
+  uint8 wire_type = command_type_to_wire(cmd->type);
+  if(!wire_type)
+  {
+    return error(result_void, "Cannot record command of unknown type!");
+  }
+
+  // command with largest fixed size data is glyph run
+  size_t size = 1 + WIRE_COLOR_SIZE + 2 + 4 + 4 + 2;
+  if(cmd->type == RENDER_TEXT)
+  {
+    size += cmd->data.render_text.text_length;
+  }
+  else if(cmd->type == RENDER_RECTS)
+  {
+    size += (size_t)cmd->data.render_rects.rects_count * WIRE_RECT_SIZE;
+  }
+  else if(cmd->type == RENDER_GLYPH_RUN)
+  {
+    size +=
+      (size_t)cmd->data.render_glyph_run.glyphs_count * WIRE_GLYPH_SIZE;
+  }
+
+  if(!writer_reserve(writer, size))
+  {
+    return error(result_void, "Unable to allocate memory for recording!");
+  }
+
+  write_u8(writer, wire_type);
+
+  switch(cmd->type)
+  {
+  case RENDER_LINE: {
+    write_u16(writer, (uint16)cmd->data.render_line.begin.x);
+    write_u16(writer, (uint16)cmd->data.render_line.begin.y);
+    write_u16(writer, (uint16)cmd->data.render_line.end.x);
+    write_u16(writer, (uint16)cmd->data.render_line.end.y);
+    break;
+  }
+  case RENDER_TEXT: {
+    const render_text_data* data = &cmd->data.render_text;
+    write_color(writer, data->text_color);
+    write_u16(writer, data->font);
+    write_u16(writer, (uint16)data->text_coordinates.x);
+    write_u16(writer, (uint16)data->text_coordinates.y);
+    write_u16(writer, data->dimensions.w);
+    write_u16(writer, data->dimensions.h);
+    write_u16(writer, data->text_length);
+    memcpy(writer->bytes + writer->length, data->text, data->text_length);
+    writer->length += data->text_length;
+    break;
+  }
+  case RENDER_GLYPH_RUN: {
+    const render_glyph_run_data* data = &cmd->data.render_glyph_run;
+    write_color(writer, data->text_color);
+    write_u16(writer, data->font);
+    write_u16(writer, (uint16)data->text_coordinates.x);
+    write_u16(writer, (uint16)data->text_coordinates.y);
+    write_u16(writer, data->dimensions.w);
+    write_u16(writer, data->dimensions.h);
+    write_u16(writer, data->glyphs_count);
+    for(uint16 i = 0; i < data->glyphs_count; i++)
+    {
+      write_u32(writer, data->glyphs[i].index);
+      write_f32(writer, data->glyphs[i].x);
+      write_f32(writer, data->glyphs[i].y);
+    }
+    break;
+  }
+  case RENDER_RECT:
+  case RENDER_RECT_OUTLINED: {
+    write_rect(writer, cmd->data.render_rect.bounding_rect);
+    write_color(writer, cmd->data.render_rect.rect_color);
+    break;
+  }
+  case RENDER_ROUNDED_RECT: {
+    write_rect(writer, cmd->data.render_rounded_rect.bounding_rect);
+    write_u8(writer, cmd->data.render_rounded_rect.border_radius);
+    write_color(writer, cmd->data.render_rounded_rect.rect_color);
+    break;
+  }
+  case RENDER_RECTS: {
+    const render_rects_data* data = &cmd->data.render_rects;
+    write_color(writer, data->rects_color);
+    write_u16(writer, data->rects_count);
+    for(uint16 i = 0; i < data->rects_count; i++)
+    {
+      write_rect(writer, data->rects[i]);
+    }
+    break;
+  }
+  case PUSH_CLIP_RECT: {
+    write_rect(writer, cmd->data.clip_rect);
+    break;
+  }
+  default:
+    break;
+  }
+
+  return ok_void();
+}
+
+result_command_stream_writer_ptr command_stream_writer_open(const char* path)
+{
+  if(!path)
+  {
+    return error(result_command_stream_writer_ptr,
+                 "Cannot open command stream with NULL pointing path!");
+  }
+
+  command_stream_writer* writer =
+    (command_stream_writer*)calloc(1, sizeof(command_stream_writer));
+  if(!writer)
+  {
+    return error(result_command_stream_writer_ptr,
+                 "Unable to allocate memory for command stream writer!");
+  }
+
+  writer->file = fopen(path, "wb");
+  if(!writer->file)
+  {
+    free(writer);
+    return error(result_command_stream_writer_ptr,
+                 "Unable to open command stream file for writing!");
+  }
+
+  if(!writer_reserve(writer, COMMAND_STREAM_HEADER_SIZE))
+  {
+    fclose(writer->file);
+    free(writer);
+    return error(result_command_stream_writer_ptr,
+                 "Unable to allocate memory for command stream writer!");
+  }
+
+  memcpy(writer->bytes, COMMAND_STREAM_MAGIC, COMMAND_STREAM_MAGIC_SIZE);
+  writer->length = COMMAND_STREAM_MAGIC_SIZE;
+  write_u16(writer, COMMAND_STREAM_VERSION);
+  write_u16(writer, 0);
+
+  if(fwrite(writer->bytes, 1, writer->length, writer->file) != writer->length)
+  {
+    fclose(writer->file);
+    free(writer->bytes);
+    free(writer);
+    return error(result_command_stream_writer_ptr,
+                 "Unable to write header of command stream!");
+  }
+
+  writer->start_ns = timestamp_now_ns();
+
+  return ok(result_command_stream_writer_ptr, writer);
+}
+
+result_void command_stream_writer_write_frame(command_stream_writer* writer,
+                                              const command_buffer* buffer)
+{
+  if(!writer)
+  {
+    return error(result_void,
+                 "Cannot write frame to NULL pointed command stream writer!");
+  }
+
+  if(!buffer)
+  {
+    return error(result_void,
+                 "Cannot write NULL pointed command buffer as frame!");
+  }
+
+  writer->length = 0;
+  if(!writer_reserve(writer, 1 + 8 + 4))
+  {
+    return error(result_void, "Unable to allocate memory for recording!");
+  }
+
+  write_u8(writer, COMMAND_STREAM_FRAME_TAG);
+  write_u64(writer, timestamp_now_ns() - writer->start_ns);
+  write_u32(writer, command_buffer_length(buffer));
+
+  uint32 segments_count = command_buffer_get_segments_count(buffer);
+  for(uint32 s = 0; s < segments_count; s++)
+  {
+    command_span span = command_buffer_get_segment(buffer, s);
+    for(uint32 i = 0; i < span.length; i++)
+    {
+      result_void _ = writer_encode_command(writer, &span.commands[i]);
+      if(!_.ok)
+      {
+        return _;
+      }
+    }
+  }
+
+  if(fwrite(writer->bytes, 1, writer->length, writer->file) != writer->length)
+  {
+    return error(result_void, "Unable to write frame to command stream!");
+  }
+
+  return ok_void();
+}
+
+result_void command_stream_writer_close(command_stream_writer* writer)
+{
+  if(!writer)
+  {
+    return error(result_void,
+                 "Attempt to close a NULL pointed command stream writer!");
+  }
+
+  bool closed = fclose(writer->file) == 0;
+
+  free(writer->bytes);
+  free(writer);
+
+  if(!closed)
+  {
+    return error(result_void, "Unable to flush command stream file!");
+  }
+
+  return ok_void();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Reader
+///////////////////////////////////////////////////////////////////////////////
+
+struct command_stream_reader
+{
+  /// Mapped bytes of the file.
+  const uint8* bytes;
+  size_t size;
+
+  /// Offset of next byte to be read.
+  size_t offset;
+
+  /// Version of command stream format.
+  uint16 version;
+
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+#endif
+
+  /// Scratch memory for decoding texts, rects & glyphs, retained between
+  /// frames.
+  char* text;
+  uint32 text_capacity;
+  rect* rects;
+  uint32 rects_capacity;
+  positioned_glyph* glyphs;
+  uint32 glyphs_capacity;
+};
+
+/// Tells if `size` more bytes can be read.
+static bool reader_has(const command_stream_reader* reader, size_t size)
+{
+  return reader->size - reader->offset >= size;
+}
+
+static uint8 read_u8(command_stream_reader* reader)
+{
+  return reader->bytes[reader->offset++];
+}
+
+static uint16 read_u16(command_stream_reader* reader)
+{
+  uint16 low = read_u8(reader);
+  return (uint16)(low | (uint16)read_u8(reader) << 8);
+}
+
+static uint32 read_u32(command_stream_reader* reader)
+{
+  uint32 low = read_u16(reader);
+  return low | (uint32)read_u16(reader) << 16;
+}
+
+static uint64 read_u64(command_stream_reader* reader)
+{
+  uint64 low = read_u32(reader);
+  return low | (uint64)read_u32(reader) << 32;
+}
+
+static float32 read_f32(command_stream_reader* reader)
+{
+  uint32 bits = read_u32(reader);
+  float32 value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static color read_color(command_stream_reader* reader)
+{
+  color c;
+  c.r = read_u8(reader);
+  c.g = read_u8(reader);
+  c.b = read_u8(reader);
+  c.a = read_u8(reader);
+  return c;
+}
+
+static rect read_rect(command_stream_reader* reader)
+{
+  rect r;
+  r.x = (int16)read_u16(reader);
+  r.y = (int16)read_u16(reader);
+  r.w = read_u16(reader);
+  r.h = read_u16(reader);
+  return r;
+}
+
+static point read_point(command_stream_reader* reader)
+{
+  point p;
+  p.x = (int16)read_u16(reader);
+  p.y = (int16)read_u16(reader);
+  return p;
+}
+
+/// Reads dimensions of text, which are `0 x 0` (i.e. not known) in streams
+/// not recording them.
+static text_dimensions read_dimensions(command_stream_reader* reader,
+                                       size_t dimensions_bytes)
+{
+  text_dimensions d = {0};
+  if(dimensions_bytes)
+  {
+    d.w = read_u16(reader);
+    d.h = read_u16(reader);
+  }
+  return d;
+}
+
+/// Decodes a command, and adds it to command buffer.
+static result_void reader_decode_command(command_stream_reader* reader,
+                                         command_buffer* buffer)
+{
+  static const char* truncated = "Command stream is truncated!";
+
+  if(!reader_has(reader, 1))
+  {
+    return error(result_void, truncated);
+  }
+
+  uint8 wire_type = read_u8(reader);
+  if(wire_type < 1 || wire_type > WIRE_COMMAND_TYPES_COUNT)
+  {
+    return error(result_void, "Command stream has unknown command type!");
+  }
+
+  command cmd = {.type = wire_command_types[wire_type - 1]};
+  switch(cmd.type)
+  {
+  case RENDER_LINE: {
+    if(!reader_has(reader, 8))
+    {
+      return error(result_void, truncated);
+    }
+    cmd.data.render_line.begin = read_point(reader);
+    cmd.data.render_line.end = read_point(reader);
+    break;
+  }
+  case RENDER_TEXT: {
+    // fonts are recorded since version 2, dimensions since version 4
+    size_t font_bytes = reader->version >= 2 ? 2 : 0;
+    size_t dimensions_bytes = reader->version >= 4 ? 4 : 0;
+    if(!reader_has(reader,
+                   WIRE_COLOR_SIZE + font_bytes + 4 + dimensions_bytes + 2))
+    {
+      return error(result_void, truncated);
+    }
+    color text_color = read_color(reader);
+    font_handle font = font_bytes ? read_u16(reader) : DEFAULT_FONT_HANDLE;
+    point text_coordinates = read_point(reader);
+    text_dimensions dimensions = read_dimensions(reader, dimensions_bytes);
+    uint16 text_length = read_u16(reader);
+    if(!reader_has(reader, text_length))
+    {
+      return error(result_void, truncated);
+    }
+
+    // texts are not null-terminated in command stream
+    if(reader->text_capacity < (uint32)text_length + 1)
+    {
+      char* text = (char*)realloc(reader->text, (size_t)text_length + 1);
+      if(!text)
+      {
+        return error(result_void, "Unable to allocate memory for text!");
+      }
+      reader->text = text;
+      reader->text_capacity = (uint32)text_length + 1;
+    }
+    memcpy(reader->text, reader->bytes + reader->offset, text_length);
+    reader->text[text_length] = '\0';
+    reader->offset += text_length;
+
+    return command_buffer_add_render_text_command(
+      buffer, reader->text, font, text_color, text_coordinates, dimensions);
+  }
+  case RENDER_RECT:
+  case RENDER_RECT_OUTLINED: {
+    if(!reader_has(reader, WIRE_RECT_SIZE + WIRE_COLOR_SIZE))
+    {
+      return error(result_void, truncated);
+    }
+    cmd.data.render_rect.bounding_rect = read_rect(reader);
+    cmd.data.render_rect.rect_color = read_color(reader);
+    break;
+  }
+  case RENDER_ROUNDED_RECT: {
+    if(!reader_has(reader, WIRE_RECT_SIZE + 1 + WIRE_COLOR_SIZE))
+    {
+      return error(result_void, truncated);
+    }
+    cmd.data.render_rounded_rect.bounding_rect = read_rect(reader);
+    cmd.data.render_rounded_rect.border_radius = read_u8(reader);
+    cmd.data.render_rounded_rect.rect_color = read_color(reader);
+    break;
+  }
+  case RENDER_RECTS: {
+    if(!reader_has(reader, WIRE_COLOR_SIZE + 2))
+    {
+      return error(result_void, truncated);
+    }
+    color rects_color = read_color(reader);
+    uint16 rects_count = read_u16(reader);
+    if(!reader_has(reader, (size_t)rects_count * WIRE_RECT_SIZE))
+    {
+      return error(result_void, truncated);
+    }
+
+    if(reader->rects_capacity < rects_count)
+    {
+      rect* rects =
+        (rect*)realloc(reader->rects, (size_t)rects_count * sizeof(rect));
+      if(!rects)
+      {
+        return error(result_void, "Unable to allocate memory for rects!");
+      }
+      reader->rects = rects;
+      reader->rects_capacity = rects_count;
+    }
+    for(uint16 i = 0; i < rects_count; i++)
+    {
+      reader->rects[i] = read_rect(reader);
+    }
+
+    cmd.data.render_rects = (render_rects_data){.rects = reader->rects,
+                                                .rects_count = rects_count,
+                                                .rects_color = rects_color};
+    break;
+  }
+  case RENDER_GLYPH_RUN: {
+    size_t dimensions_bytes = reader->version >= 4 ? 4 : 0;
+    if(!reader_has(reader, WIRE_COLOR_SIZE + 2 + 4 + dimensions_bytes + 2))
+    {
+      return error(result_void, truncated);
+    }
+    color text_color = read_color(reader);
+    font_handle font = read_u16(reader);
+    point text_coordinates = read_point(reader);
+    text_dimensions dimensions = read_dimensions(reader, dimensions_bytes);
+    uint16 glyphs_count = read_u16(reader);
+    if(!reader_has(reader, (size_t)glyphs_count * WIRE_GLYPH_SIZE))
+    {
+      return error(result_void, truncated);
+    }
+
+    if(reader->glyphs_capacity < glyphs_count)
+    {
+      positioned_glyph* glyphs = (positioned_glyph*)realloc(
+        reader->glyphs, (size_t)glyphs_count * sizeof(positioned_glyph));
+      if(!glyphs)
+      {
+        return error(result_void, "Unable to allocate memory for glyphs!");
+      }
+      reader->glyphs = glyphs;
+      reader->glyphs_capacity = glyphs_count;
+    }
+    for(uint16 i = 0; i < glyphs_count; i++)
+    {
+      reader->glyphs[i].index = read_u32(reader);
+      reader->glyphs[i].x = read_f32(reader);
+      reader->glyphs[i].y = read_f32(reader);
+    }
+
+    return command_buffer_add_render_glyph_run_command(buffer,
+                                                       reader->glyphs,
+                                                       glyphs_count,
+                                                       font,
+                                                       text_color,
+                                                       text_coordinates,
+                                                       dimensions);
+  }
+  case PUSH_CLIP_RECT: {
+    if(!reader_has(reader, WIRE_RECT_SIZE))
+    {
+      return error(result_void, truncated);
+    }
+    cmd.data.clip_rect = read_rect(reader);
+    break;
+  }
+  default:
+    break;
+  }
+
+  return command_buffer_add_command(buffer, &cmd);
+}
+
+/// Unmaps the file of reader.
+static void reader_unmap(command_stream_reader* reader)
+{
+#ifdef _WIN32
+  if(reader->bytes)
+  {
+    UnmapViewOfFile(reader->bytes);
+  }
+  if(reader->mapping)
+  {
+    CloseHandle(reader->mapping);
+  }
+  if(reader->file != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(reader->file);
+  }
+#else
+  if(reader->bytes)
+  {
+    munmap((void*)reader->bytes, reader->size);
+  }
+#endif
+}
+
+/// Memory maps the file at `path` into reader.
+static result_void reader_map(command_stream_reader* reader, const char* path)
+{
+#ifdef _WIN32
+  reader->file = CreateFileA(path,
+                             GENERIC_READ,
+                             FILE_SHARE_READ,
+                             NULL,
+                             OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL,
+                             NULL);
+  if(reader->file == INVALID_HANDLE_VALUE)
+  {
+    return error(result_void, "Unable to open command stream file!");
+  }
+
+  LARGE_INTEGER size;
+  if(!GetFileSizeEx(reader->file, &size))
+  {
+    return error(result_void, "Unable to get size of command stream file!");
+  }
+  reader->size = (size_t)size.QuadPart;
+
+  reader->mapping =
+    CreateFileMappingA(reader->file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if(!reader->mapping)
+  {
+    return error(result_void, "Unable to map command stream file!");
+  }
+
+  reader->bytes =
+    (const uint8*)MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, 0);
+  if(!reader->bytes)
+  {
+    return error(result_void, "Unable to map command stream file!");
+  }
+#else
+  int fd = open(path, O_RDONLY);
+  if(fd < 0)
+  {
+    return error(result_void, "Unable to open command stream file!");
+  }
+
+  struct stat file_stat;
+  if(fstat(fd, &file_stat) != 0)
+  {
+    close(fd);
+    return error(result_void, "Unable to get size of command stream file!");
+  }
+  reader->size = (size_t)file_stat.st_size;
+
+  void* bytes = reader->size
+                  ? mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0)
+                  : MAP_FAILED;
+  close(fd);
+  if(bytes == MAP_FAILED)
+  {
+    return error(result_void, "Unable to map command stream file!");
+  }
+  reader->bytes = (const uint8*)bytes;
+#endif
+
+  return ok_void();
+}
+
+result_command_stream_reader_ptr command_stream_reader_open(const char* path)
+{
+  if(!path)
+  {
+    return error(result_command_stream_reader_ptr,
+                 "Cannot open command stream with NULL pointing path!");
+  }
+
+  command_stream_reader* reader =
+    (command_stream_reader*)calloc(1, sizeof(command_stream_reader));
+  if(!reader)
+  {
+    return error(result_command_stream_reader_ptr,
+                 "Unable to allocate memory for command stream reader!");
+  }
+
+#ifdef _WIN32
+  reader->file = INVALID_HANDLE_VALUE;
+#endif
+
+  result_void _ = reader_map(reader, path);
+  if(!_.ok)
+  {
+    reader_unmap(reader);
+    free(reader);
+    return error(result_command_stream_reader_ptr, _.error);
+  }
+
+  if(!reader_has(reader, COMMAND_STREAM_HEADER_SIZE) ||
+     memcmp(reader->bytes, COMMAND_STREAM_MAGIC, COMMAND_STREAM_MAGIC_SIZE))
+  {
+    reader_unmap(reader);
+    free(reader);
+    return error(result_command_stream_reader_ptr,
+                 "File is not a command stream!");
+  }
+
+  reader->offset = COMMAND_STREAM_MAGIC_SIZE;
+  uint16 version = read_u16(reader);
+  read_u16(reader); // flags, none defined yet
+  if(version < 1 || version > COMMAND_STREAM_VERSION)
+  {
+    reader_unmap(reader);
+    free(reader);
+    return error(result_command_stream_reader_ptr,
+                 "Unsupported version of command stream!");
+  }
+  reader->version = version;
+
+  return ok(result_command_stream_reader_ptr, reader);
+}
+
+result_bool command_stream_reader_read_frame(command_stream_reader* reader,
+                                             command_buffer* buffer,
+                                             uint64* timestamp_ns)
+{
+  if(!reader)
+  {
+    return error(result_bool,
+                 "Cannot read frame from NULL pointed command stream reader!");
+  }
+
+  if(!buffer)
+  {
+    return error(result_bool,
+                 "Cannot read frame into NULL pointed command buffer!");
+  }
+
+  if(reader->offset == reader->size)
+  {
+    return ok(result_bool, false);
+  }
+
+  if(!reader_has(reader, 1 + 8 + 4))
+  {
+    return error(result_bool, "Command stream is truncated!");
+  }
+
+  if(read_u8(reader) != COMMAND_STREAM_FRAME_TAG)
+  {
+    return error(result_bool, "Command stream has invalid frame record!");
+  }
+
+  uint64 timestamp = read_u64(reader);
+  uint32 commands_count = read_u32(reader);
+
+  result_void _ = command_buffer_clear_commands(buffer);
+  if(!_.ok)
+  {
+    return error(result_bool, _.error);
+  }
+
+  for(uint32 i = 0; i < commands_count; i++)
+  {
+    _ = reader_decode_command(reader, buffer);
+    if(!_.ok)
+    {
+      return error(result_bool, _.error);
+    }
+  }
+
+  if(timestamp_ns)
+  {
+    *timestamp_ns = timestamp;
+  }
+
+  return ok(result_bool, true);
+}
+
+result_void command_stream_reader_rewind(command_stream_reader* reader)
+{
+  if(!reader)
+  {
+    return error(result_void,
+                 "Cannot rewind NULL pointed command stream reader!");
+  }
+
+  reader->offset = COMMAND_STREAM_HEADER_SIZE;
+
+  return ok_void();
+}
+
+result_void command_stream_reader_close(command_stream_reader* reader)
+{
+  if(!reader)
+  {
+    return error(result_void,
+                 "Attempt to close a NULL pointed command stream reader!");
+  }
+
+  reader_unmap(reader);
+  free(reader->text);
+  free(reader->rects);
+  free(reader->glyphs);
+  free(reader);
+
+  return ok_void();
+}
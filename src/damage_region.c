@@ -0,0 +1,287 @@
+#include "../include/damage_region.h"
+#include <stdlib.h>
+#include "../include/macros.h"
+
+struct damage_region
+{
+  rect rects[DAMAGE_REGION_RECTS_MAX];
+  uint16 rects_count;
+
+  /// Damaged rects are clamped to this rect.
+  rect viewport;
+};
+
+static bool rect_is_empty(rect r)
+{
+  return r.w == 0 || r.h == 0;
+}
+
+/// Intersection of two rects, gives empty rect if they don't intersect.
+static rect rect_intersect(rect a, rect b)
+{
+  int32 x1 = max((int32)a.x, (int32)b.x);
+  int32 y1 = max((int32)a.y, (int32)b.y);
+  int32 x2 = min((int32)a.x + a.w, (int32)b.x + b.w);
+  int32 y2 = min((int32)a.y + a.h, (int32)b.y + b.h);
+
+  if(x2 <= x1 || y2 <= y1)
+  {
+    return (rect){.x = 0, .y = 0, .w = 0, .h = 0};
+  }
+
+  return (rect){.x = (int16)x1,
+                .y = (int16)y1,
+                .w = (uint16)(x2 - x1),
+                .h = (uint16)(y2 - y1)};
+}
+
+/// Smallest rect containing both rects.
+/// Rects are within viewport, so the union fits in a rect.
+static rect rect_union(rect a, rect b)
+{
+  int32 x1 = min((int32)a.x, (int32)b.x);
+  int32 y1 = min((int32)a.y, (int32)b.y);
+  int32 x2 = max((int32)a.x + a.w, (int32)b.x + b.w);
+  int32 y2 = max((int32)a.y + a.h, (int32)b.y + b.h);
+
+  return (rect){.x = (int16)x1,
+                .y = (int16)y1,
+                .w = (uint16)(x2 - x1),
+                .h = (uint16)(y2 - y1)};
+}
+
+static bool rect_contains(rect outer, rect inner)
+{
+  return (int32)outer.x <= (int32)inner.x &&
+         (int32)outer.y <= (int32)inner.y &&
+         (int32)inner.x + inner.w <= (int32)outer.x + outer.w &&
+         (int32)inner.y + inner.h <= (int32)outer.y + outer.h;
+}
+
+static uint64 rect_area(rect r)
+{
+  return (uint64)r.w * r.h;
+}
+
+/// Grows rect by `amount` pixels on every side.
+static rect rect_grow(rect r, uint16 amount)
+{
+  int32 x1 = max((int32)r.x - amount, INT16_MIN);
+  int32 y1 = max((int32)r.y - amount, INT16_MIN);
+  int32 x2 = min((int32)r.x + r.w + amount, INT16_MAX);
+  int32 y2 = min((int32)r.y + r.h + amount, INT16_MAX);
+
+  return (rect){.x = (int16)x1,
+                .y = (int16)y1,
+                .w = (uint16)max(x2 - x1, 0),
+                .h = (uint16)max(y2 - y1, 0)};
+}
+
+result_damage_region_ptr damage_region_new()
+{
+  damage_region* region = (damage_region*)calloc(1, sizeof(damage_region));
+  if(!region)
+  {
+    return error(result_damage_region_ptr,
+                 "Unable to allocate memory for damage region!");
+  }
+
+  return ok(result_damage_region_ptr, region);
+}
+
+result_void damage_region_free(damage_region* region)
+{
+  if(!region)
+  {
+    return error(result_void, "Attempt to free a NULL pointed damage region!");
+  }
+
+  free(region);
+
+  return ok_void();
+}
+
+result_void damage_region_reset(damage_region* region,
+                                uint16 viewport_width,
+                                uint16 viewport_height)
+{
+  if(!region)
+  {
+    return error(result_void, "Cannot reset NULL pointed damage region!");
+  }
+
+  region->rects_count = 0;
+  region->viewport =
+    (rect){.x = 0, .y = 0, .w = viewport_width, .h = viewport_height};
+
+  return ok_void();
+}
+
+/// Adds rect, which is already clamped to viewport, merging it with
+/// damaged rects whose union doesn't damage more area than both of them.
+static void damage_region_merge_rect(damage_region* region, rect r)
+{
+  bool merged = true;
+  while(merged)
+  {
+    merged = false;
+    for(uint16 i = 0; i < region->rects_count; i++)
+    {
+      rect damaged = region->rects[i];
+      if(rect_contains(damaged, r))
+      {
+        return;
+      }
+
+      rect merged_rect = rect_union(damaged, r);
+      if(rect_area(merged_rect) > rect_area(damaged) + rect_area(r))
+      {
+        continue;
+      }
+
+      // taking damaged rect out, merged rect may now merge with others
+      region->rects[i] = region->rects[--region->rects_count];
+      r = merged_rect;
+      merged = true;
+      break;
+    }
+  }
+
+  if(region->rects_count == DAMAGE_REGION_RECTS_MAX)
+  {
+    // too many rects, collapsing into one bounding rect
+    for(uint16 i = 0; i < region->rects_count; i++)
+    {
+      r = rect_union(r, region->rects[i]);
+    }
+    region->rects_count = 0;
+  }
+
+  region->rects[region->rects_count++] = r;
+}
+
+result_void damage_region_add_rect(damage_region* region, rect damaged_rect)
+{
+  if(!region)
+  {
+    return error(result_void, "Cannot add rect to NULL pointed damage region!");
+  }
+
+  rect r = rect_intersect(damaged_rect, region->viewport);
+  if(!rect_is_empty(r))
+  {
+    damage_region_merge_rect(region, r);
+  }
+
+  return ok_void();
+}
+
+result_void damage_region_add_command_buffer(damage_region* region,
+                                             const command_buffer* cmd_buffer)
+{
+  if(!region)
+  {
+    return error(result_void,
+                 "Cannot add command buffer to NULL pointed damage region!");
+  }
+
+  if(!cmd_buffer)
+  {
+    return error(result_void,
+                 "Cannot add NULL pointed command buffer to damage region!");
+  }
+
+  rect clip = region->viewport;
+
+  uint32 length = command_buffer_length(cmd_buffer);
+  for(uint32 i = 0; i < length; i++)
+  {
+    const command* cmd = command_buffer_get_command(cmd_buffer, i);
+    switch(cmd->type)
+    {
+    case RENDER_RECT: {
+      damage_region_add_rect(
+        region, rect_intersect(cmd->data.render_rect.bounding_rect, clip));
+      break;
+    }
+    case RENDER_ROUNDED_RECT: {
+      damage_region_add_rect(
+        region,
+        rect_intersect(cmd->data.render_rounded_rect.bounding_rect, clip));
+      break;
+    }
+    case RENDER_RECT_OUTLINED: {
+      // stroke is centered on the edges of rect
+      rect bounds = rect_grow(cmd->data.render_rect.bounding_rect, 1);
+      damage_region_add_rect(region, rect_intersect(bounds, clip));
+      break;
+    }
+    case RENDER_RECTS: {
+      const render_rects_data* data = &cmd->data.render_rects;
+      for(uint16 j = 0; j < data->rects_count; j++)
+      {
+        damage_region_add_rect(region, rect_intersect(data->rects[j], clip));
+      }
+      break;
+    }
+    case RENDER_LINE: {
+      point begin = cmd->data.render_line.begin;
+      point end = cmd->data.render_line.end;
+      rect bounds = {.x = min(begin.x, end.x),
+                     .y = min(begin.y, end.y),
+                     .w = (uint16)(abs(end.x - begin.x) + 1),
+                     .h = (uint16)(abs(end.y - begin.y) + 1)};
+      damage_region_add_rect(region,
+                             rect_intersect(rect_grow(bounds, 1), clip));
+      break;
+    }
+    case RENDER_TEXT:
+    case RENDER_GLYPH_RUN: {
+      rect bounds;
+      if(command_text_rect(cmd, &bounds))
+      {
+        damage_region_add_rect(region, rect_intersect(bounds, clip));
+        break;
+      }
+
+      // dimensions of text are not known, text is within the clip rect
+      point text_coordinates =
+        cmd->type == RENDER_TEXT ? cmd->data.render_text.text_coordinates
+                                 : cmd->data.render_glyph_run.text_coordinates;
+      int32 x2 = (int32)clip.x + clip.w;
+      int32 y2 = (int32)clip.y + clip.h;
+      bounds = (rect){
+        .x = text_coordinates.x,
+        .y = text_coordinates.y,
+        .w = (uint16)max(x2 - (int32)text_coordinates.x, 0),
+        .h = (uint16)max(y2 - (int32)text_coordinates.y, 0)};
+      damage_region_add_rect(region, rect_intersect(bounds, clip));
+      break;
+    }
+    case PUSH_CLIP_RECT:
+    case POP_CLIP_RECT: {
+      // clip commands carry the clip rect active after them
+      clip = rect_intersect(cmd->data.clip_rect, region->viewport);
+      break;
+    }
+    case CLEAR_WINDOW: {
+      damage_region_add_rect(region, region->viewport);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  return ok_void();
+}
+
+damage_span damage_region_get_rects(const damage_region* region)
+{
+  if(!region)
+  {
+    return (damage_span){.rects = NULL, .length = 0};
+  }
+
+  return (damage_span){.rects = region->rects, .length = region->rects_count};
+}
@@ -0,0 +1,163 @@
+#include "../include/geometry_store.h"
+#include <stdlib.h>
+#include "../include/base_widget.h"
+#include "../include/macros.h"
+
+/// @brief Grows array to capacity, leaving it as it is on failure.
+/// @return `false` if there is no memory for growing it.
+static bool grow_array(void** array, uint32 capacity, size_t element_size)
+{
+  void* grown = realloc(*array, capacity * element_size);
+  if(!grown)
+  {
+    return false;
+  }
+  *array = grown;
+
+  return true;
+}
+
+/// @brief Grows all arrays of store to capacity. Arrays grown before one
+///        fails to grow are left larger than capacity of store.
+static bool grow_arrays(geometry_store* store, uint32 capacity)
+{
+  return grow_array((void**)&store->x, capacity, sizeof(int32)) &&
+         grow_array((void**)&store->y, capacity, sizeof(int32)) &&
+         grow_array((void**)&store->w, capacity, sizeof(uint32)) &&
+         grow_array((void**)&store->h, capacity, sizeof(uint32)) &&
+         grow_array((void**)&store->visible, capacity, sizeof(bool)) &&
+         grow_array((void**)&store->flex_grow, capacity, sizeof(uint8)) &&
+         grow_array((void**)&store->flex_shrink, capacity, sizeof(uint8)) &&
+         grow_array(
+           (void**)&store->cross_axis_sizing, capacity, sizeof(uint8)) &&
+         grow_array(
+           (void**)&store->widgets, capacity, sizeof(base_widget*)) &&
+         grow_array((void**)&store->free_ids, capacity, sizeof(uint32));
+}
+
+static void free_arrays(geometry_store* store)
+{
+  free(store->x);
+  free(store->y);
+  free(store->w);
+  free(store->h);
+  free(store->visible);
+  free(store->flex_grow);
+  free(store->flex_shrink);
+  free(store->cross_axis_sizing);
+  free(store->widgets);
+  free(store->free_ids);
+}
+
+/// @brief Drops a reference to store, freeing it with the last one.
+static void unreference(geometry_store* store)
+{
+  if(--store->references)
+  {
+    return;
+  }
+
+  free_arrays(store);
+  free(store);
+}
+
+result_geometry_store_ptr geometry_store_new(uint32 capacity)
+{
+  geometry_store* store = (geometry_store*)calloc(1, sizeof(geometry_store));
+  if(!store)
+  {
+    return error(result_geometry_store_ptr,
+                 "Unable to allocate memory for geometry store!");
+  }
+
+  capacity = max(capacity, 1);
+  if(!grow_arrays(store, capacity))
+  {
+    free_arrays(store);
+    free(store);
+    return error(result_geometry_store_ptr,
+                 "Unable to allocate memory for geometry store!");
+  }
+  store->capacity = capacity;
+  store->references = 1;
+
+  return ok(result_geometry_store_ptr, store);
+}
+
+void geometry_store_free(geometry_store* store)
+{
+  if(store)
+  {
+    unreference(store);
+  }
+}
+
+result_void geometry_store_reserve(geometry_store* store, uint32 count)
+{
+  // free ids are given out before new ones
+  uint32 needed = store->count + count -
+                  min(count, store->free_ids_count);
+  if(needed <= store->capacity)
+  {
+    return ok_void();
+  }
+
+  uint32 capacity = max(store->capacity * 2, needed);
+  if(!grow_arrays(store, capacity))
+  {
+    return error(result_void,
+                 "Unable to allocate memory for growing geometry store!");
+  }
+  store->capacity = capacity;
+
+  return ok_void();
+}
+
+result_uint32 geometry_store_acquire(geometry_store* store,
+                                     base_widget* widget)
+{
+  result_void _ = geometry_store_reserve(store, 1);
+  if(!_.ok)
+  {
+    return error(result_uint32, _.error);
+  }
+
+  uint32 id = store->free_ids_count ? store->free_ids[--store->free_ids_count]
+                                    : store->count++;
+
+  store->x[id] = 0;
+  store->y[id] = 0;
+  store->w[id] = 0;
+  store->h[id] = 0;
+  store->visible[id] = true;
+  store->flex_grow[id] = 0;
+  store->flex_shrink[id] = 0;
+  store->cross_axis_sizing[id] = CROSS_AXIS_SIZING_FIT_CONTENT;
+  store->widgets[id] = widget;
+  store->references++;
+
+  return ok(result_uint32, id);
+}
+
+void geometry_store_release(geometry_store* store, uint32 id)
+{
+  store->widgets[id] = NULL;
+  store->free_ids[store->free_ids_count++] = id;
+
+  unreference(store);
+}
+
+void geometry_store_copy(geometry_store* to,
+                         uint32 to_id,
+                         const geometry_store* from,
+                         uint32 from_id)
+{
+  to->x[to_id] = from->x[from_id];
+  to->y[to_id] = from->y[from_id];
+  to->w[to_id] = from->w[from_id];
+  to->h[to_id] = from->h[from_id];
+  to->visible[to_id] = from->visible[from_id];
+  to->flex_grow[to_id] = from->flex_grow[from_id];
+  to->flex_shrink[to_id] = from->flex_shrink[from_id];
+  to->cross_axis_sizing[to_id] = from->cross_axis_sizing[from_id];
+}
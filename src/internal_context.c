@@ -1,8 +1,13 @@
 #include <stdlib.h>
+#include <string.h>
 #include "../include/base_widget.h"
 #include "../include/command_buffer.h"
 #include "../include/macros.h"
 
+#define UPDATE_QUEUE_INITIAL_CAPACITY 64
+#define TEXT_BATCH_INITIAL_CAPACITY 64
+#define GEOMETRY_STORE_INITIAL_CAPACITY 256
+
 result_internal_context_ptr internal_context_create(uint16 viewport_width,
                                                     uint16 viewport_height)
 {
@@ -23,14 +28,18 @@ result_internal_context_ptr internal_context_create(uint16 viewport_width,
   context->viewport_w = viewport_width;
   context->viewport_h = viewport_height;
 
+  // widgets are created with generation 0, so they derive their position
+  context->position_generation = 1;
+  context->parallel_relayout = false;
+
   context->root = NULL;
   context->overlay_widget = NULL;
   context->active_draggable_widget = NULL;
   context->keyboard_focused_widget = NULL;
   context->mouse_focused_widget = NULL;
 
-  context->font = NULL;
-  context->font_size = 0;
+  context->fonts = NULL;
+  context->fonts_count = 0;
 
   // creating command buffer
   result_command_buffer_ptr _ = command_buffer_new();
@@ -40,6 +49,26 @@ result_internal_context_ptr internal_context_create(uint16 viewport_width,
   }
   context->cmd_buffer = _.value;
 
+  result_text_cache_ptr __ = text_cache_new();
+  if(!__.ok)
+  {
+    command_buffer_free(context->cmd_buffer);
+    free(context);
+    return error(result_internal_context_ptr, __.error);
+  }
+  context->text_cache = __.value;
+
+  result_geometry_store_ptr store =
+    geometry_store_new(GEOMETRY_STORE_INITIAL_CAPACITY);
+  if(!store.ok)
+  {
+    text_cache_free(context->text_cache);
+    command_buffer_free(context->cmd_buffer);
+    free(context);
+    return error(result_internal_context_ptr, store.error);
+  }
+  context->geometry = store.value;
+
   context->backend = NULL;
 
   return ok(result_internal_context_ptr, context);
@@ -52,67 +81,656 @@ result_void recursively_free_ui_tree(base_widget* root)
     return error(result_void, "Attempt to free a NULL pointed base widget!");
   }
 
-  if(root->children_head)
+  // tree is freed iteratively, along with children nodes
+  common_internal_free(root);
+
+  return ok_void();
+}
+
+/// @brief Frees name & glyph table of registered font.
+static void free_font(registered_font* font)
+{
+  free(font->name);
+  free(font->glyph_table);
+  *font = (registered_font){0};
+}
+
+result_void internal_context_destroy(internal_context* context)
+{
+  if(!context)
+  {
+    return error(result_void,
+                 "Attempt to free a NULL pointed internal context!");
+  }
+
+  // ignoring errors while freeing UI tree
+  common_internal_free(context->root);
+
+  for(uint32 i = 0; i < context->fonts_count; i++)
+  {
+    free_font(&context->fonts[i]);
+  }
+  free(context->fonts);
+
+  // ignoring errors while freeing comand buffer & text cache
+  result_void _ = command_buffer_free(context->cmd_buffer);
+  _ = text_cache_free(context->text_cache);
+
+  // widgets of context which are not in UI tree, still live in its store
+  geometry_store_free(context->geometry);
+
+  free(context->traversal_stack.frames);
+  free(context->update_queue.widgets);
+  free(context->text_batch.entries);
+  free(context->text_batch.texts);
+  free(context->text_batch.dimensions);
+  free(context->render_records);
+  free(context->command_owners);
+  free(context->removed_commands);
+
+  if(context->layout_pool)
+  {
+    thread_pool_free(context->layout_pool);
+  }
+
+  free(context);
+
+  return ok_void();
+}
+
+result_void internal_context_queue_update(internal_context* context,
+                                          base_widget* widget,
+                                          uint8 updates)
+{
+  if(widget->pending_updates)
   {
-    base_widget_child_node* prev_node = root->children_head;
-    base_widget_child_node* node = prev_node->next;
-    while(node)
+    // widget is already queued, updates are merged
+    widget->pending_updates |= updates;
+    return ok_void();
+  }
+
+  update_queue* queue = &context->update_queue;
+  if(queue->count == queue->capacity)
+  {
+    uint32 capacity =
+      queue->capacity ? queue->capacity * 2 : UPDATE_QUEUE_INITIAL_CAPACITY;
+    base_widget** widgets = (base_widget**)realloc(
+      queue->widgets, capacity * sizeof(base_widget*));
+    if(!widgets)
     {
-      result_void _ = recursively_free_ui_tree(prev_node->child);
-      if(!_.ok)
+      return error(result_void, "Unable to allocate memory for update queue!");
+    }
+    queue->widgets = widgets;
+    queue->capacity = capacity;
+  }
+
+  widget->update_queue_index = queue->count;
+  widget->pending_updates = updates;
+  queue->widgets[queue->count++] = widget;
+
+  return ok_void();
+}
+
+void internal_context_dequeue_update(internal_context* context,
+                                     base_widget* widget)
+{
+  if(!widget->pending_updates)
+  {
+    return;
+  }
+
+  // leaving a hole, as the queue may be being run
+  context->update_queue.widgets[widget->update_queue_index] = NULL;
+  widget->pending_updates = PENDING_UPDATE_NONE;
+}
+
+/// @brief Tells if an ancestor of widget has any of the pending updates.
+static bool ancestor_has_pending_updates(const base_widget* widget,
+                                         uint8 updates)
+{
+  const base_widget* ancestor = widget->parent;
+  while(ancestor)
+  {
+    if(ancestor->pending_updates & updates)
+    {
+      return true;
+    }
+    ancestor = ancestor->parent;
+  }
+
+  return false;
+}
+
+/// @brief Tells if widget is in UI tree of context, widgets removed from
+///        tree after being queued are not updated.
+static bool is_in_ui_tree(const internal_context* context,
+                          const base_widget* widget)
+{
+  while(widget->parent)
+  {
+    widget = widget->parent;
+  }
+
+  return widget == context->root;
+}
+
+/// @brief Measures texts of the first `count` queued widgets which are to be
+///        fit, in one batch.
+static void measure_queued_texts(internal_context* context, uint32 count)
+{
+  update_queue* queue = &context->update_queue;
+  for(uint32 i = 0; i < count; i++)
+  {
+    base_widget* widget = queue->widgets[i];
+    if(widget && (widget->pending_updates & PENDING_UPDATE_LAYOUT))
+    {
+      // ignoring errors, texts left out are measured while fitting
+      result_void _ = common_internal_batch_text(widget);
+      (void)_;
+    }
+  }
+
+  result_void _ = internal_context_measure_batched_texts(context);
+  (void)_;
+}
+
+/// @brief Fits widgets queued for layout to their content, and queues the
+///        subtrees which have to be laid out again.
+static result_void fit_queued_widgets(internal_context* context)
+{
+  update_queue* queue = &context->update_queue;
+
+  // subtrees queued meanwhile are already fit
+  uint32 count = queue->count;
+  measure_queued_texts(context, count);
+
+  for(uint32 i = 0; i < count; i++)
+  {
+    base_widget* widget = queue->widgets[i];
+    if(!widget || !(widget->pending_updates & PENDING_UPDATE_LAYOUT) ||
+       !is_in_ui_tree(context, widget))
+    {
+      continue;
+    }
+
+    result_base_widget_ptr _ = common_internal_fit_to_content(widget);
+    if(!_.ok)
+    {
+      return error(result_void, _.error);
+    }
+
+    // widget is laid out again even if its size didn't change, as its
+    // children (or) their arrangement may have changed
+    base_widget* subtree = _.value ? _.value : widget;
+
+    // marking ancestors too, so laying out an enclosing subtree reaches it
+    common_internal_mark_layout_dirty(subtree);
+
+    result_void __ =
+      internal_context_queue_update(context, subtree, PENDING_UPDATE_RELAYOUT);
+    if(!__.ok)
+    {
+      return __;
+    }
+  }
+
+  return ok_void();
+}
+
+result_void internal_context_update(internal_context* context)
+{
+  update_queue* queue = &context->update_queue;
+  if(context->updating || !queue->count)
+  {
+    return ok_void();
+  }
+
+  context->updating = true;
+
+  result_void _ = fit_queued_widgets(context);
+
+  // laying out subtrees, except those enclosed by another one
+  for(uint32 i = 0; _.ok && i < queue->count; i++)
+  {
+    base_widget* widget = queue->widgets[i];
+    if(!widget || !(widget->pending_updates & PENDING_UPDATE_RELAYOUT) ||
+       ancestor_has_pending_updates(widget, PENDING_UPDATE_RELAYOUT))
+    {
+      continue;
+    }
+
+    _ = common_internal_update_layout(widget);
+  }
+
+  // rendering laid out subtrees & widgets queued for render, except those
+  // enclosed by another one
+  uint8 render_updates = PENDING_UPDATE_RELAYOUT | PENDING_UPDATE_RENDER;
+  for(uint32 i = 0; _.ok && i < queue->count; i++)
+  {
+    base_widget* widget = queue->widgets[i];
+    if(!widget || !(widget->pending_updates & render_updates) ||
+       ancestor_has_pending_updates(widget, render_updates) ||
+       !is_in_ui_tree(context, widget))
+    {
+      continue;
+    }
+
+    result_bool __ = common_internal_render(widget);
+    if(!__.ok)
+    {
+      _ = error(result_void, __.error);
+    }
+  }
+
+  // updates are dropped on error too, queue would keep failing otherwise
+  for(uint32 i = 0; i < queue->count; i++)
+  {
+    if(queue->widgets[i])
+    {
+      queue->widgets[i]->pending_updates = PENDING_UPDATE_NONE;
+    }
+  }
+  queue->count = 0;
+
+  context->updating = false;
+
+  return _;
+}
+
+/// @brief Texts measured before are stale, they are measured again.
+static void invalidate_measured_texts(internal_context* context)
+{
+  context->font_generation++;
+  text_cache_clear(context->text_cache);
+}
+
+result_void internal_context_set_font(internal_context* context,
+                                      font_handle font,
+                                      const char* font_name,
+                                      uint8 font_size)
+{
+  if(!font_name)
+  {
+    return error(result_void, "Cannot register NULL pointing font!");
+  }
+
+  if(font >= context->fonts_count)
+  {
+    uint32 count = (uint32)font + 1;
+    registered_font* fonts = (registered_font*)realloc(
+      context->fonts, count * sizeof(registered_font));
+    if(!fonts)
+    {
+      return error(result_void, "Unable to allocate memory for fonts!");
+    }
+    memset(fonts + context->fonts_count,
+           0,
+           (count - context->fonts_count) * sizeof(registered_font));
+    context->fonts = fonts;
+    context->fonts_count = count;
+  }
+
+  char* name = strdup(font_name);
+  if(!name)
+  {
+    return error(result_void, "Unable to make a copy of font!");
+  }
+
+  registered_font* registered = &context->fonts[font];
+  if(registered->name)
+  {
+    // content measured with the replaced font is stale
+    free_font(registered);
+    invalidate_measured_texts(context);
+  }
+  registered->name = name;
+  registered->size = font_size;
+
+  if(!context->backend)
+  {
+    return ok_void();
+  }
+
+  return context->backend->load_font(font, font_name, font_size);
+}
+
+result_void internal_context_load_fonts(internal_context* context)
+{
+  invalidate_measured_texts(context);
+
+  result_void _ = ok_void();
+  for(uint32 i = 0; i < context->fonts_count; i++)
+  {
+    registered_font* font = &context->fonts[i];
+    font->glyph_table_requested = false;
+    font->glyph_table_valid = false;
+
+    if(font->name && context->backend)
+    {
+      result_void __ =
+        context->backend->load_font((font_handle)i, font->name, font->size);
+      if(!__.ok)
       {
-        return _;
+        // loading rest of fonts anyway
+        _ = __;
       }
-      _ = base_widget_child_node_free(prev_node);
-      if(!_.ok)
+    }
+  }
+
+  return _;
+}
+
+/// @brief Gives registered font of handle.
+/// @return Registered font, `NULL` if no font is registered under handle.
+static registered_font* get_font(internal_context* context, font_handle font)
+{
+  if(font >= context->fonts_count || !context->fonts[font].name)
+  {
+    return NULL;
+  }
+
+  return &context->fonts[font];
+}
+
+/// @brief Gives glyph table of font, requesting it from backend if font (or)
+///        backend has changed since it was last requested.
+/// @return Glyph table, `NULL` if backend doesn't give glyph tables.
+static const glyph_table* get_glyph_table(internal_context* context,
+                                          font_handle font)
+{
+  registered_font* registered = get_font(context, font);
+  if(!registered)
+  {
+    return NULL;
+  }
+
+  if(!registered->glyph_table_requested)
+  {
+    registered->glyph_table_requested = true;
+    registered->glyph_table_valid = false;
+
+    if(!context->backend->get_glyph_table)
+    {
+      return NULL;
+    }
+
+    if(!registered->glyph_table)
+    {
+      registered->glyph_table = (glyph_table*)malloc(sizeof(glyph_table));
+      if(!registered->glyph_table)
       {
-        return _;
+        return NULL;
       }
-      prev_node = node;
-      node = node->next;
     }
-    result_void _ = recursively_free_ui_tree(prev_node->child);
-    if(!_.ok)
+
+    result_void _ =
+      context->backend->get_glyph_table(font, registered->glyph_table);
+    registered->glyph_table_valid = _.ok;
+  }
+
+  return registered->glyph_table_valid ? registered->glyph_table : NULL;
+}
+
+/// @brief Measures text with glyph table of font, if text is made of ASCII &
+///        Latin-1 codepoints only.
+/// @return `true` if text is measured, else `false`.
+static bool measure_with_glyph_table(internal_context* context,
+                                     const char* text,
+                                     font_handle font,
+                                     text_dimensions* dimensions)
+{
+  const glyph_table* table = get_glyph_table(context, font);
+  if(!table)
+  {
+    return false;
+  }
+
+  // ink of text spans from left edge of its leftmost inked glyph, to right
+  // edge of its rightmost one, same as extents given by backend
+  float64 pen = 0.0;
+  float64 ink_left = 0.0, ink_right = 0.0;
+  bool has_ink = false;
+
+  const uint8* c = (const uint8*)text;
+  while(*c)
+  {
+    uint8 codepoint = *c++;
+    if(codepoint >= 0x80)
     {
-      return _;
+      // Latin-1 codepoints are 2 bytes long in UTF-8, led by 0xC2 (or) 0xC3
+      if((codepoint != 0xC2 && codepoint != 0xC3) || (*c & 0xC0) != 0x80)
+      {
+        return false;
+      }
+      codepoint = (uint8)(((codepoint & 0x03) << 6) | (*c++ & 0x3F));
     }
-    _ = base_widget_child_node_free(prev_node);
-    if(!_.ok)
+
+    float64 ink_width = table->ink_widths[codepoint];
+    if(ink_width > 0.0)
     {
-      return _;
+      float64 left = pen + table->ink_lefts[codepoint];
+      float64 right = left + ink_width;
+      ink_left = has_ink ? min(ink_left, left) : left;
+      ink_right = has_ink ? max(ink_right, right) : right;
+      has_ink = true;
     }
+    pen += table->advances[codepoint];
   }
 
-  result_void _ = base_widget_free(root);
+  float64 width = has_ink ? ink_right - ink_left : 0.0;
+  *dimensions = (text_dimensions){.w = (uint16)width, .h = table->height};
+
+  return true;
+}
+
+result_text_dimensions internal_context_measure_text(internal_context* context,
+                                                     const char* text,
+                                                     font_handle font)
+{
+  if(!get_font(context, font))
+  {
+    return error(result_text_dimensions,
+                 "Cannot measure text with a font which isn't registered!");
+  }
+
+  text_dimensions dimensions;
+  if(measure_with_glyph_table(context, text, font, &dimensions))
+  {
+    return ok(result_text_dimensions, dimensions);
+  }
+
+  if(text_cache_lookup(context->text_cache, text, font, &dimensions))
+  {
+    return ok(result_text_dimensions, dimensions);
+  }
+
+  result_text_dimensions _ =
+    context->backend->get_text_dimensions(text, font);
   if(!_.ok)
   {
     return _;
   }
 
+  // text is measured anyway if it can't be cached, so ignoring errors
+  result_void __ = text_cache_insert(context->text_cache, text, font, _.value);
+  (void)__;
+
+  return _;
+}
+
+result_void internal_context_batch_text(internal_context* context,
+                                        base_widget* widget,
+                                        const char* text,
+                                        font_handle font)
+{
+  if(!text || !context->backend || !context->backend->get_texts_dimensions ||
+     !get_font(context, font))
+  {
+    return ok_void();
+  }
+
+  // setting measured size now, as cached text may be evicted by the time
+  // widget is fit
+  text_dimensions dimensions;
+  if(measure_with_glyph_table(context, text, font, &dimensions) ||
+     text_cache_lookup(context->text_cache, text, font, &dimensions))
+  {
+    common_internal_set_measured_size(widget, dimensions);
+    return ok_void();
+  }
+
+  text_batch* batch = &context->text_batch;
+  if(batch->count == batch->capacity)
+  {
+    uint32 capacity =
+      batch->capacity ? batch->capacity * 2 : TEXT_BATCH_INITIAL_CAPACITY;
+    batched_text* entries =
+      (batched_text*)realloc(batch->entries, capacity * sizeof(batched_text));
+    if(!entries)
+    {
+      return error(result_void, "Unable to allocate memory for text batch!");
+    }
+    batch->entries = entries;
+
+    const char** texts =
+      (const char**)realloc(batch->texts, capacity * sizeof(const char*));
+    if(!texts)
+    {
+      return error(result_void, "Unable to allocate memory for text batch!");
+    }
+    batch->texts = texts;
+
+    text_dimensions* dimensions = (text_dimensions*)realloc(
+      batch->dimensions, capacity * sizeof(text_dimensions));
+    if(!dimensions)
+    {
+      return error(result_void, "Unable to allocate memory for text batch!");
+    }
+    batch->dimensions = dimensions;
+
+    batch->capacity = capacity;
+  }
+
+  batch->entries[batch->count++] =
+    (batched_text){.text = text, .font = font, .widget = widget};
+
   return ok_void();
 }
 
-result_void internal_context_destroy(internal_context* context)
+/// @brief Orders batched texts by font, then by text.
+static int compare_batched_texts(const void* a, const void* b)
 {
-  if(!context)
+  const batched_text* x = (const batched_text*)a;
+  const batched_text* y = (const batched_text*)b;
+  if(x->font != y->font)
   {
-    return error(result_void,
-                 "Attempt to free a NULL pointed internal context!");
+    return x->font < y->font ? -1 : 1;
   }
 
-  // ignoring errors while freeing UI tree
-  common_internal_free(context->root);
+  return strcmp(x->text, y->text);
+}
 
-  free(context->font);
+/// @brief Tells if batched text is the same as the one before it, in batch
+///        sorted with `compare_batched_texts()`.
+static bool is_duplicate_batched_text(const batched_text* entries, uint32 i)
+{
+  return i && entries[i].font == entries[i - 1].font &&
+         !strcmp(entries[i].text, entries[i - 1].text);
+}
 
-  // ignoring errors while freeing comand buffer
-  result_void _ = command_buffer_free(context->cmd_buffer);
+/// @brief Measures distinct texts of `count` sorted entries of a font, from
+///        `first`, in one call to backend. Sets their dimensions as measured
+///        sizes of widgets of entries, and caches them.
+static result_void measure_texts_of_font(internal_context* context,
+                                         uint32 first,
+                                         uint32 count)
+{
+  text_batch* batch = &context->text_batch;
+  font_handle font = batch->entries[first].font;
 
-  free(context);
+  // widgets often share texts, measuring each of them once
+  uint32 texts_count = 0;
+  for(uint32 i = first; i < first + count; i++)
+  {
+    if(!is_duplicate_batched_text(batch->entries, i))
+    {
+      batch->texts[texts_count++] = batch->entries[i].text;
+    }
+  }
+
+  result_void _ = context->backend->get_texts_dimensions(
+    batch->texts, texts_count, font, batch->dimensions);
+  if(!_.ok)
+  {
+    return _;
+  }
+
+  // widgets get their dimensions directly, as cache may not hold all texts
+  // of batch
+  uint32 text = 0;
+  for(uint32 i = first; i < first + count; i++)
+  {
+    if(i > first && !is_duplicate_batched_text(batch->entries, i))
+    {
+      text++;
+    }
+    common_internal_set_measured_size(batch->entries[i].widget,
+                                      batch->dimensions[text]);
+  }
+
+  for(uint32 i = 0; i < texts_count; i++)
+  {
+    // texts which can't be cached are measured again by their next widgets
+    _ = text_cache_insert(
+      context->text_cache, batch->texts[i], font, batch->dimensions[i]);
+  }
 
   return ok_void();
 }
 
+result_void internal_context_measure_batched_texts(internal_context* context)
+{
+  text_batch* batch = &context->text_batch;
+  uint32 batched_count = batch->count;
+  if(!batched_count)
+  {
+    return ok_void();
+  }
+  batch->count = 0;
+
+  // measuring texts of a font together, and each text once
+  qsort(batch->entries,
+        batched_count,
+        sizeof(batched_text),
+        compare_batched_texts);
+
+  result_void _ = ok_void();
+  uint32 first = 0;
+  for(uint32 i = 0; i < batched_count; i++)
+  {
+    bool last_of_font = i + 1 == batched_count ||
+                        batch->entries[i + 1].font != batch->entries[i].font;
+    if(last_of_font)
+    {
+      result_void __ = measure_texts_of_font(context, first, i + 1 - first);
+      if(!__.ok)
+      {
+        _ = __;
+      }
+      first = i + 1;
+    }
+  }
+
+  return _;
+}
+
+/// @brief Tells if bounding rect of widget encloses the point.
+static bool rect_encloses_point(rect bounds, uint16 x, uint16 y)
+{
+  return bounds.x <= x && x <= bounds.x + bounds.w && bounds.y <= y &&
+         y <= bounds.y + bounds.h;
+}
+
 result_bool widget_encloses_point(base_widget* widget, uint16 x, uint16 y)
 {
   if(!widget)
@@ -125,66 +743,87 @@ result_bool widget_encloses_point(base_widget* widget, uint16 x, uint16 y)
   // rect bounding_rect = widget->internal_get_bounding_rect_callback(widget);
   rect bounding_rect = common_internal_get_bounding_rect(widget);
 
-  return (result_bool){
-    .ok = true,
-    .value = (bounding_rect.x <= x && x <= bounding_rect.x + bounding_rect.w &&
-              bounding_rect.y <= y && y <= bounding_rect.y + bounding_rect.h)};
+  return (result_bool){.ok = true,
+                       .value = rect_encloses_point(bounding_rect, x, y)};
 }
 
-result_base_widget_ptr
-recursive_deepest_widget_with_point(base_widget* widget, uint16 x, uint16 y)
+/// @brief Gives first child of widget, from index `first` onwards, which
+///        encloses the point. Children are looped over by their ids, so
+///        children not enclosing the point are not visited.
+static result_base_widget_ptr
+first_child_with_point(base_widget* widget, uint32 first, uint16 x, uint16 y)
 {
-  if(!widget)
+  if(!common_internal_index_children(widget))
   {
     return error(result_base_widget_ptr,
-                 "Cannot get deepest child with given point, in a NULL "
-                 "pointing base widget!");
+                 "Unable to allocate memory for index of children!");
   }
 
-  result_bool _ = widget_encloses_point(widget, x, y);
-  if(!_.ok)
+  // children are positioned relative to origin of widget's children
+  virtual_point origin = common_internal_get_absolute_position(widget);
+  origin.x += widget->children_offset.x;
+  origin.y += widget->children_offset.y;
+
+  const geometry_store* store = widget->geometry;
+  for(uint32 i = first; i < widget->children_count; i++)
   {
-    return error(result_base_widget_ptr, _.error);
+    uint32 id = widget->children_index[i];
+    virtual_rect bounds = {.x = origin.x + store->x[id],
+                           .y = origin.y + store->y[id],
+                           .w = store->w[id],
+                           .h = store->h[id]};
+    if(rect_encloses_point(common_internal_clip_virtual_rect(bounds), x, y))
+    {
+      return ok(result_base_widget_ptr, store->widgets[id]);
+    }
+  }
+
+  return ok(result_base_widget_ptr, NULL);
+}
+
+/// @brief Gives index of child in children of its parent.
+static uint32 child_index(const base_widget* child)
+{
+  const base_widget* parent = child->parent;
+  uint32 i = 0;
+  while(parent->children_index[i] != child->geometry_id)
+  {
+    i++;
   }
 
-  // this case doesn't occur as we are checking the root,
-  // then call this recursive function.
-  // if(!_.value)
-  // {
-  //   // widget doesn't contain point
-  //   return error(result_base_widget_ptr, "Widget doesn't contain point, cannot get deepest child!");
-  // }
+  return i;
+}
 
-  if(!widget->children_head)
+/// @brief Gives deepest descendant of widget which encloses the point,
+///        descending into the first child enclosing it at every level.
+static result_base_widget_ptr
+deepest_widget_with_point(base_widget* widget, uint16 x, uint16 y)
+{
+  if(!widget)
   {
-    // as there are no children, we return this widget as the deepest
-    return ok(result_base_widget_ptr, widget);
+    return error(result_base_widget_ptr,
+                 "Cannot get deepest child with given point, in a NULL "
+                 "pointing base widget!");
   }
 
-  base_widget_child_node* node = widget->children_head;
-  while(node)
+  // widget is not checked for enclosing the point, as the root is checked
+  // before calling this function, and children are checked before
+  // descending into them.
+  while(1)
   {
-    result_bool _ = widget_encloses_point(node->child, x, y);
+    result_base_widget_ptr _ = first_child_with_point(widget, 0, x, y);
     if(!_.ok)
     {
-      return error(result_base_widget_ptr, _.error);
+      return _;
     }
-    if(_.value)
+    if(!_.value)
     {
-      result_base_widget_ptr __ =
-        recursive_deepest_widget_with_point(node->child, x, y);
-      if(!__.ok)
-      {
-        return __;
-      }
-      return ok(result_base_widget_ptr, __.value);
+      // none of the children contains the point
+      // so returning this widget as the deepest widget
+      return ok(result_base_widget_ptr, widget);
     }
-    node = node->next;
+    widget = _.value;
   }
-
-  // none of the children contains the point
-  // so returning this widget as the deepest widget
-  return ok(result_base_widget_ptr, widget);
 }
 
 result_base_widget_ptr internal_context_get_deepest_widget_with_point(
@@ -225,7 +864,7 @@ result_base_widget_ptr internal_context_get_deepest_widget_with_point(
     return ok(result_base_widget_ptr, context->root);
   }
 
-  return recursive_deepest_widget_with_point(context->root, x, y);
+  return deepest_widget_with_point(context->root, x, y);
 }
 
 result_bool widget_has_valid_mouse_motion_callbacks(base_widget* widget)
@@ -294,7 +933,11 @@ widget_has_valid_callback_for_even_type(base_widget* widget,
   return error(result_bool, "Unknown event type!");
 }
 
-result_base_widget_ptr recursive_deepest_widget_with_point_and_event_callbacks(
+/// @brief Gives deepest descendant of widget which encloses the point and
+///        has a callback for event type, `NULL` if there is none.
+///        Children enclosing the point are searched in order, backtracking
+///        through parent links when a child's subtree has no such widget.
+static result_base_widget_ptr deepest_widget_with_point_and_event_callbacks(
   base_widget* widget, uint16 x, uint16 y, internal_event_type event_type)
 {
   if(!widget)
@@ -304,60 +947,41 @@ result_base_widget_ptr recursive_deepest_widget_with_point_and_event_callbacks(
                  "pointing base widget!");
   }
 
-  result_bool _ = widget_encloses_point(widget, x, y);
-  if(!_.ok)
+  // widget is not checked for enclosing the point, as the root is checked
+  // before calling this function.
+  base_widget* root = widget;
+  uint32 first = 0;
+  while(1)
   {
-    return error(result_base_widget_ptr, _.error);
-  }
-
-  // this case doesn't occur as we are checking the root,
-  // then call this recursive function.
-  // if(!_.value)
-  // {
-  //   // widget doesn't contain point
-  //   return error(result_base_widget_ptr, "Widget doesn't contain point, cannot get deepest child!");
-  // }
-
-  if(!widget->children_head &&
-     widget_has_valid_callback_for_even_type(widget, event_type).value)
-  {
-    // as there are no children, we return this widget as the deepest
-    return ok(result_base_widget_ptr, widget);
-  }
-
-  base_widget_child_node* node = widget->children_head;
-  while(node)
-  {
-    result_bool _ = widget_encloses_point(node->child, x, y);
+    result_base_widget_ptr _ = first_child_with_point(widget, first, x, y);
     if(!_.ok)
     {
-      return error(result_base_widget_ptr, _.error);
+      return _;
     }
     if(_.value)
     {
-      result_base_widget_ptr __ =
-        recursive_deepest_widget_with_point_and_event_callbacks(
-          node->child, x, y, event_type);
-      if(!__.ok)
-      {
-        return __;
-      }
-      if(__.value)
-      {
-        return ok(result_base_widget_ptr, __.value);
-      }
+      // descending into child enclosing the point
+      widget = _.value;
+      first = 0;
+      continue;
     }
-    node = node->next;
-  }
 
-  // none of the children contains the point
+    // none of the remaining children has such widget, so it is this widget
+    // if it has a callback, else searching the remaining siblings
+    if(widget_has_valid_callback_for_even_type(widget, event_type).value)
+    {
+      return ok(result_base_widget_ptr, widget);
+    }
 
-  if(!widget_has_valid_callback_for_even_type(widget, event_type).value)
-  {
-    return ok(result_base_widget_ptr, NULL);
-  }
+    if(widget == root)
+    {
+      return ok(result_base_widget_ptr, NULL);
+    }
 
-  return ok(result_base_widget_ptr, widget);
+    // index of parent is valid, as it was searched for this widget
+    first = child_index(widget) + 1;
+    widget = widget->parent;
+  }
 }
 
 result_base_widget_ptr
@@ -395,7 +1019,7 @@ internal_context_get_deepest_widget_with_point_and_event_type(
   }
 
   // root contains the point
-  return recursive_deepest_widget_with_point_and_event_callbacks(
+  return deepest_widget_with_point_and_event_callbacks(
     context->root, x, y, event_type);
 }
 
@@ -4,8 +4,35 @@
 #include <string.h>
 #include "../include/backend.h"
 #include "../include/base_widget.h"
+#include "../include/command_stream.h"
 #include "../include/macros.h"
 
+#ifdef _MSC_VER
+#  include <intrin.h>
+typedef volatile long frame_state_t;
+#  define frame_state_load(state) _InterlockedOr((state), 0)
+#  define frame_state_store(state, value) _InterlockedExchange((state), (value))
+#else
+#  include <stdatomic.h>
+typedef atomic_int frame_state_t;
+#  define frame_state_load(state) atomic_load(state)
+#  define frame_state_store(state, value) atomic_store((state), (value))
+#endif
+
+/// @brief State of frame handoff between UI thread and render thread.
+typedef enum frame_state
+{
+  /// @brief No frame is submitted, submitted command buffer is owned by
+  ///        UI thread.
+  FRAME_FREE,
+
+  /// @brief Frame is submitted, waiting to be acquired by render thread.
+  FRAME_SUBMITTED,
+
+  /// @brief Frame is acquired, and being rendered by render thread.
+  FRAME_RENDERING
+} frame_state;
+
 /// @brief Smoll Context.
 ///        Acts as a wrapper for Internal Context.
 ///        Hides Internal Context from users, while all widgets can access
@@ -14,8 +41,89 @@ struct smoll_context
 {
   /// @brief Internal Context, the actual context which holds all data of UI.
   internal_context* internal_ctx;
+
+  /// @brief Command buffer of the frame submitted for rendering.
+  ///        Swapped with internal context's command buffer on submit.
+  command_buffer* submitted_cmd_buffer;
+
+  /// @brief State of submitted frame, one of `frame_state`.
+  frame_state_t frame_state;
+
+  /// @brief Whether occluded commands are culled before rendering.
+  bool occlusion_culling;
+
+  /// @brief Stats of the last occlusion culling pass.
+  command_culling_stats culling_stats;
+
+  /// @brief Whether commands are batched before rendering.
+  bool command_batching;
+
+  /// @brief Stats of the last batching pass.
+  command_batching_stats batching_stats;
+
+  /// @brief Stats of retained rendering, for the last prepared frame.
+  display_list_stats display_list_stats;
+
+  /// @brief Writer of command stream, while frames are being recorded.
+  command_stream_writer* recorder;
 };
 
+/// @brief Prepares context's command buffer to be rendered as a frame.
+///        Records the frame if recording, then culls occluded commands and
+///        batches commands, if these passes are enabled.
+/// @param context pointer to smoll context.
+/// @return Void result.
+static result_void smoll_context_prepare_frame(smoll_context* context)
+{
+  command_buffer* cmd_buffer = context->internal_ctx->cmd_buffer;
+
+  // display lists are diffed as widgets render, taking stats of this frame
+  context->display_list_stats = context->internal_ctx->display_list_stats;
+  context->internal_ctx->display_list_stats = (display_list_stats){0};
+
+  if(context->recorder)
+  {
+    // recording commands as widgets produced them, so optimization passes
+    // can be benchmarked on replays
+    result_void _ =
+      command_stream_writer_write_frame(context->recorder, cmd_buffer);
+    if(!_.ok)
+    {
+      return _;
+    }
+  }
+
+  if(context->occlusion_culling)
+  {
+    result_command_culling_stats _ =
+      command_buffer_cull_occluded_commands(cmd_buffer);
+    if(!_.ok)
+    {
+      return error(result_void, _.error);
+    }
+
+    context->culling_stats = _.value;
+  }
+
+  if(context->command_batching)
+  {
+    // rects are merged only if backend can render them at once
+    const render_backend* backend = context->internal_ctx->backend;
+    bool merge_rects = backend && backend->supports_batched_rects;
+
+    result_command_batching_stats _ =
+      command_buffer_batch_commands(cmd_buffer, merge_rects);
+    if(!_.ok)
+    {
+      return error(result_void, _.error);
+    }
+
+    context->batching_stats = _.value;
+  }
+
+  return ok_void();
+}
+
 result_smoll_context_ptr smoll_context_create(uint16 viewport_width,
                                               uint16 viewport_height)
 {
@@ -36,6 +144,17 @@ result_smoll_context_ptr smoll_context_create(uint16 viewport_width,
 
   context->internal_ctx = _.value;
 
+  result_command_buffer_ptr __ = command_buffer_new();
+  if(!__.ok)
+  {
+    internal_context_destroy(context->internal_ctx);
+    free(context);
+    return error(result_smoll_context_ptr, __.error);
+  }
+
+  context->submitted_cmd_buffer = __.value;
+  frame_state_store(&context->frame_state, FRAME_FREE);
+
   return ok(result_smoll_context_ptr, context);
 }
 
@@ -49,6 +168,15 @@ result_void smoll_context_destroy(smoll_context* context)
   // ignoring if any errors occurred while destroying internal context
   result_void _ = internal_context_destroy(context->internal_ctx);
 
+  // ignoring if any errors occurred while freeing command buffer
+  _ = command_buffer_free(context->submitted_cmd_buffer);
+
+  if(context->recorder)
+  {
+    // ignoring if any errors occurred while closing recording
+    _ = command_stream_writer_close(context->recorder);
+  }
+
   free(context);
 
   return ok_void();
@@ -70,21 +198,41 @@ result_void smoll_context_set_default_font(smoll_context* context,
                  "Cannot set NULL pointing font to smoll context!");
   }
 
-  char* font_copy = strdup(font);
-  if(!font_copy)
+  return internal_context_set_font(
+    context->internal_ctx, DEFAULT_FONT_HANDLE, font, font_size);
+}
+
+result_font_handle smoll_context_register_font(smoll_context* context,
+                                               const char* font,
+                                               uint8 font_size)
+{
+  if(!context)
   {
-    return error(result_void, "Unable to make a copy of font!");
+    return error(result_font_handle,
+                 "Cannot register font for a NULL pointing smoll context!");
   }
 
-  context->internal_ctx->font = font_copy;
-  context->internal_ctx->font_size = font_size;
+  if(!font)
+  {
+    return error(result_font_handle,
+                 "Cannot register NULL pointing font to smoll context!");
+  }
 
-  if(context->internal_ctx->backend)
+  // handle of default font is reserved, even if it isn't set yet
+  uint32 handle = max(context->internal_ctx->fonts_count, 1);
+  if(handle > UINT16_MAX)
   {
-    context->internal_ctx->backend->load_font(font, font_size);
+    return error(result_font_handle, "Cannot register any more fonts!");
   }
 
-  return ok_void();
+  result_void _ = internal_context_set_font(
+    context->internal_ctx, (font_handle)handle, font, font_size);
+  if(!_.ok)
+  {
+    return error(result_font_handle, _.error);
+  }
+
+  return ok(result_font_handle, (font_handle)handle);
 }
 
 result_void smoll_context_set_root_widget(smoll_context* context,
@@ -102,14 +250,20 @@ result_void smoll_context_set_root_widget(smoll_context* context,
                  "Cannot set NULL pointed root widget to context!");
   }
 
+  // setting root widget's context, moving its tree into geometry store of
+  // context
+  result_void _ =
+    common_internal_set_context(root_widget_base, context->internal_ctx);
+  if(!_.ok)
+  {
+    return _;
+  }
+
   // setting context's root widget.
   context->internal_ctx->root = root_widget_base;
 
-  // setting root widget's context.
-  root_widget_base->context = context->internal_ctx;
-
-  root_widget_base->w = context->internal_ctx->viewport_w;
-  root_widget_base->h = context->internal_ctx->viewport_h;
+  widget_w(root_widget_base) = context->internal_ctx->viewport_w;
+  widget_h(root_widget_base) = context->internal_ctx->viewport_h;
 
   return ok_void();
 }
@@ -131,12 +285,15 @@ smoll_context_process_viewport_resize_event(smoll_context* context,
   command_buffer_add_clear_window_command(context->internal_ctx->cmd_buffer);
 
   base_widget* root = context->internal_ctx->root;
-  root->w = event.w;
-  root->h = event.h;
+  widget_w(root) = event.w;
+  widget_h(root) = event.h;
+
+  // window is cleared, nothing is on screen anymore
+  common_internal_invalidate_display_list(root);
 
   common_internal_calculate_size(root);
   common_internal_relayout(root);
-  root->internal_render_callback(root);
+  common_internal_render(root);
 
   return ok_void();
 }
@@ -340,7 +497,8 @@ result_void smoll_context_register_backend(smoll_context* context,
 
   context->internal_ctx->backend = backend;
 
-  return ok_void();
+  // fonts registered before are loaded into the new backend
+  return internal_context_load_fonts(context->internal_ctx);
 }
 
 result_void smoll_context_initial_render(smoll_context* context)
@@ -354,8 +512,7 @@ result_void smoll_context_initial_render(smoll_context* context)
 
   if(context->internal_ctx->root->internal_render_callback)
   {
-    context->internal_ctx->root->internal_render_callback(
-      context->internal_ctx->root);
+    common_internal_render(context->internal_ctx->root);
   }
 
   return smoll_context_render(context);
@@ -401,28 +558,32 @@ result_void smoll_context_render(smoll_context* context)
       "Registered backend doesn't contain process command callback function!");
   }
 
-  int16 buffer_length =
-    command_buffer_length(context->internal_ctx->cmd_buffer);
-  if(buffer_length < 1)
+  result_void _ = internal_context_update(context->internal_ctx);
+  if(!_.ok)
   {
-    return ok_void();
+    return _;
   }
 
-  while(buffer_length > 0)
+  _ = smoll_context_prepare_frame(context);
+  if(!_.ok)
   {
-    command* cmd =
-      command_buffer_get_next_command(context->internal_ctx->cmd_buffer).value;
-
-    // forwarding command to backend for processing
-    context->internal_ctx->backend->process_command(cmd);
-
-    // freeing command after processing
-    command_free(cmd);
+    return _;
+  }
 
-    --buffer_length;
+  const command_buffer* cmd_buffer = context->internal_ctx->cmd_buffer;
+  uint32 segments_count = command_buffer_get_segments_count(cmd_buffer);
+  for(uint32 s = 0; s < segments_count; s++)
+  {
+    command_span span = command_buffer_get_segment(cmd_buffer, s);
+    for(uint32 i = 0; i < span.length; i++)
+    {
+      // forwarding command to backend for processing
+      context->internal_ctx->backend->process_command(&span.commands[i]);
+    }
   }
 
-  return ok_void();
+  // clearing commands after processing, storage is retained for next frame
+  return command_buffer_clear_commands(context->internal_ctx->cmd_buffer);
 }
 
 result_void
@@ -446,7 +607,19 @@ smoll_context_render_send_cmd_buffer_to_backend(smoll_context* context)
       "Registered backend doesn't contain process command callback function!");
   }
 
-  int16 buffer_length =
+  result_void _ = internal_context_update(context->internal_ctx);
+  if(!_.ok)
+  {
+    return _;
+  }
+
+  _ = smoll_context_prepare_frame(context);
+  if(!_.ok)
+  {
+    return _;
+  }
+
+  uint32 buffer_length =
     command_buffer_length(context->internal_ctx->cmd_buffer);
   if(buffer_length < 1)
   {
@@ -462,3 +635,316 @@ smoll_context_render_send_cmd_buffer_to_backend(smoll_context* context)
 
   return ok_void();
 }
+
+result_bool smoll_context_submit_frame(smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_bool,
+                 "Cannot submit frame of context pointing to NULL!");
+  }
+
+  // commands of updates are accumulated, even if frame can't be submitted
+  result_void __ = internal_context_update(context->internal_ctx);
+  if(!__.ok)
+  {
+    return error(result_bool, __.error);
+  }
+
+  if(frame_state_load(&context->frame_state) != FRAME_FREE)
+  {
+    // render thread still owns the submitted command buffer
+    return ok(result_bool, false);
+  }
+
+  if(command_buffer_length(context->internal_ctx->cmd_buffer) < 1)
+  {
+    return ok(result_bool, false);
+  }
+
+  // optimizing only when the frame is actually submitted, as commands of
+  // frames which couldn't be submitted keep accumulating
+  result_void _ = smoll_context_prepare_frame(context);
+  if(!_.ok)
+  {
+    return error(result_bool, _.error);
+  }
+
+  // reusing command buffer of previously rendered frame for next frame
+  command_buffer* next_cmd_buffer = context->submitted_cmd_buffer;
+  _ = command_buffer_clear_commands(next_cmd_buffer);
+  if(!_.ok)
+  {
+    return error(result_bool, _.error);
+  }
+
+  context->submitted_cmd_buffer = context->internal_ctx->cmd_buffer;
+  context->internal_ctx->cmd_buffer = next_cmd_buffer;
+
+  frame_state_store(&context->frame_state, FRAME_SUBMITTED);
+
+  return ok(result_bool, true);
+}
+
+result_const_command_buffer_ptr
+smoll_context_acquire_frame(smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_const_command_buffer_ptr,
+                 "Cannot acquire frame of context pointing to NULL!");
+  }
+
+  if(frame_state_load(&context->frame_state) != FRAME_SUBMITTED)
+  {
+    return ok(result_const_command_buffer_ptr, NULL);
+  }
+
+  frame_state_store(&context->frame_state, FRAME_RENDERING);
+
+  return ok(result_const_command_buffer_ptr, context->submitted_cmd_buffer);
+}
+
+result_void smoll_context_release_frame(smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_void,
+                 "Cannot release frame of context pointing to NULL!");
+  }
+
+  if(frame_state_load(&context->frame_state) != FRAME_RENDERING)
+  {
+    return error(
+      result_void,
+      "Cannot release frame, as no frame is acquired for rendering!");
+  }
+
+  frame_state_store(&context->frame_state, FRAME_FREE);
+
+  return ok_void();
+}
+
+result_bool smoll_context_is_frame_in_flight(smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_bool,
+                 "Cannot check frame in flight of context pointing to NULL!");
+  }
+
+  return ok(result_bool,
+            frame_state_load(&context->frame_state) != FRAME_FREE);
+}
+
+result_void smoll_context_set_occlusion_culling(smoll_context* context,
+                                               bool enabled)
+{
+  if(!context)
+  {
+    return error(result_void,
+                 "Cannot set occlusion culling of context pointing to NULL!");
+  }
+
+  context->occlusion_culling = enabled;
+
+  return ok_void();
+}
+
+result_command_culling_stats
+smoll_context_get_culling_stats(const smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_command_culling_stats,
+                 "Cannot get culling stats of context pointing to NULL!");
+  }
+
+  return ok(result_command_culling_stats, context->culling_stats);
+}
+
+result_void smoll_context_set_command_batching(smoll_context* context,
+                                              bool enabled)
+{
+  if(!context)
+  {
+    return error(result_void,
+                 "Cannot set command batching of context pointing to NULL!");
+  }
+
+  context->command_batching = enabled;
+
+  return ok_void();
+}
+
+result_command_batching_stats
+smoll_context_get_batching_stats(const smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_command_batching_stats,
+                 "Cannot get batching stats of context pointing to NULL!");
+  }
+
+  return ok(result_command_batching_stats, context->batching_stats);
+}
+
+result_void smoll_context_set_retained_rendering(smoll_context* context,
+                                                 bool enabled)
+{
+  if(!context)
+  {
+    return error(result_void,
+                 "Cannot set retained rendering of context pointing to NULL!");
+  }
+
+  if(enabled && !context->internal_ctx->retained_rendering)
+  {
+    // display lists may be stale, as they were not diffed while disabled
+    common_internal_invalidate_display_list(context->internal_ctx->root);
+  }
+
+  context->internal_ctx->retained_rendering = enabled;
+
+  return ok_void();
+}
+
+result_void smoll_context_set_parallel_layout(smoll_context* context,
+                                              uint16 threads_count)
+{
+  if(!context)
+  {
+    return error(result_void,
+                 "Cannot set parallel layout of context pointing to NULL!");
+  }
+
+  internal_context* internal_ctx = context->internal_ctx;
+  if(thread_pool_get_threads_count(internal_ctx->layout_pool) ==
+     threads_count)
+  {
+    return ok_void();
+  }
+
+  if(internal_ctx->layout_pool)
+  {
+    thread_pool_free(internal_ctx->layout_pool);
+    internal_ctx->layout_pool = NULL;
+  }
+
+  if(!threads_count)
+  {
+    return ok_void();
+  }
+
+  result_thread_pool_ptr _ = thread_pool_new(threads_count);
+  if(!_.ok)
+  {
+    return error(result_void, _.error);
+  }
+  internal_ctx->layout_pool = _.value;
+
+  return ok_void();
+}
+
+result_void smoll_context_set_deferred_updates(smoll_context* context,
+                                               bool enabled)
+{
+  if(!context)
+  {
+    return error(result_void,
+                 "Cannot set deferred updates of context pointing to NULL!");
+  }
+
+  if(!enabled)
+  {
+    // running updates queued so far, they wouldn't be run otherwise
+    result_void _ = internal_context_update(context->internal_ctx);
+    if(!_.ok)
+    {
+      return _;
+    }
+  }
+
+  context->internal_ctx->deferred_updates = enabled;
+
+  return ok_void();
+}
+
+result_void smoll_context_update(smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_void, "Cannot update UI of context pointing to NULL!");
+  }
+
+  return internal_context_update(context->internal_ctx);
+}
+
+result_text_cache_stats
+smoll_context_get_text_cache_stats(const smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_text_cache_stats,
+                 "Cannot get text cache stats of context pointing to NULL!");
+  }
+
+  return ok(result_text_cache_stats,
+            text_cache_get_stats(context->internal_ctx->text_cache));
+}
+
+result_display_list_stats
+smoll_context_get_display_list_stats(const smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_display_list_stats,
+                 "Cannot get display list stats of context pointing to NULL!");
+  }
+
+  return ok(result_display_list_stats, context->display_list_stats);
+}
+
+result_void smoll_context_start_recording(smoll_context* context,
+                                          const char* path)
+{
+  if(!context)
+  {
+    return error(result_void,
+                 "Cannot start recording of context pointing to NULL!");
+  }
+
+  if(context->recorder)
+  {
+    return error(result_void, "Context is already recording frames!");
+  }
+
+  result_command_stream_writer_ptr _ = command_stream_writer_open(path);
+  if(!_.ok)
+  {
+    return error(result_void, _.error);
+  }
+
+  context->recorder = _.value;
+
+  return ok_void();
+}
+
+result_void smoll_context_stop_recording(smoll_context* context)
+{
+  if(!context)
+  {
+    return error(result_void,
+                 "Cannot stop recording of context pointing to NULL!");
+  }
+
+  if(!context->recorder)
+  {
+    return error(result_void, "Context is not recording frames!");
+  }
+
+  result_void _ = command_stream_writer_close(context->recorder);
+  context->recorder = NULL;
+
+  return _;
+}
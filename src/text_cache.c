@@ -0,0 +1,239 @@
+#include "../include/text_cache.h"
+#include <stdlib.h>
+#include <string.h>
+#include "../include/macros.h"
+
+#define SETS_COUNT (TEXT_CACHE_ENTRIES_MAX / TEXT_CACHE_SET_SIZE)
+
+typedef struct text_cache_entry
+{
+  /// Copy of text, `NULL` if entry is unused.
+  char* text;
+
+  /// Hash of text and font.
+  uint64 hash;
+
+  font_handle font;
+
+  text_dimensions dimensions;
+
+  /// Tick of cache when entry was last used, least used is evicted first.
+  uint64 last_used;
+} text_cache_entry;
+
+struct text_cache
+{
+  text_cache_entry entries[SETS_COUNT][TEXT_CACHE_SET_SIZE];
+
+  /// Incremented on each lookup (or) insertion.
+  uint64 tick;
+
+  text_cache_stats stats;
+};
+
+static uint64 hash_string(uint64 hash, const char* string)
+{
+  for(const uint8* c = (const uint8*)string; *c; c++)
+  {
+    hash ^= *c;
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+
+static uint64 hash_key(const char* text, font_handle font)
+{
+  uint64 hash = hash_string(14695981039346656037ull ^ font, text);
+
+  // mixing high bits into low bits, which pick the set
+  return hash ^ (hash >> 32);
+}
+
+static text_cache_entry* get_set(text_cache* cache, uint64 hash)
+{
+  return cache->entries[hash % SETS_COUNT];
+}
+
+static const text_cache_entry* get_const_set(const text_cache* cache,
+                                             uint64 hash)
+{
+  return cache->entries[hash % SETS_COUNT];
+}
+
+static bool entry_matches(const text_cache_entry* entry,
+                          uint64 hash,
+                          const char* text,
+                          font_handle font)
+{
+  return entry->text && entry->hash == hash && entry->font == font &&
+         !strcmp(entry->text, text);
+}
+
+result_text_cache_ptr text_cache_new()
+{
+  text_cache* cache = (text_cache*)calloc(1, sizeof(text_cache));
+  if(!cache)
+  {
+    return error(result_text_cache_ptr,
+                 "Unable to allocate memory for text cache!");
+  }
+
+  return ok(result_text_cache_ptr, cache);
+}
+
+result_void text_cache_free(text_cache* cache)
+{
+  if(!cache)
+  {
+    return error(result_void, "Attempt to free a NULL pointed text cache!");
+  }
+
+  text_cache_clear(cache);
+  free(cache);
+
+  return ok_void();
+}
+
+bool text_cache_lookup(text_cache* cache,
+                       const char* text,
+                       font_handle font,
+                       text_dimensions* dimensions)
+{
+  if(!cache || !text)
+  {
+    return false;
+  }
+
+  uint64 hash = hash_key(text, font);
+  text_cache_entry* set = get_set(cache, hash);
+
+  cache->tick++;
+  for(uint8 i = 0; i < TEXT_CACHE_SET_SIZE; i++)
+  {
+    if(entry_matches(&set[i], hash, text, font))
+    {
+      set[i].last_used = cache->tick;
+      *dimensions = set[i].dimensions;
+      cache->stats.hits++;
+      return true;
+    }
+  }
+
+  cache->stats.misses++;
+  return false;
+}
+
+bool text_cache_contains(const text_cache* cache,
+                         const char* text,
+                         font_handle font)
+{
+  if(!cache || !text)
+  {
+    return false;
+  }
+
+  uint64 hash = hash_key(text, font);
+  const text_cache_entry* set = get_const_set(cache, hash);
+
+  for(uint8 i = 0; i < TEXT_CACHE_SET_SIZE; i++)
+  {
+    if(entry_matches(&set[i], hash, text, font))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+result_void text_cache_insert(text_cache* cache,
+                              const char* text,
+                              font_handle font,
+                              text_dimensions dimensions)
+{
+  if(!cache || !text)
+  {
+    return error(result_void,
+                 "Cannot insert into text cache with NULL pointed cache (or) "
+                 "text!");
+  }
+
+  uint64 hash = hash_key(text, font);
+  text_cache_entry* set = get_set(cache, hash);
+
+  // reusing entry of same text if present, else an unused (or) the least
+  // recently used entry
+  text_cache_entry* entry = &set[0];
+  for(uint8 i = 0; i < TEXT_CACHE_SET_SIZE; i++)
+  {
+    if(entry_matches(&set[i], hash, text, font))
+    {
+      entry = &set[i];
+      break;
+    }
+
+    if(!set[i].text)
+    {
+      if(entry->text)
+      {
+        entry = &set[i];
+      }
+    }
+    else if(entry->text && set[i].last_used < entry->last_used)
+    {
+      entry = &set[i];
+    }
+  }
+
+  if(!entry_matches(entry, hash, text, font))
+  {
+    char* text_copy = strdup(text);
+    if(!text_copy)
+    {
+      return error(result_void, "Unable to make a copy of text!");
+    }
+
+    if(entry->text)
+    {
+      free(entry->text);
+      cache->stats.evictions++;
+    }
+    else
+    {
+      cache->stats.entries++;
+    }
+
+    entry->text = text_copy;
+    entry->hash = hash;
+    entry->font = font;
+  }
+
+  entry->dimensions = dimensions;
+  entry->last_used = ++cache->tick;
+
+  return ok_void();
+}
+
+void text_cache_clear(text_cache* cache)
+{
+  if(!cache)
+  {
+    return;
+  }
+
+  for(uint32 s = 0; s < SETS_COUNT; s++)
+  {
+    for(uint8 i = 0; i < TEXT_CACHE_SET_SIZE; i++)
+    {
+      free(cache->entries[s][i].text);
+      cache->entries[s][i].text = NULL;
+    }
+  }
+  cache->stats.entries = 0;
+}
+
+text_cache_stats text_cache_get_stats(const text_cache* cache)
+{
+  return cache ? cache->stats : (text_cache_stats){0};
+}
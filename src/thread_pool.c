@@ -0,0 +1,342 @@
+#include "../include/thread_pool.h"
+#include <stdlib.h>
+#include "../include/macros.h"
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+typedef HANDLE thread_handle;
+typedef CRITICAL_SECTION mutex;
+typedef CONDITION_VARIABLE condition;
+#else
+#  include <pthread.h>
+typedef pthread_t thread_handle;
+typedef pthread_mutex_t mutex;
+typedef pthread_cond_t condition;
+#endif
+
+#define TASKS_INITIAL_CAPACITY 64
+
+typedef struct task
+{
+  void (*run)(void* data);
+  void* data;
+  thread_pool_group* group;
+} task;
+
+struct thread_pool
+{
+  thread_handle* threads;
+  uint16 threads_count;
+
+  /// Pending tasks, taken from the end.
+  task* tasks;
+  uint32 tasks_count;
+  uint32 tasks_capacity;
+
+  /// Guards tasks, pending counts of groups and `stopping`.
+  mutex lock;
+
+  /// Signalled when a task is submitted (or) pool is stopping.
+  condition task_submitted;
+
+  /// Signalled when a task has finished.
+  condition task_finished;
+
+  bool stopping;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Platform Primitives
+///////////////////////////////////////////////////////////////////////////////
+
+static void mutex_init(mutex* m)
+{
+#ifdef _WIN32
+  InitializeCriticalSection(m);
+#else
+  pthread_mutex_init(m, NULL);
+#endif
+}
+
+static void mutex_destroy(mutex* m)
+{
+#ifdef _WIN32
+  DeleteCriticalSection(m);
+#else
+  pthread_mutex_destroy(m);
+#endif
+}
+
+static void mutex_lock(mutex* m)
+{
+#ifdef _WIN32
+  EnterCriticalSection(m);
+#else
+  pthread_mutex_lock(m);
+#endif
+}
+
+static void mutex_unlock(mutex* m)
+{
+#ifdef _WIN32
+  LeaveCriticalSection(m);
+#else
+  pthread_mutex_unlock(m);
+#endif
+}
+
+static void condition_init(condition* c)
+{
+#ifdef _WIN32
+  InitializeConditionVariable(c);
+#else
+  pthread_cond_init(c, NULL);
+#endif
+}
+
+static void condition_destroy(condition* c)
+{
+#ifdef _WIN32
+  // condition variables of windows don't need to be destroyed
+  (void)c;
+#else
+  pthread_cond_destroy(c);
+#endif
+}
+
+static void condition_wait(condition* c, mutex* m)
+{
+#ifdef _WIN32
+  SleepConditionVariableCS(c, m, INFINITE);
+#else
+  pthread_cond_wait(c, m);
+#endif
+}
+
+static void condition_broadcast(condition* c)
+{
+#ifdef _WIN32
+  WakeAllConditionVariable(c);
+#else
+  pthread_cond_broadcast(c);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Workers
+///////////////////////////////////////////////////////////////////////////////
+
+/// Runs task with pool's lock released, then marks it finished.
+/// Should be called with pool's lock held.
+static void run_task(thread_pool* pool, task t)
+{
+  mutex_unlock(&pool->lock);
+  t.run(t.data);
+  mutex_lock(&pool->lock);
+
+  t.group->pending--;
+  condition_broadcast(&pool->task_finished);
+}
+
+static void worker_loop(thread_pool* pool)
+{
+  mutex_lock(&pool->lock);
+  while(1)
+  {
+    while(!pool->tasks_count && !pool->stopping)
+    {
+      condition_wait(&pool->task_submitted, &pool->lock);
+    }
+
+    if(!pool->tasks_count)
+    {
+      // pool is stopping, and no tasks are left
+      break;
+    }
+
+    run_task(pool, pool->tasks[--pool->tasks_count]);
+  }
+  mutex_unlock(&pool->lock);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID data)
+{
+  worker_loop((thread_pool*)data);
+  return 0;
+}
+#else
+static void* worker_main(void* data)
+{
+  worker_loop((thread_pool*)data);
+  return NULL;
+}
+#endif
+
+/// Stops and joins the first `threads_count` worker threads of pool.
+static void stop_workers(thread_pool* pool, uint16 threads_count)
+{
+  mutex_lock(&pool->lock);
+  pool->stopping = true;
+  condition_broadcast(&pool->task_submitted);
+  mutex_unlock(&pool->lock);
+
+  for(uint16 i = 0; i < threads_count; i++)
+  {
+#ifdef _WIN32
+    WaitForSingleObject(pool->threads[i], INFINITE);
+    CloseHandle(pool->threads[i]);
+#else
+    pthread_join(pool->threads[i], NULL);
+#endif
+  }
+}
+
+static void destroy_pool(thread_pool* pool)
+{
+  condition_destroy(&pool->task_finished);
+  condition_destroy(&pool->task_submitted);
+  mutex_destroy(&pool->lock);
+  free(pool->tasks);
+  free(pool->threads);
+  free(pool);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Thread Pool
+///////////////////////////////////////////////////////////////////////////////
+
+result_thread_pool_ptr thread_pool_new(uint16 threads_count)
+{
+  if(!threads_count)
+  {
+    return error(result_thread_pool_ptr,
+                 "Cannot create a thread pool without threads!");
+  }
+
+  thread_pool* pool = (thread_pool*)calloc(1, sizeof(thread_pool));
+  if(!pool)
+  {
+    return error(result_thread_pool_ptr,
+                 "Unable to allocate memory for thread pool!");
+  }
+
+  pool->threads = (thread_handle*)calloc(threads_count, sizeof(thread_handle));
+  pool->tasks = (task*)malloc(TASKS_INITIAL_CAPACITY * sizeof(task));
+  if(!pool->threads || !pool->tasks)
+  {
+    free(pool->tasks);
+    free(pool->threads);
+    free(pool);
+    return error(result_thread_pool_ptr,
+                 "Unable to allocate memory for threads of thread pool!");
+  }
+  pool->tasks_capacity = TASKS_INITIAL_CAPACITY;
+
+  mutex_init(&pool->lock);
+  condition_init(&pool->task_submitted);
+  condition_init(&pool->task_finished);
+
+  for(uint16 i = 0; i < threads_count; i++)
+  {
+#ifdef _WIN32
+    pool->threads[i] = CreateThread(NULL, 0, worker_main, pool, 0, NULL);
+    bool started = pool->threads[i] != NULL;
+#else
+    bool started =
+      pthread_create(&pool->threads[i], NULL, worker_main, pool) == 0;
+#endif
+    if(!started)
+    {
+      stop_workers(pool, i);
+      destroy_pool(pool);
+      return error(result_thread_pool_ptr,
+                   "Unable to start worker threads of thread pool!");
+    }
+  }
+  pool->threads_count = threads_count;
+
+  return ok(result_thread_pool_ptr, pool);
+}
+
+result_void thread_pool_free(thread_pool* pool)
+{
+  if(!pool)
+  {
+    return error(result_void, "Attempt to free a NULL pointed thread pool!");
+  }
+
+  stop_workers(pool, pool->threads_count);
+  destroy_pool(pool);
+
+  return ok_void();
+}
+
+uint16 thread_pool_get_threads_count(const thread_pool* pool)
+{
+  return pool ? pool->threads_count : 0;
+}
+
+result_void thread_pool_submit(thread_pool* pool,
+                               thread_pool_group* group,
+                               void (*run)(void* data),
+                               void* data)
+{
+  if(!pool || !group || !run)
+  {
+    return error(result_void,
+                 "Cannot submit task with NULL pointed pool, group (or) "
+                 "function!");
+  }
+
+  mutex_lock(&pool->lock);
+
+  if(pool->tasks_count == pool->tasks_capacity)
+  {
+    uint32 capacity = pool->tasks_capacity * 2;
+    task* tasks = (task*)realloc(pool->tasks, capacity * sizeof(task));
+    if(!tasks)
+    {
+      mutex_unlock(&pool->lock);
+      return error(result_void, "Unable to allocate memory for tasks!");
+    }
+    pool->tasks = tasks;
+    pool->tasks_capacity = capacity;
+  }
+
+  pool->tasks[pool->tasks_count++] =
+    (task){.run = run, .data = data, .group = group};
+  group->pending++;
+  condition_broadcast(&pool->task_submitted);
+
+  mutex_unlock(&pool->lock);
+
+  return ok_void();
+}
+
+result_void thread_pool_wait(thread_pool* pool, thread_pool_group* group)
+{
+  if(!pool || !group)
+  {
+    return error(result_void,
+                 "Cannot wait for tasks with NULL pointed pool (or) group!");
+  }
+
+  mutex_lock(&pool->lock);
+  while(group->pending)
+  {
+    if(pool->tasks_count)
+    {
+      // helping out instead of blocking, the task may be of another group
+      run_task(pool, pool->tasks[--pool->tasks_count]);
+    }
+    else
+    {
+      condition_wait(&pool->task_finished, &pool->lock);
+    }
+  }
+  mutex_unlock(&pool->lock);
+
+  return ok_void();
+}
@@ -18,6 +18,8 @@ default_internal_fit_layout_callback(base_widget* widget,
 /// @return Bool result.
 static result_bool default_internal_render_callback(const base_widget* widget);
 
+static void default_internal_derived_free_callback(base_widget* widget);
+
 result_box_ptr box_new(base_widget* parent_base, flex_direction direction)
 {
   box* b = (box*)calloc(1, sizeof(box));
@@ -48,6 +50,8 @@ result_box_ptr box_new(base_widget* parent_base, flex_direction direction)
     default_internal_get_background_callback;
   b->base->internal_fit_layout_callback = default_internal_fit_layout_callback;
   b->base->internal_render_callback = default_internal_render_callback;
+  b->base->internal_derived_free_callback =
+    default_internal_derived_free_callback;
 
   b->base->flexbox_data.container.direction = direction;
 
@@ -129,10 +133,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
     "Box(%s): internal-render(), (x, y, w, h): (%d, %d, %d, %d), background: "
     "(%d, %d, %d, %d)",
     widget->debug_name,
-    widget->x,
-    widget->y,
-    widget->w,
-    widget->h,
+    widget_x(widget),
+    widget_y(widget),
+    widget_w(widget),
+    widget_h(widget),
     bg.r,
     bg.b,
     bg.g,
@@ -160,7 +164,7 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   base_widget_child_node* node = widget->children_head;
   while(node)
   {
-    node->child->internal_render_callback(node->child);
+    common_internal_render(node->child);
     node = node->next;
   }
 
@@ -173,3 +177,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
 
   return ok(result_bool, true);
 }
+
+static void default_internal_derived_free_callback(base_widget* widget)
+{
+  // freeing box object
+  // freeing base_widget is taken care by internal_free_callback
+  free(widget->derived);
+}
@@ -28,6 +28,12 @@ struct button_private
   /// @brief Button text.
   char* text;
 
+  /// @brief Font of button text.
+  font_handle font;
+
+  /// @brief Button text, shaped by backend.
+  glyph_run glyph_run;
+
   /// @brief User mouse button down callback.
   ///        This callback should be explicitly set by user.
   void (*user_mouse_button_down_callback)(button* btn,
@@ -58,6 +64,13 @@ static result_sizing_delta
 default_internal_fit_layout_callback(base_widget* widget,
                                      bool call_on_children);
 
+/// @brief Default callback function for internal get text callback.
+/// @param widget pointer to base widget.
+/// @return Text of button.
+static const char*
+default_internal_get_text_callback(const base_widget* widget,
+                                   font_handle* font);
+
 /// @brief Default callback function for internal render callback.
 /// @param widget pointer to base widget.
 /// @return Bool result.
@@ -143,6 +156,7 @@ result_button_ptr button_new(base_widget* parent_base, const char* text)
 
   btn->base->internal_fit_layout_callback =
     default_internal_fit_layout_callback;
+  btn->base->internal_get_text_callback = default_internal_get_text_callback;
   btn->base->internal_render_callback = default_internal_render_callback;
 
   btn->base->internal_derived_free_callback =
@@ -166,6 +180,7 @@ result_button_ptr button_new(base_widget* parent_base, const char* text)
 
   btn->private_data->state = BUTTON_NORMAL;
 
+  btn->private_data->font = DEFAULT_FONT_HANDLE;
   btn->private_data->text = NULL;
   btn->private_data->text = strdup(text);
   if(!btn->private_data->text)
@@ -223,6 +238,8 @@ result_void button_set_text(button* btn, const char* text)
 
   free(btn->private_data->text);
   btn->private_data->text = temp;
+  common_internal_invalidate_measured_size(btn->base);
+  common_internal_invalidate_glyph_run(&btn->private_data->glyph_run);
 
   // btn->base->internal_fit_layout_callback(btn->base, false);
   // btn->base->internal_render_callback(btn->base);
@@ -231,6 +248,39 @@ result_void button_set_text(button* btn, const char* text)
   return ok_void();
 }
 
+result_font_handle button_get_font(const button* btn)
+{
+  if(!btn)
+  {
+    return error(result_font_handle,
+                 "Cannot get font of NULL pointing button widget!");
+  }
+
+  return ok(result_font_handle, btn->private_data->font);
+}
+
+result_void button_set_font(button* btn, font_handle font)
+{
+  if(!btn)
+  {
+    return error(result_void,
+                 "Cannot set font of NULL pointing button widget!");
+  }
+
+  if(btn->private_data->font == font)
+  {
+    return ok_void();
+  }
+
+  btn->private_data->font = font;
+  common_internal_invalidate_measured_size(btn->base);
+  common_internal_invalidate_glyph_run(&btn->private_data->glyph_run);
+
+  common_internal_adjust_layout(btn->base);
+
+  return ok_void();
+}
+
 result_void button_set_mouse_down_callback(button* btn,
                                            void (*callback)(button*,
                                                             mouse_button_event))
@@ -330,6 +380,7 @@ static void default_internal_derived_free_callback(base_widget* widget)
   button* btn = (button*)widget->derived;
   // freeing button text
   free(btn->private_data->text);
+  common_internal_free_glyph_run(&btn->private_data->glyph_run);
   // freeing button private struct
   free(btn->private_data);
 
@@ -345,38 +396,56 @@ default_internal_fit_layout_callback(base_widget* widget, bool call_on_children)
 
   button* btn = (button*)widget->derived;
 
-  result_text_dimensions ___ = widget->context->backend->get_text_dimensions(
-    btn->private_data->text, widget->context->font, widget->context->font_size);
-  if(!___.ok)
+  // measuring text only if it has changed since last measured
+  text_dimensions dimensions;
+  if(!common_internal_get_measured_size(widget, &dimensions))
   {
-    return error(result_sizing_delta, ___.error);
+    result_text_dimensions ___ =
+      internal_context_measure_text(widget->context,
+                                    btn->private_data->text,
+                                    btn->private_data->font);
+    if(!___.ok)
+    {
+      return error(result_sizing_delta, ___.error);
+    }
+    dimensions = ___.value;
+    common_internal_set_measured_size(widget, dimensions);
   }
-  text_dimensions dimensions = ___.value;
 
   debug("  > Text: \"%s\", dimensions: %d, %d",
         btn->private_data->text,
         dimensions.w,
         dimensions.h);
   debug("  > Widget dimensions: %d, %d | padding: %d, %d",
-        widget->w,
-        widget->h,
+        widget_w(widget),
+        widget_h(widget),
         btn->padding_x,
         btn->padding_y);
 
   uint16 new_w = dimensions.w + 2 * btn->padding_x;
   uint16 new_h = dimensions.h + 2 * btn->padding_y;
-  sizing_delta deltas = {.x = (int16)new_w - (int16)widget->w,
-                         .y = (int16)new_h - (int16)widget->h};
+  sizing_delta deltas = {.x = (int32)new_w - (int32)widget_w(widget),
+                         .y = (int32)new_h - (int32)widget_h(widget)};
 
   info("  > sizing-deltas: (%d, %d)", deltas.x, deltas.y);
 
   // setting widget's sizing, so no need to set need resizing flag
-  widget->w = new_w;
-  widget->h = new_h;
+  widget_w(widget) = new_w;
+  widget_h(widget) = new_h;
 
   return ok(result_sizing_delta, deltas);
 }
 
+static const char*
+default_internal_get_text_callback(const base_widget* widget,
+                                   font_handle* font)
+{
+  const button* btn = (const button*)widget->derived;
+  *font = btn->private_data->font;
+
+  return btn->private_data->text;
+}
+
 static result_bool default_internal_render_callback(const base_widget* widget)
 {
   button* btn = (button*)widget->derived;
@@ -396,10 +465,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
         "%d, %d), background: (%d, %d, %d, %d), foreground: (%d, %d, %d, %d)",
         widget->debug_name,
         btn->private_data->text,
-        widget->x,
-        widget->y,
-        widget->w,
-        widget->h,
+        widget_x(widget),
+        widget_y(widget),
+        widget_w(widget),
+        widget_h(widget),
         background.r,
         background.g,
         background.b,
@@ -436,9 +505,11 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   bounding_rect.x += (int16)(btn->padding_x);
   bounding_rect.y += (int16)(btn->padding_y);
 
-  result_void ___ = command_buffer_add_render_text_command(
-    widget->context->cmd_buffer,
+  result_void ___ = common_internal_render_text(
+    widget,
+    &btn->private_data->glyph_run,
     btn->private_data->text,
+    btn->private_data->font,
     foreground,
     (point){.x = bounding_rect.x, .y = bounding_rect.y});
   if(!___.ok)
@@ -455,7 +526,7 @@ static bool default_mouse_button_down_callback(base_widget* widget,
   button* btn = (button*)widget->derived;
   btn->private_data->state = BUTTON_CLICKED;
 
-  result_bool _ = widget->internal_render_callback(widget);
+  result_bool _ = common_internal_render(widget);
   if(!_.ok)
   {
     return false;
@@ -478,7 +549,7 @@ static bool default_mouse_button_up_callback(base_widget* widget,
   button* btn = (button*)widget->derived;
   btn->private_data->state = BUTTON_HOVERED;
 
-  result_bool _ = widget->internal_render_callback(widget);
+  result_bool _ = common_internal_render(widget);
   if(!_.ok)
   {
     return false;
@@ -510,7 +581,7 @@ static bool default_mouse_enter_callback(base_widget* widget,
     }
   }
 
-  result_bool _ = widget->internal_render_callback(widget);
+  result_bool _ = common_internal_render(widget);
   if(!_.ok)
   {
     return false;
@@ -542,7 +613,7 @@ static bool default_mouse_leave_callback(base_widget* widget,
     }
   }
 
-  result_bool _ = widget->internal_render_callback(widget);
+  result_bool _ = common_internal_render(widget);
   if(!_.ok)
   {
     return false;
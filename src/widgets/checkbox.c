@@ -75,8 +75,8 @@ result_checkbox_ptr checkbox_new(base_widget* parent_base, color foreground)
   box->private_data = box_private;
 
   // setting checkbox size
-  box->base->w = 20;
-  box->base->h = 20;
+  widget_w(box->base) = 20;
+  widget_h(box->base) = 20;
 
   // setting need resizing flag to false
   box->base->need_resizing = false;
@@ -166,10 +166,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   trace("Checkbox(%s): internal-render(), (x, y, w, h): (%d, %d, %d, %d), "
         "foreground: (%d, %d, %d, %d)",
         widget->debug_name,
-        widget->x,
-        widget->y,
-        widget->w,
-        widget->h,
+        widget_x(widget),
+        widget_y(widget),
+        widget_w(widget),
+        widget_h(widget),
         fg.r,
         fg.g,
         fg.b,
@@ -240,7 +240,7 @@ static bool default_mouse_button_down_callback(base_widget* widget,
     box->private_data->state = UNTICKED;
   }
 
-  result_bool _ = widget->internal_render_callback(widget);
+  result_bool _ = common_internal_render(widget);
   if(!_.ok)
   {
     return false;
@@ -104,21 +104,21 @@ default_internal_fit_layout_callback(base_widget* widget, bool call_on_children)
     }
   }
 
-  uint16 total_width = 0, max_height = 0;
+  uint32 total_width = 0, max_height = 0;
   base_widget_child_node* node = widget->children_head;
   while(node)
   {
-    total_width += node->child->w + widget->flexbox_data.container.gap;
-    max_height = max(max_height, node->child->h);
+    total_width += widget_w(node->child) + widget->flexbox_data.container.gap;
+    max_height = max(max_height, widget_h(node->child));
     node = node->next;
   }
   total_width -= widget->flexbox_data.container.gap;
 
-  sizing_delta deltas = {.x = total_width - widget->w,
-                         .y = max_height - widget->h};
+  sizing_delta deltas = {.x = (int32)total_width - (int32)widget_w(widget),
+                         .y = (int32)max_height - (int32)widget_h(widget)};
 
-  widget->w = total_width;
-  widget->h = max_height;
+  widget_w(widget) = total_width;
+  widget_h(widget) = max_height;
 
   info("  > sizing-deltas: (%d, %d)", deltas.x, deltas.y);
 
@@ -132,10 +132,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   trace("Flex-View(%s): internal-render-callback(), (x, y, w, h): (%d, %d, %d, "
         "%d), background: (%d, %d, %d, %d)",
         widget->debug_name,
-        widget->x,
-        widget->y,
-        widget->w,
-        widget->h,
+        widget_x(widget),
+        widget_y(widget),
+        widget_w(widget),
+        widget_h(widget),
         bg.r,
         bg.b,
         bg.g,
@@ -162,7 +162,7 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   base_widget_child_node* node = widget->children_head;
   while(node)
   {
-    node->child->internal_render_callback(node->child);
+    common_internal_render(node->child);
     node = node->next;
   }
 
@@ -6,7 +6,9 @@
 struct label_private
 {
   char* text;
+  font_handle font;
   color text_color;
+  glyph_run glyph_run;
 };
 
 static void default_internal_derived_free_callback(base_widget* widget);
@@ -15,6 +17,10 @@ static result_sizing_delta
 default_internal_fit_layout_callback(base_widget* widget,
                                      bool call_on_children);
 
+static const char*
+default_internal_get_text_callback(const base_widget* widget,
+                                   font_handle* font);
+
 static result_bool default_internal_render_callback(const base_widget* widget);
 
 result_label_ptr label_new(base_widget* parent_base, const char* text)
@@ -49,6 +55,7 @@ result_label_ptr label_new(base_widget* parent_base, const char* text)
   }
 
   private_data->text = NULL;
+  private_data->font = DEFAULT_FONT_HANDLE;
   private_data->text_color = (color){255, 255, 255, 255};
 
   private_data->text = strdup(text);
@@ -75,6 +82,7 @@ result_label_ptr label_new(base_widget* parent_base, const char* text)
   l->base->internal_derived_free_callback =
     default_internal_derived_free_callback;
   l->base->internal_fit_layout_callback = default_internal_fit_layout_callback;
+  l->base->internal_get_text_callback = default_internal_get_text_callback;
   l->base->internal_render_callback = default_internal_render_callback;
 
   return ok(result_label_ptr, l);
@@ -126,6 +134,40 @@ result_bool label_set_text(label* l, const char* text)
 
   free(l->private_data->text);
   l->private_data->text = duplicated_text;
+  common_internal_invalidate_measured_size(l->base);
+  common_internal_invalidate_glyph_run(&l->private_data->glyph_run);
+
+  common_internal_adjust_layout(l->base);
+
+  return ok(result_bool, true);
+}
+
+result_font_handle label_get_font(const label* l)
+{
+  if(!l)
+  {
+    return error(result_font_handle,
+                 "Cannot get font of a label pointing to NULL!");
+  }
+
+  return ok(result_font_handle, l->private_data->font);
+}
+
+result_bool label_set_font(label* l, font_handle font)
+{
+  if(!l)
+  {
+    return error(result_bool, "Cannot set font of a label pointing to NULL!");
+  }
+
+  if(l->private_data->font == font)
+  {
+    return ok(result_bool, false);
+  }
+
+  l->private_data->font = font;
+  common_internal_invalidate_measured_size(l->base);
+  common_internal_invalidate_glyph_run(&l->private_data->glyph_run);
 
   common_internal_adjust_layout(l->base);
 
@@ -167,6 +209,7 @@ static void default_internal_derived_free_callback(base_widget* widget)
 
   // freeing label text
   free(l->private_data->text);
+  common_internal_free_glyph_run(&l->private_data->glyph_run);
   // freeing label private struct
   free(l->private_data);
   // freeing label object
@@ -181,33 +224,52 @@ default_internal_fit_layout_callback(base_widget* widget, bool call_on_children)
 
   label* l = (label*)widget->derived;
 
-  result_text_dimensions ___ = widget->context->backend->get_text_dimensions(
-    l->private_data->text, widget->context->font, widget->context->font_size);
-  if(!___.ok)
+  // measuring text only if it has changed since last measured
+  text_dimensions dimensions;
+  if(!common_internal_get_measured_size(widget, &dimensions))
   {
-    return error(result_sizing_delta, ___.error);
+    result_text_dimensions ___ =
+      internal_context_measure_text(widget->context,
+                                    l->private_data->text,
+                                    l->private_data->font);
+    if(!___.ok)
+    {
+      return error(result_sizing_delta, ___.error);
+    }
+    dimensions = ___.value;
+    common_internal_set_measured_size(widget, dimensions);
   }
-  text_dimensions dimensions = ___.value;
 
   debug("  > Text: \"%s\", dimensions: %d, %d",
         l->private_data->text,
         dimensions.w,
         dimensions.h);
-  debug(
-    "  > Widget dimensions: %d, %d | padding: %d, %d", widget->w, widget->h);
+  debug("  > Widget dimensions: %d, %d | padding: %d, %d",
+        widget_w(widget),
+        widget_h(widget));
 
-  sizing_delta deltas = {.x = (int16)dimensions.w - (int16)widget->w,
-                         .y = (int16)dimensions.h - (int16)widget->h};
+  sizing_delta deltas = {.x = (int32)dimensions.w - (int32)widget_w(widget),
+                         .y = (int32)dimensions.h - (int32)widget_h(widget)};
 
   info("  > sizing-deltas: (%d, %d)", deltas.x, deltas.y);
 
   // setting widget's sizing, so no need to set need resizing flag
-  widget->w = dimensions.w;
-  widget->h = dimensions.h;
+  widget_w(widget) = dimensions.w;
+  widget_h(widget) = dimensions.h;
 
   return ok(result_sizing_delta, deltas);
 }
 
+static const char*
+default_internal_get_text_callback(const base_widget* widget,
+                                   font_handle* font)
+{
+  const label* l = (const label*)widget->derived;
+  *font = l->private_data->font;
+
+  return l->private_data->text;
+}
+
 static result_bool default_internal_render_callback(const base_widget* widget)
 {
   label* l = (label*)widget->derived;
@@ -217,10 +279,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
        "%d, %d), color: (%d, %d, %d, %d)",
        widget->debug_name,
        l->private_data->text,
-       widget->x,
-       widget->y,
-       widget->w,
-       widget->h,
+       widget_x(widget),
+       widget_y(widget),
+       widget_w(widget),
+       widget_h(widget),
        foreground.r,
        foreground.g,
        foreground.b,
@@ -237,9 +299,11 @@ static result_bool default_internal_render_callback(const base_widget* widget)
     return error(result_bool, _.error);
   }
 
-  result_void ___ = command_buffer_add_render_text_command(
-    widget->context->cmd_buffer,
+  result_void ___ = common_internal_render_text(
+    widget,
+    &l->private_data->glyph_run,
     l->private_data->text,
+    l->private_data->font,
     foreground,
     (point){.x = bounding_rect.x, .y = bounding_rect.y});
   if(!___.ok)
@@ -77,13 +77,12 @@ result_list_view_ptr list_view_new(base_widget* parent_base)
 
   view->base->flexbox_data.container.direction = FLEX_DIRECTION_COLUMN;
   view->base->flexbox_data.container.align_items = ALIGN_ITEMS_START;
-  view->base->flexbox_data.container.cross_axis_sizing =
-    CROSS_AXIS_SIZING_EXPAND;
+  widget_cross_axis_sizing(view->base) = CROSS_AXIS_SIZING_EXPAND;
 
   // list view will expand if there is space remaining in parent widget
-  view->base->flexbox_data.container.flex_grow = 1;
+  widget_flex_grow(view->base) = 1;
   // list view will shrink if there is less space than needed for other widgets
-  view->base->flexbox_data.container.flex_shrink = 1;
+  widget_flex_shrink(view->base) = 1;
 
   view->background = (color){0, 0, 0, 255};
   view->private_data->scroll_offset = 0.0f;
@@ -139,7 +138,7 @@ result_bool list_view_set_scroll_offset(list_view* view,
   // calling post relayout hook for adjusting children offsets
   view->base->post_internal_relayout_hook(view->base);
 
-  return view->base->internal_render_callback(view->base);
+  return common_internal_render(view->base);
 }
 
 /// This private function is passed in `scrollbar_target_descriptor` struct to scrollbar.
@@ -165,7 +164,7 @@ list_view_set_scroll_offset_from_scrollbar(list_view* view,
   // calling post relayout hook for adjusting children offsets
   view->base->post_internal_relayout_hook(view->base);
 
-  return view->base->internal_render_callback(view->base);
+  return common_internal_render(view->base);
 }
 
 static void default_internal_derived_free_callback(base_widget* widget)
@@ -214,21 +213,21 @@ default_internal_fit_layout_callback(base_widget* widget, bool call_on_children)
     }
   }
 
-  uint16 total_width = 0, max_height = 0;
+  uint32 total_width = 0, max_height = 0;
   base_widget_child_node* node = widget->children_head;
   while(node)
   {
-    total_width += node->child->w + widget->flexbox_data.container.gap;
-    max_height = max(max_height, node->child->h);
+    total_width += widget_w(node->child) + widget->flexbox_data.container.gap;
+    max_height = max(max_height, widget_h(node->child));
     node = node->next;
   }
   total_width -= widget->flexbox_data.container.gap;
 
-  sizing_delta deltas = {.x = total_width - widget->w,
-                         .y = max_height - widget->h};
+  sizing_delta deltas = {.x = (int32)total_width - (int32)widget_w(widget),
+                         .y = (int32)max_height - (int32)widget_h(widget)};
 
-  widget->w = total_width;
-  widget->h = max_height;
+  widget_w(widget) = total_width;
+  widget_h(widget) = max_height;
 
   info("  > sizing-deltas: (%d, %d)", deltas.x, deltas.y);
 
@@ -248,20 +247,12 @@ defualt_internal_post_relayout_hook(const base_widget* widget)
     trace("List-View(%s): scroll-offset < 1.0f, avoiding scrolling.",
           widget->debug_name);
     view->private_data->scroll_offset = 0.0f;
-    return ok_void();
+    scroll_offset = 0.0f;
   }
 
-  base_widget_child_node* node = widget->children_head;
-  while(node)
-  {
-    debug(
-      "List-View(%s): child y-coord: %d", widget->debug_name, node->child->y);
-    node->child->y += (int16)scroll_offset;
-    debug("List-View(%s): child y-coord after scroll-offset: %d",
-          widget->debug_name,
-          node->child->y);
-    node = node->next;
-  }
+  // children are laid out unscrolled, scrolling offsets all of them at once
+  common_internal_set_children_offset(
+    view->base, (virtual_point){.x = 0, .y = (int32)scroll_offset});
 
   return ok_void();
 }
@@ -273,10 +264,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   trace("List-View(%s): internal-render-callback(), (x, y, w, h): (%d, %d, %d, "
         "%d), background: (%d, %d, %d, %d)",
         view->base->debug_name,
-        widget->x,
-        widget->y,
-        widget->w,
-        widget->h,
+        widget_x(widget),
+        widget_y(widget),
+        widget_w(widget),
+        widget_h(widget),
         bg.r,
         bg.b,
         bg.g,
@@ -304,31 +295,35 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   uint32 children_height = 0;
   while(node)
   {
-    children_height += node->child->h + widget->flexbox_data.container.gap;
+    children_height +=
+      widget_h(node->child) + widget->flexbox_data.container.gap;
 
-    int16 ycoord = node->child->y, height = node->child->h;
-    if(ycoord + height < widget->y || ycoord > widget->y + (int16)widget->h)
+    // culling in virtual coordinates, rows far out of view don't fit `rect`
+    int64 ycoord = (int64)widget_y(node->child) + widget->children_offset.y,
+          height = widget_h(node->child);
+    if(ycoord + height < 0 || ycoord > (int64)widget_h(widget))
     {
       node = node->next;
       continue;
     }
 
-    node->child->internal_render_callback(node->child);
+    common_internal_render(node->child);
     node = node->next;
   }
   children_height -= widget->flexbox_data.container.gap;
 
   // rendering floating scroll-bar
-  float32 ratio = (float32)widget->h / children_height;
+  float32 ratio = (float32)widget_h(widget) / children_height;
   uint8 edge_padding = 2, scrollbar_width = 7,
-        scrollbar_height = ratio * widget->h;
+        scrollbar_height = ratio * widget_h(widget);
   _ = command_buffer_add_render_rounded_rect_command(
     widget->context->cmd_buffer,
-    (rect){.x = widget->x + widget->w - (scrollbar_width + edge_padding),
-           .y = widget->y + edge_padding -
+    (rect){.x = bounding_rect.x + widget_w(widget) -
+                (scrollbar_width + edge_padding),
+           .y = bounding_rect.y + edge_padding -
                 view->private_data->scroll_offset * ratio,
            .w = scrollbar_width,
-           .h = ratio * (widget->h - 2 * edge_padding)},
+           .h = ratio * (widget_h(widget) - 2 * edge_padding)},
     3,
     (color){255, 255, 255, 128});
   if(!_.ok)
@@ -357,12 +352,13 @@ static bool default_mouse_scroll_callback(base_widget* widget,
   base_widget_child_node* node = widget->children_head;
   while(node)
   {
-    required_view_height += node->child->h + widget->flexbox_data.container.gap;
+    required_view_height +=
+      widget_h(node->child) + widget->flexbox_data.container.gap;
     node = node->next;
   }
   required_view_height -= widget->flexbox_data.container.gap;
 
-  if(required_view_height < widget->h)
+  if(required_view_height < widget_h(widget))
   {
     return false;
   }
@@ -370,59 +366,44 @@ static bool default_mouse_scroll_callback(base_widget* widget,
   list_view* view = (list_view*)widget->derived;
 
   float32 delta_y = event.delta_y * view->private_data->scroll_acceleration;
-  view->private_data->scroll_offset += (int16)delta_y;
+  view->private_data->scroll_offset += (int32)delta_y;
 
   if(view->private_data->scroll_offset > 0.0f)
   {
     view->private_data->scroll_offset = 0.0f;
-    node = widget->children_head;
-    if(node && node->child->y == widget->y)
+    if(widget->children_offset.y == 0)
     {
       return false;
     }
-    int16 y = widget->y;
-    while(node)
-    {
-      node->child->y = y;
-      y += node->child->h + widget->flexbox_data.container.gap;
-      node = node->next;
-    }
-    widget->internal_render_callback(widget);
+    common_internal_set_children_offset(widget,
+                                        (virtual_point){.x = 0, .y = 0});
+    common_internal_render(widget);
     return true;
   }
 
-  int16 extended_height = (int32)widget->h - (int32)required_view_height;
+  int32 extended_height = (int32)widget_h(widget) - (int32)required_view_height;
   debug(
     "widget-h: %d, required-height: %d, scroll-offset: %f, extended-height: %d",
-    widget->h,
+    widget_h(widget),
     required_view_height,
     view->private_data->scroll_offset,
     extended_height);
 
   if(view->private_data->scroll_offset < extended_height)
   {
-    view->private_data->scroll_offset =
-      (int16)widget->h - (int16)required_view_height;
-    int16 y = widget->y + view->private_data->scroll_offset;
-    node = widget->children_head;
-    while(node)
-    {
-      node->child->y = y;
-      y += node->child->h + widget->flexbox_data.container.gap;
-      node = node->next;
-    }
-    widget->internal_render_callback(widget);
+    view->private_data->scroll_offset = extended_height;
+    common_internal_set_children_offset(
+      widget,
+      (virtual_point){.x = 0, .y = (int32)view->private_data->scroll_offset});
+    common_internal_render(widget);
     return true;
   }
 
-  node = widget->children_head;
-  while(node)
-  {
-    node->child->y += (int16)delta_y;
-    node = node->next;
-  }
+  common_internal_set_children_offset(
+    widget,
+    (virtual_point){.x = 0, .y = (int32)view->private_data->scroll_offset});
 
-  result_bool _ = widget->internal_render_callback(widget);
+  result_bool _ = common_internal_render(widget);
   if(!_.ok)
   {
     return false;
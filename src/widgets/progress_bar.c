@@ -129,7 +129,7 @@ result_void progress_bar_set_percent(progress_bar* bar, uint8 percent)
   }
 
   bar->private_data->percent = percent;
-  bar->base->internal_render_callback(bar->base);
+  common_internal_render(bar->base);
 
   return ok_void();
 }
@@ -165,7 +165,7 @@ result_void progress_bar_set_background(progress_bar* bar, color background)
   }
 
   bar->private_data->background = background;
-  bar->base->internal_render_callback(bar->base);
+  common_internal_render(bar->base);
 
   return ok_void();
 }
@@ -177,10 +177,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   trace("Progress-Bar(%s): internal-render(), (x, y, w, h): (%d, %d, %d, %d), "
         "background: (%d, %d, %d, %d), foreground: (%d, %d, %d, %d)",
         widget->debug_name,
-        widget->x,
-        widget->y,
-        widget->w,
-        widget->h,
+        widget_x(widget),
+        widget_y(widget),
+        widget_w(widget),
+        widget_h(widget),
         bg.r,
         bg.g,
         bg.b,
@@ -112,7 +112,7 @@ scrollbar_new(base_widget* parent_base,
   bar->base->mouse_enter_callback = default_mouse_enter_callback;
   bar->base->mouse_leave_callback = default_mouse_leave_callback;
 
-  bar->base->flexbox_data.item.flex_grow = 1;
+  widget_flex_grow(bar->base) = 1;
 
   // assigning descriptors
   bar->descriptor =
@@ -192,7 +192,7 @@ scrollbar_update_target_content_length(scrollbar* bar,
 
   bar->private_data->target_descriptor.content_length = new_content_length;
 
-  result_bool _ = default_internal_render_callback(bar->base);
+  result_bool _ = common_internal_render(bar->base);
   if(!_.ok)
   {
     return error(result_void, _.error);
@@ -214,7 +214,7 @@ scrollbar_update_target_scroll_offset(scrollbar* bar,
 
   bar->private_data->target_descriptor.scroll_offset = new_scroll_offset;
 
-  result_bool _ = default_internal_render_callback(bar->base);
+  result_bool _ = common_internal_render(bar->base);
   if(!_.ok)
   {
     return error(result_void, _.error);
@@ -248,9 +248,9 @@ default_internal_fit_layout_callback(base_widget* widget, bool call_on_children)
   scrollbar* bar = (scrollbar*)widget->derived;
 
   uint16 new_w = bar->descriptor.cross_axis_width;
-  widget->w = new_w;
+  widget_w(widget) = new_w;
 
-  sizing_delta deltas = {.x = (int16)new_w - (int16)widget->w, .y = 0};
+  sizing_delta deltas = {.x = (int32)new_w - (int32)widget_w(widget), .y = 0};
 
   return ok(result_sizing_delta, deltas);
 }
@@ -261,10 +261,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
 
   trace("Scrollbar(%s): internal-render(), (x, y, w, h): (%d, %d, %d, %d)",
         widget->debug_name,
-        widget->x,
-        widget->y,
-        widget->w,
-        widget->h);
+        widget_x(widget),
+        widget_y(widget),
+        widget_w(widget),
+        widget_h(widget));
 
   rect bounding_rect = common_internal_get_bounding_rect(widget);
 
@@ -277,16 +277,17 @@ static result_bool default_internal_render_callback(const base_widget* widget)
 
   // ratio of view-port length to content-length of target.
   // here length implies width or height of target, according to type of scrollbar.
-  float32 ratio = (float32)(bar->private_data->target_descriptor.base->h) /
-                  (int32)(bar->private_data->target_descriptor.content_length);
+  float32 ratio =
+    (float32)(widget_h(bar->private_data->target_descriptor.base)) /
+    (int32)(bar->private_data->target_descriptor.content_length);
 
   // adjusting bounding rect for scroll thumb
   bounding_rect.y += ratio * bar->private_data->target_descriptor.scroll_offset;
-  bounding_rect.h = (uint16)ratio * widget->h;
+  bounding_rect.h = (uint16)ratio * widget_h(widget);
   trace("Scrollbar(%s): target_base_height: %d, content_length: %d, "
         "bounding_rect_height: %d",
         widget->debug_name,
-        bar->private_data->target_descriptor.base->h,
+        widget_h(bar->private_data->target_descriptor.base),
         bar->private_data->target_descriptor.content_length,
         bounding_rect.h);
 
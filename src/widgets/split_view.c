@@ -29,6 +29,8 @@ split* split_new();
 
 static void split_internal_derived_free_callback(base_widget* widget);
 
+static void default_internal_derived_free_callback(base_widget* widget);
+
 static result_sizing_delta
 default_internal_fit_layout_callback(base_widget* widget,
                                      bool call_on_children);
@@ -134,6 +136,8 @@ result_split_view_ptr split_view_new(base_widget* parent_base, split_type type)
   v->base->internal_fit_layout_callback = default_internal_fit_layout_callback;
   v->base->pre_internal_relayout_hook = default_pre_internal_relayout_hook;
   v->base->internal_render_callback = default_internal_render_callback;
+  v->base->internal_derived_free_callback =
+    default_internal_derived_free_callback;
   splitter->base->internal_derived_free_callback =
     split_internal_derived_free_callback;
 
@@ -156,18 +160,17 @@ result_split_view_ptr split_view_new(base_widget* parent_base, split_type type)
   first_container->background = (color){0, 0, 0, 255};
   second_container->background = (color){16, 16, 16, 255};
 
-  splitter->base->flexbox_data.item.cross_axis_sizing =
-    CROSS_AXIS_SIZING_EXPAND;
+  widget_cross_axis_sizing(splitter->base) = CROSS_AXIS_SIZING_EXPAND;
   splitter->base->internal_render_callback = split_internal_render_callback;
   if(type == SPLIT_HORIZONTAL)
   {
-    splitter->base->w = v->base->w;
-    splitter->base->h = v->handle_size;
+    widget_w(splitter->base) = widget_w(v->base);
+    widget_h(splitter->base) = v->handle_size;
   }
   else
   {
-    splitter->base->w = v->handle_size;
-    splitter->base->h = v->base->h;
+    widget_w(splitter->base) = v->handle_size;
+    widget_h(splitter->base) = widget_h(v->base);
   }
 
   return ok(result_split_view_ptr, v);
@@ -225,7 +228,7 @@ split* split_new()
   }
   s->private_data->state = HANDLE_NORMAL;
   s->private_data->last_clicked = (point){0, 0};
-  s->private_data->first_pane_length = s->base->w * 0.5f;
+  s->private_data->first_pane_length = widget_w(s->base) * 0.5f;
 
   return s;
 }
@@ -238,6 +241,12 @@ static void split_internal_derived_free_callback(base_widget* widget)
   free(s);
 }
 
+static void default_internal_derived_free_callback(base_widget* widget)
+{
+  // freeing split view object, panes & splitter are freed with the tree
+  free(widget->derived);
+}
+
 static result_bool split_internal_render_callback(const base_widget* widget)
 {
   split* s = (split*)widget->derived;
@@ -249,10 +258,10 @@ static result_bool split_internal_render_callback(const base_widget* widget)
 
   info("SplitView(): split.internal-render-callback(), (x, y, w, h): (%d, %d, "
        "%d, %d), color: (%d, %d, %d, %d)",
-       widget->x,
-       widget->y,
-       widget->w,
-       widget->h,
+       widget_x(widget),
+       widget_y(widget),
+       widget_w(widget),
+       widget_h(widget),
        bg.r,
        bg.g,
        bg.b,
@@ -260,7 +269,7 @@ static result_bool split_internal_render_callback(const base_widget* widget)
 
   result_void _ = command_buffer_add_render_rect_command(
     widget->context->cmd_buffer,
-    (rect){widget->x, widget->y, widget->w, widget->h},
+    common_internal_get_bounding_rect(widget),
     bg);
   if(!_.ok)
   {
@@ -282,21 +291,21 @@ static result_void default_pre_internal_relayout_hook(const base_widget* widget)
     ((split*)(splitter_node->child->derived))->private_data->first_pane_length;
   if(s->type == SPLIT_VERTICAL)
   {
-    first_container->child->w = first_pane_length;
-    second_container->child->w =
-      widget->w - splitter_node->child->w - first_pane_length;
-    first_container->child->h = widget->h;
-    second_container->child->h = widget->h;
-    splitter_node->child->h = widget->h;
+    widget_w(first_container->child) = first_pane_length;
+    widget_w(second_container->child) =
+      widget_w(widget) - widget_w(splitter_node->child) - first_pane_length;
+    widget_h(first_container->child) = widget_h(widget);
+    widget_h(second_container->child) = widget_h(widget);
+    widget_h(splitter_node->child) = widget_h(widget);
   }
   else
   {
-    first_container->child->w = widget->w;
-    second_container->child->w = widget->w;
-    splitter_node->child->w = widget->w;
-    first_container->child->h = first_pane_length;
-    second_container->child->h =
-      widget->h - splitter_node->child->h - first_pane_length;
+    widget_w(first_container->child) = widget_w(widget);
+    widget_w(second_container->child) = widget_w(widget);
+    widget_w(splitter_node->child) = widget_w(widget);
+    widget_h(first_container->child) = first_pane_length;
+    widget_h(second_container->child) =
+      widget_h(widget) - widget_h(splitter_node->child) - first_pane_length;
   }
 
   return ok_void();
@@ -330,21 +339,23 @@ default_internal_fit_layout_callback(base_widget* widget, bool call_on_children)
 
   split_view* v = (split_view*)widget->derived;
 
-  uint16 new_w = v->type == SPLIT_HORIZONTAL
-                   ? (first_child ? first_child->w : 0) + v->handle_size +
-                       (second_child ? second_child->w : 0)
-                   : max(first_child ? first_child->w : 0,
-                         second_child ? second_child->w : 0);
-  uint16 new_h = v->type == SPLIT_HORIZONTAL
-                   ? max(first_child ? first_child->h : 0,
-                         second_child ? second_child->h : 0)
-                   : (first_child ? first_child->h : 0) + v->handle_size +
-                       (second_child ? second_child->h : 0);
-  sizing_delta deltas = {.x = (int16)new_w - (int16)widget->w,
-                         .y = (int16)new_h - (int16)widget->h};
-
-  widget->w = new_w;
-  widget->h = new_h;
+  uint32 new_w = v->type == SPLIT_HORIZONTAL
+                   ? (first_child ? widget_w(first_child) : 0) +
+                       v->handle_size +
+                       (second_child ? widget_w(second_child) : 0)
+                   : max(first_child ? widget_w(first_child) : 0,
+                         second_child ? widget_w(second_child) : 0);
+  uint32 new_h = v->type == SPLIT_HORIZONTAL
+                   ? max(first_child ? widget_h(first_child) : 0,
+                         second_child ? widget_h(second_child) : 0)
+                   : (first_child ? widget_h(first_child) : 0) +
+                       v->handle_size +
+                       (second_child ? widget_h(second_child) : 0);
+  sizing_delta deltas = {.x = (int32)new_w - (int32)widget_w(widget),
+                         .y = (int32)new_h - (int32)widget_h(widget)};
+
+  widget_w(widget) = new_w;
+  widget_h(widget) = new_h;
 
   return ok(result_sizing_delta, deltas);
 }
@@ -373,7 +384,7 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   {
     if(temp->child->internal_render_callback)
     {
-      temp->child->internal_render_callback(temp->child);
+      common_internal_render(temp->child);
     }
     temp = temp->next;
   }
@@ -399,7 +410,7 @@ static bool split_mouse_button_down_callback(base_widget* widget,
   v->private_data->state = HANDLE_CLICKED;
   v->private_data->last_clicked = (point){event.x, event.y};
 
-  result_bool _ = widget->internal_render_callback(widget);
+  result_bool _ = common_internal_render(widget);
   if(!_.ok)
   {
     return false;
@@ -418,7 +429,7 @@ static bool split_mouse_button_up_callback(base_widget* widget,
 
   v->private_data->state = HANDLE_NORMAL;
 
-  result_bool _ = widget->internal_render_callback(widget);
+  result_bool _ = common_internal_render(widget);
   if(!_.ok)
   {
     return false;
@@ -443,7 +454,7 @@ static bool split_mouse_enter_callback(base_widget* widget,
       return false;
     }
 
-    widget->w += 3;
+    widget_w(widget) += 3;
   }
   else
   {
@@ -454,11 +465,11 @@ static bool split_mouse_enter_callback(base_widget* widget,
       return false;
     }
 
-    widget->h += 3;
+    widget_h(widget) += 3;
   }
 
   common_internal_relayout(widget->parent);
-  widget->parent->internal_render_callback(widget->parent);
+  common_internal_render(widget->parent);
 
   return true;
 }
@@ -472,15 +483,15 @@ static bool split_mouse_leave_callback(base_widget* widget,
 
   if(((split_view*)(widget->parent->derived))->type == SPLIT_VERTICAL)
   {
-    widget->w -= 3;
+    widget_w(widget) -= 3;
   }
   else
   {
-    widget->h -= 3;
+    widget_h(widget) -= 3;
   }
 
   common_internal_relayout(widget->parent);
-  widget->parent->internal_render_callback(widget->parent);
+  common_internal_render(widget->parent);
 
   command_buffer_add_set_cursor_command(widget->context->cmd_buffer,
                                         SET_CURSOR_ARROW);
@@ -505,15 +516,15 @@ static bool split_mouse_move_callback(base_widget* widget,
   if(type == SPLIT_VERTICAL)
   {
     int16 delta = v->private_data->last_clicked.x - event.x;
-    first_child->w -= delta;
-    second_child->w += delta;
+    widget_w(first_child) -= delta;
+    widget_w(second_child) += delta;
     v->private_data->first_pane_length -= delta;
   }
   else
   {
     int16 delta = v->private_data->last_clicked.y - event.y;
-    first_child->h -= delta;
-    second_child->h += delta;
+    widget_h(first_child) -= delta;
+    widget_h(second_child) += delta;
     v->private_data->first_pane_length -= delta;
   }
 
@@ -521,7 +532,7 @@ static bool split_mouse_move_callback(base_widget* widget,
 
   common_internal_relayout(parent);
 
-  parent->internal_render_callback(parent);
+  common_internal_render(parent);
 
   return true;
 }
@@ -161,10 +161,10 @@ static result_bool default_internal_render_callback(const base_widget* widget)
   trace("Toggle(%s): internal-render(), (x, y, w, h): (%d, %d, %d, %d), "
         "background: (%d, %d, %d, %d), handle-color: (%d, %d, %d, %d)",
         widget->debug_name,
-        widget->x,
-        widget->y,
-        widget->w,
-        widget->h,
+        widget_x(widget),
+        widget_y(widget),
+        widget_w(widget),
+        widget_h(widget),
         background.r,
         background.g,
         background.b,
@@ -250,7 +250,7 @@ static bool default_mouse_button_down_callback(base_widget* widget,
   }
 
   // updating UI
-  result_bool _ = widget->internal_render_callback(widget);
+  result_bool _ = common_internal_render(widget);
   if(!_.ok)
   {
     return false;
@@ -0,0 +1,531 @@
+// smoll-bench-layout
+// Builds synthetic widget trees and times layout passes over them, against
+// a stub backend which needs no window. Reports median & p99 times of each
+// pass, for growing tree sizes, as JSON on stdout.
+//
+// Usage: smoll-bench-layout [--scenario <name>] [--max-size <count>]
+//                           [--samples <count>] [--threads <count>]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/backend.h"
+#include "../../include/macros.h"
+#include "../../include/smoll_context.h"
+#include "../../include/widgets/box.h"
+#include "../../include/widgets/label.h"
+#include "../../include/widgets/list_view.h"
+#include "../../include/widgets/split_view.h"
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif
+
+#define VIEWPORT_WIDTH 1280
+#define VIEWPORT_HEIGHT 720
+
+/// Number of trees built for timing `smoll_context_initialize_layout()`.
+#define INITIALIZE_LAYOUT_SAMPLES 5
+
+/// Gives monotonic time in nanoseconds.
+static uint64 clock_now_ns()
+{
+#ifdef _WIN32
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (uint64)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64)now.tv_sec * 1000000000ull + (uint64)now.tv_nsec;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Stub Backend
+/// Measures text deterministically and drops every command, so only the
+/// cost of layouting is timed.
+///////////////////////////////////////////////////////////////////////////////
+
+/// Size of the last loaded font, texts of all fonts are measured with it.
+static uint8 stub_backend_font_size = 0;
+
+static result_void stub_backend_load_font(font_handle font,
+                                          const char* font_name,
+                                          uint8 font_size)
+{
+  (void)font;
+  (void)font_name;
+
+  stub_backend_font_size = font_size;
+  return ok_void();
+}
+
+static result_text_dimensions stub_backend_get_text_dimensions(
+  const char* text, font_handle font)
+{
+  (void)font;
+
+  uint8 font_size = stub_backend_font_size;
+  text_dimensions dimensions = {.w = (uint16)(strlen(text) * font_size / 2),
+                                .h = font_size};
+  return ok(result_text_dimensions, dimensions);
+}
+
+static result_void stub_backend_process_command(const command* cmd)
+{
+  (void)cmd;
+  return ok_void();
+}
+
+static result_void
+stub_backend_process_command_buffer(const command_buffer* cmd_buffer)
+{
+  (void)cmd_buffer;
+  return ok_void();
+}
+
+static render_backend stub_backend = {
+  .name = "stub",
+  .backend_version = {1, 0, 0},
+  .load_font = stub_backend_load_font,
+  .get_text_dimensions = stub_backend_get_text_dimensions,
+  .process_command = stub_backend_process_command,
+  .process_command_buffer = stub_backend_process_command_buffer,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Tree Generators
+/// Each generator builds a tree of the given size under root, and gives a
+/// leaf label whose text is changed for timing single leaf re-layouts.
+///////////////////////////////////////////////////////////////////////////////
+
+/// Boxes nested `size` levels deep, alternating direction, each holding a
+/// label next to the nested box.
+static label* generate_deep(base_widget* root, uint32 size)
+{
+  base_widget* parent = root;
+  label* leaf = NULL;
+  for(uint32 i = 0; i < size; i++)
+  {
+    box* b =
+      box_new(parent, i % 2 ? FLEX_DIRECTION_ROW : FLEX_DIRECTION_COLUMN)
+        .value;
+    leaf = label_new(b->base, "nested").value;
+    parent = b->base;
+  }
+
+  return leaf;
+}
+
+/// One row of `size` labels.
+static label* generate_wide(base_widget* root, uint32 size)
+{
+  box* row = box_new(root, FLEX_DIRECTION_ROW).value;
+  label* leaf = NULL;
+  for(uint32 i = 0; i < size; i++)
+  {
+    label* l = label_new(row->base, i % 3 ? "cell" : "wider cell").value;
+    if(i == size / 2)
+    {
+      leaf = l;
+    }
+  }
+
+  return leaf;
+}
+
+/// List view of `size` rows, filling the root.
+static label* generate_list(base_widget* root, uint32 size)
+{
+  list_view* view = list_view_new(root).value;
+  widget_flex_grow(view->base) = 1;
+  widget_cross_axis_sizing(view->base) = CROSS_AXIS_SIZING_EXPAND;
+
+  label* leaf = NULL;
+  for(uint32 i = 0; i < size; i++)
+  {
+    label* l = label_new(view->base, "list row").value;
+    if(!leaf)
+    {
+      leaf = l;
+    }
+  }
+
+  return leaf;
+}
+
+static base_widget* new_split_pane(uint32 depth, label** leaf)
+{
+  if(!depth)
+  {
+    label* l = label_new(NULL, "pane").value;
+    if(!*leaf)
+    {
+      *leaf = l;
+    }
+    return l->base;
+  }
+
+  return split_view_new(NULL, depth % 2 ? SPLIT_VERTICAL : SPLIT_HORIZONTAL)
+    .value->base;
+}
+
+/// Connects panes of split view, then splits panes further. Built from top
+/// to bottom as widgets get context of their parent when being added.
+static void generate_split_subtree(base_widget* split,
+                                   uint32 depth,
+                                   label** leaf)
+{
+  base_widget* first = new_split_pane(depth - 1, leaf);
+  base_widget* second = new_split_pane(depth - 1, leaf);
+  split_view_connect_children((split_view*)split->derived, first, second);
+
+  if(depth > 1)
+  {
+    generate_split_subtree(first, depth - 1, leaf);
+    generate_split_subtree(second, depth - 1, leaf);
+  }
+}
+
+/// Split views nested `size` levels deep, with `2^size` panes.
+static label* generate_split(base_widget* root, uint32 size)
+{
+  label* leaf = NULL;
+  base_widget* split = new_split_pane(size, &leaf);
+  widget_flex_grow(split) = 1;
+  base_widget_add_child(root, split);
+  generate_split_subtree(split, size, &leaf);
+
+  return leaf;
+}
+
+/// Column of rows with about `size` widgets in total. Children of rows mix
+/// flex-grow, flex-shrink & cross-axis sizing.
+static label* generate_mixed(base_widget* root, uint32 size)
+{
+  box* column = box_new(root, FLEX_DIRECTION_COLUMN).value;
+  widget_flex_grow(column->base) = 1;
+
+  label* leaf = NULL;
+  uint32 rows_count = max(size / 9, 1);
+  for(uint32 i = 0; i < rows_count; i++)
+  {
+    box* row = box_new(column->base, FLEX_DIRECTION_ROW).value;
+    widget_cross_axis_sizing(row->base) = CROSS_AXIS_SIZING_EXPAND;
+    row->base->flexbox_data.container.align_items = i % 3;
+    for(uint32 j = 0; j < 8; j++)
+    {
+      label* l = label_new(row->base, j % 2 ? "grow" : "shrink me").value;
+      widget_flex_grow(l->base) = j % 2;
+      widget_flex_shrink(l->base) = !(j % 2);
+      widget_cross_axis_sizing(l->base) = j % 3 == 0;
+      if(i == rows_count / 2 && j == 0)
+      {
+        leaf = l;
+      }
+    }
+  }
+
+  return leaf;
+}
+
+/// Scenarios which can be benchmarked, with tree sizes of scaling curve.
+/// Add an entry here to benchmark another kind of tree.
+static const struct
+{
+  const char* name;
+  label* (*generate)(base_widget* root, uint32 size);
+  uint32 sizes[5];
+} scenarios[] = {
+  {"deep", generate_deep, {10, 100, 1000, 5000, 0}},
+  {"wide", generate_wide, {100, 1000, 10000, 100000, 0}},
+  {"list", generate_list, {1000, 10000, 100000, 1000000, 0}},
+  {"split", generate_split, {2, 4, 8, 12, 0}},
+  {"mixed", generate_mixed, {1000, 10000, 100000, 0}},
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Benchmark
+///////////////////////////////////////////////////////////////////////////////
+
+/// Times of one kind of layout pass.
+typedef struct timings
+{
+  uint64* times_ns;
+  uint32 count;
+} timings;
+
+/// Context with a generated tree.
+typedef struct bench_tree
+{
+  smoll_context* context;
+  base_widget* root;
+  label* leaf;
+} bench_tree;
+
+static bool build_tree(uint32 scenario,
+                       uint32 size,
+                       uint16 threads_count,
+                       bench_tree* tree)
+{
+  result_smoll_context_ptr _ =
+    smoll_context_create(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+  if(!_.ok)
+  {
+    fprintf(stderr, "Error: %s\n", _.error);
+    return false;
+  }
+  smoll_context* context = _.value;
+
+  smoll_context_register_backend(context, &stub_backend);
+  smoll_context_set_default_font(context, "stub", 14);
+  if(threads_count)
+  {
+    smoll_context_set_parallel_layout(context, threads_count);
+  }
+
+  result_box_ptr __ = box_new(NULL, FLEX_DIRECTION_ROW);
+  if(!__.ok)
+  {
+    fprintf(stderr, "Error: %s\n", __.error);
+    smoll_context_destroy(context);
+    return false;
+  }
+  box* root = __.value;
+  root->base->flexbox_data.container.is_fluid = false;
+  smoll_context_set_root_widget(context, root->base);
+
+  tree->context = context;
+  tree->root = root->base;
+  tree->leaf = scenarios[scenario].generate(root->base, size);
+
+  return true;
+}
+
+static void record_time(timings* t, uint64 begin_ns)
+{
+  t->times_ns[t->count++] = clock_now_ns() - begin_ns;
+}
+
+static int compare_u64(const void* a, const void* b)
+{
+  uint64 x = *(const uint64*)a, y = *(const uint64*)b;
+  return (x > y) - (x < y);
+}
+
+static void print_timings(const char* name, timings* t, bool last)
+{
+  if(!t->count)
+  {
+    printf("        \"%s\": {\"samples\": 0}%s\n", name, last ? "" : ",");
+    return;
+  }
+
+  qsort(t->times_ns, t->count, sizeof(uint64), compare_u64);
+
+  uint64* times = t->times_ns;
+  uint32 count = t->count;
+  printf("        \"%s\": {\"samples\": %u, \"median_us\": %.3f, "
+         "\"p99_us\": %.3f, \"min_us\": %.3f, \"max_us\": %.3f}%s\n",
+         name,
+         count,
+         (double)times[count / 2] / 1e3,
+         (double)times[(uint32)((uint64)(count - 1) * 99 / 100)] / 1e3,
+         (double)times[0] / 1e3,
+         (double)times[count - 1] / 1e3,
+         last ? "" : ",");
+}
+
+/// Benchmarks one tree size of scenario, printing its JSON object.
+static bool bench(uint32 scenario,
+                  uint32 size,
+                  uint32 samples,
+                  uint16 threads_count,
+                  bool first)
+{
+  uint64* times_ns = (uint64*)malloc(
+    (INITIALIZE_LAYOUT_SAMPLES + 2 * samples) * sizeof(uint64));
+  if(!times_ns)
+  {
+    fprintf(stderr, "Error: Unable to allocate memory for times!\n");
+    return false;
+  }
+
+  timings initialize_layout = {.times_ns = times_ns, .count = 0};
+  timings resize = {.times_ns = times_ns + INITIALIZE_LAYOUT_SAMPLES,
+                    .count = 0};
+  timings leaf_adjust = {
+    .times_ns = times_ns + INITIALIZE_LAYOUT_SAMPLES + samples, .count = 0};
+
+  // building fresh tree for every sample, as layout of a laid out tree
+  // is incremental. last tree is kept for other passes.
+  bench_tree tree = {0};
+  for(uint32 i = 0; i < INITIALIZE_LAYOUT_SAMPLES; i++)
+  {
+    if(tree.context)
+    {
+      smoll_context_destroy(tree.context);
+    }
+    if(!build_tree(scenario, size, threads_count, &tree))
+    {
+      free(times_ns);
+      return false;
+    }
+
+    uint64 begin_ns = clock_now_ns();
+    smoll_context_initialize_layout(tree.context);
+    record_time(&initialize_layout, begin_ns);
+  }
+
+  smoll_context_initial_render(tree.context);
+  smoll_context_render(tree.context);
+
+  // resize storm, viewport jitters around its size like a dragged window
+  for(uint32 i = 0; i < samples; i++)
+  {
+    int32 jitter = (int32)(i * 37 % 101) - 50;
+    viewport_resize_event event = {.w = (uint16)(VIEWPORT_WIDTH + jitter),
+                                   .h = (uint16)(VIEWPORT_HEIGHT - jitter)};
+
+    uint64 begin_ns = clock_now_ns();
+    smoll_context_process_viewport_resize_event(tree.context, event);
+    record_time(&resize, begin_ns);
+
+    smoll_context_render(tree.context);
+  }
+
+  // single leaf changing its size, re-layouting its affected ancestors
+  for(uint32 i = 0; i < samples; i++)
+  {
+    const char* text = i % 2 ? "leaf" : "resized leaf";
+
+    uint64 begin_ns = clock_now_ns();
+    label_set_text(tree.leaf, text);
+    record_time(&leaf_adjust, begin_ns);
+
+    smoll_context_render(tree.context);
+  }
+
+  printf("%s    {\n", first ? "" : ",\n");
+  printf("      \"scenario\": \"%s\",\n", scenarios[scenario].name);
+  printf("      \"size\": %u,\n", size);
+  // descendants are counted while laying out
+  printf("      \"widgets\": %u,\n", tree.root->descendants_count + 1);
+  printf("      \"timings\": {\n");
+  print_timings("initialize_layout", &initialize_layout, false);
+  print_timings("resize", &resize, false);
+  print_timings("leaf_adjust", &leaf_adjust, true);
+  printf("      }\n");
+  printf("    }");
+  fflush(stdout);
+
+  smoll_context_destroy(tree.context);
+  free(times_ns);
+
+  return true;
+}
+
+static void print_usage()
+{
+  fprintf(stderr,
+          "Usage: smoll-bench-layout [--scenario <name>] [--max-size <count>] "
+          "[--samples <count>] [--threads <count>]\n");
+  fprintf(stderr, "Scenarios:");
+  for(size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+  {
+    fprintf(stderr, " %s", scenarios[i].name);
+  }
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char** argv)
+{
+  const char* scenario_name = NULL;
+  uint32 max_size = UINT32_MAX;
+  uint32 samples = 50;
+  uint16 threads_count = 0;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--scenario") && i + 1 < argc)
+    {
+      scenario_name = argv[++i];
+    }
+    else if(!strcmp(argv[i], "--max-size") && i + 1 < argc)
+    {
+      max_size = (uint32)strtoul(argv[++i], NULL, 10);
+    }
+    else if(!strcmp(argv[i], "--samples") && i + 1 < argc)
+    {
+      samples = (uint32)strtoul(argv[++i], NULL, 10);
+    }
+    else if(!strcmp(argv[i], "--threads") && i + 1 < argc)
+    {
+      threads_count = (uint16)strtoul(argv[++i], NULL, 10);
+    }
+    else
+    {
+      print_usage();
+      return 1;
+    }
+  }
+
+  if(samples < 1)
+  {
+    print_usage();
+    return 1;
+  }
+
+  bool found = !scenario_name;
+  for(size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+  {
+    found |= scenario_name && !strcmp(scenarios[i].name, scenario_name);
+  }
+  if(!found)
+  {
+    fprintf(stderr, "Error: Unknown scenario: %s\n", scenario_name);
+    print_usage();
+    return 1;
+  }
+
+  printf("{\n");
+  printf("  \"benchmark\": \"smoll-bench-layout\",\n");
+  printf("  \"viewport\": {\"w\": %u, \"h\": %u},\n",
+         VIEWPORT_WIDTH,
+         VIEWPORT_HEIGHT);
+  printf("  \"threads\": %u,\n", threads_count);
+  printf("  \"results\": [\n");
+
+  bool first = true;
+  for(uint32 i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+  {
+    if(scenario_name && strcmp(scenarios[i].name, scenario_name))
+    {
+      continue;
+    }
+
+    for(uint32 j = 0; scenarios[i].sizes[j]; j++)
+    {
+      if(scenarios[i].sizes[j] > max_size)
+      {
+        break;
+      }
+
+      if(!bench(i, scenarios[i].sizes[j], samples, threads_count, first))
+      {
+        return 1;
+      }
+      first = false;
+    }
+  }
+
+  printf("\n  ]\n");
+  printf("}\n");
+
+  return 0;
+}
@@ -0,0 +1,518 @@
+// smoll-replay
+// Replays a recorded command stream into a render backend, as fast as
+// possible, and reports throughput and per frame time of the backend.
+//
+// Usage: smoll-replay <recording> [--backend <name>] [--repeat <count>]
+//                     [--per-frame]
+//
+// Backends: null, and cairo-image if built with cairo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/backend.h"
+#include "../../include/command_stream.h"
+#include "../../include/macros.h"
+
+#ifdef SMOLL_REPLAY_CAIRO
+#  include "../../backends/cairo/cairo_renderer.h"
+#endif
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif
+
+/// Gives monotonic time in nanoseconds.
+static uint64 clock_now_ns()
+{
+#ifdef _WIN32
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (uint64)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64)now.tv_sec * 1000000000ull + (uint64)now.tv_nsec;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Null Backend
+/// Touches data of every command, without rendering anything. Measures the
+/// cost of walking command buffers, and is the baseline for other backends.
+///////////////////////////////////////////////////////////////////////////////
+
+static volatile uint64 null_backend_checksum = 0;
+
+/// Size of the last loaded font, texts of all fonts are measured with it.
+static uint8 null_backend_font_size = 0;
+
+static result_void null_backend_load_font(font_handle font,
+                                          const char* font_name,
+                                          uint8 font_size)
+{
+  (void)font;
+  (void)font_name;
+
+  null_backend_font_size = font_size;
+  return ok_void();
+}
+
+static result_text_dimensions null_backend_get_text_dimensions(
+  const char* text, font_handle font)
+{
+  (void)font;
+
+  uint8 font_size = null_backend_font_size;
+  text_dimensions dimensions = {.w = (uint16)(strlen(text) * font_size / 2),
+                                .h = font_size};
+  return ok(result_text_dimensions, dimensions);
+}
+
+static result_void null_backend_process_command(const command* cmd)
+{
+  uint64 checksum = cmd->type;
+  switch(cmd->type)
+  {
+  case RENDER_TEXT: {
+    checksum += cmd->data.render_text.text_length;
+    checksum += (uint8)cmd->data.render_text.text[0];
+    break;
+  }
+  case RENDER_GLYPH_RUN: {
+    checksum += cmd->data.render_glyph_run.glyphs_count;
+    checksum += cmd->data.render_glyph_run.glyphs[0].index;
+    break;
+  }
+  case RENDER_RECT:
+  case RENDER_RECT_OUTLINED: {
+    checksum += cmd->data.render_rect.bounding_rect.w;
+    break;
+  }
+  case RENDER_RECTS: {
+    for(uint16 i = 0; i < cmd->data.render_rects.rects_count; i++)
+    {
+      checksum += cmd->data.render_rects.rects[i].w;
+    }
+    break;
+  }
+  default:
+    break;
+  }
+
+  null_backend_checksum += checksum;
+
+  return ok_void();
+}
+
+static result_void
+null_backend_process_command_buffer(const command_buffer* cmd_buffer)
+{
+  uint32 segments_count = command_buffer_get_segments_count(cmd_buffer);
+  for(uint32 s = 0; s < segments_count; s++)
+  {
+    command_span span = command_buffer_get_segment(cmd_buffer, s);
+    for(uint32 i = 0; i < span.length; i++)
+    {
+      null_backend_process_command(&span.commands[i]);
+    }
+  }
+
+  return ok_void();
+}
+
+static render_backend* null_backend_create()
+{
+  render_backend* backend = (render_backend*)calloc(1, sizeof(render_backend));
+  if(!backend)
+  {
+    return NULL;
+  }
+
+  backend->name = "null";
+  backend->backend_version = (version){1, 0, 0};
+  backend->supports_batched_rects = true;
+  backend->load_font = null_backend_load_font;
+  backend->get_text_dimensions = null_backend_get_text_dimensions;
+  backend->process_command = null_backend_process_command;
+  backend->process_command_buffer = null_backend_process_command_buffer;
+
+  return backend;
+}
+
+static void null_backend_destroy(render_backend* backend)
+{
+  free(backend);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Cairo Image Backend
+/// Rasterizes commands with the renderer of Cairo based backends, into an
+/// offscreen image surface. Measures the cost of rasterizing frames, without
+/// presenting them.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef SMOLL_REPLAY_CAIRO
+
+/// Size of image surface, commands painting beyond it are clipped by cairo.
+#  define CAIRO_IMAGE_WIDTH 1920
+#  define CAIRO_IMAGE_HEIGHT 1080
+
+/// Font loaded under default handle, texts of all fonts are rendered with
+/// it, as recordings carry only handles of fonts.
+#  define CAIRO_IMAGE_FONT_NAME "sans-serif"
+#  define CAIRO_IMAGE_FONT_SIZE 16
+
+static cairo_t* cairo_image = NULL;
+
+static result_void
+cairo_image_backend_process_command_buffer(const command_buffer* cmd_buffer)
+{
+  uint32 segments_count = command_buffer_get_segments_count(cmd_buffer);
+  for(uint32 s = 0; s < segments_count; s++)
+  {
+    command_span span = command_buffer_get_segment(cmd_buffer, s);
+    for(uint32 i = 0; i < span.length; i++)
+    {
+      result_void _ = cairo_renderer_process_command(&span.commands[i]);
+      if(!_.ok)
+      {
+        return _;
+      }
+    }
+  }
+
+  // image surfaces are rasterized right away, flushing only finishes
+  // pending drawing of the frame
+  cairo_surface_flush(cairo_get_target(cairo_image));
+
+  return ok_void();
+}
+
+static void cairo_image_backend_destroy(render_backend* backend)
+{
+  cairo_destroy(cairo_image);
+  cairo_image = NULL;
+  cairo_renderer_deinit();
+  free(backend);
+}
+
+static render_backend* cairo_image_backend_create()
+{
+  if(!cairo_renderer_init().ok)
+  {
+    return NULL;
+  }
+
+  cairo_surface_t* surface = cairo_image_surface_create(
+    CAIRO_FORMAT_RGB24, CAIRO_IMAGE_WIDTH, CAIRO_IMAGE_HEIGHT);
+  cairo_image = cairo_create(surface);
+  cairo_surface_destroy(surface);
+  if(cairo_status(cairo_image) != CAIRO_STATUS_SUCCESS)
+  {
+    cairo_destroy(cairo_image);
+    cairo_image = NULL;
+    cairo_renderer_deinit();
+    return NULL;
+  }
+  cairo_renderer_set_target(cairo_image);
+
+  render_backend* backend = (render_backend*)calloc(1, sizeof(render_backend));
+  if(!backend)
+  {
+    cairo_image_backend_destroy(NULL);
+    return NULL;
+  }
+
+  backend->name = "cairo-image";
+  backend->backend_version = (version){1, 0, 0};
+  backend->supports_curve_rendering = true;
+  backend->supports_batched_rects = true;
+  backend->load_font = cairo_renderer_load_font;
+  backend->get_text_dimensions = cairo_renderer_get_text_dimensions;
+  backend->get_texts_dimensions = cairo_renderer_get_texts_dimensions;
+  backend->get_glyph_table = cairo_renderer_get_glyph_table;
+  backend->shape_text = cairo_renderer_shape_text;
+  backend->process_command = cairo_renderer_process_command;
+  backend->process_command_buffer = cairo_image_backend_process_command_buffer;
+
+  if(!cairo_renderer_load_font(DEFAULT_FONT_HANDLE,
+                               CAIRO_IMAGE_FONT_NAME,
+                               CAIRO_IMAGE_FONT_SIZE)
+        .ok)
+  {
+    cairo_image_backend_destroy(backend);
+    return NULL;
+  }
+
+  return backend;
+}
+
+#endif
+
+/// Backends which can be replayed into.
+/// Add an entry here to benchmark another backend.
+static const struct
+{
+  const char* name;
+  render_backend* (*create)();
+  void (*destroy)(render_backend* backend);
+} backends[] = {
+  {"null", null_backend_create, null_backend_destroy},
+#ifdef SMOLL_REPLAY_CAIRO
+  {"cairo-image", cairo_image_backend_create, cairo_image_backend_destroy},
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// * Replay
+///////////////////////////////////////////////////////////////////////////////
+
+/// Times of all replayed frames.
+typedef struct replay_stats
+{
+  uint64* frame_times_ns;
+  uint32 frames_count;
+  uint32 frames_capacity;
+
+  uint64 commands_count;
+  uint64 total_ns;
+} replay_stats;
+
+static bool replay_stats_push_frame(replay_stats* stats, uint64 frame_ns)
+{
+  if(stats->frames_count == stats->frames_capacity)
+  {
+    uint32 capacity = stats->frames_capacity ? stats->frames_capacity * 2 : 256;
+    uint64* times =
+      (uint64*)realloc(stats->frame_times_ns, capacity * sizeof(uint64));
+    if(!times)
+    {
+      return false;
+    }
+    stats->frame_times_ns = times;
+    stats->frames_capacity = capacity;
+  }
+
+  stats->frame_times_ns[stats->frames_count++] = frame_ns;
+  stats->total_ns += frame_ns;
+
+  return true;
+}
+
+/// Feeds every frame of command stream into backend, timing only the backend.
+static result_void replay(command_stream_reader* reader,
+                          const render_backend* backend,
+                          command_buffer* buffer,
+                          replay_stats* stats,
+                          bool per_frame)
+{
+  uint64 timestamp_ns = 0;
+  while(1)
+  {
+    result_bool _ =
+      command_stream_reader_read_frame(reader, buffer, &timestamp_ns);
+    if(!_.ok)
+    {
+      return error(result_void, _.error);
+    }
+    if(!_.value)
+    {
+      break;
+    }
+
+    uint32 length = command_buffer_length(buffer);
+
+    uint64 begin_ns = clock_now_ns();
+    if(backend->process_command_buffer)
+    {
+      backend->process_command_buffer(buffer);
+    }
+    else
+    {
+      uint32 segments_count = command_buffer_get_segments_count(buffer);
+      for(uint32 s = 0; s < segments_count; s++)
+      {
+        command_span span = command_buffer_get_segment(buffer, s);
+        for(uint32 i = 0; i < span.length; i++)
+        {
+          backend->process_command(&span.commands[i]);
+        }
+      }
+    }
+    uint64 frame_ns = clock_now_ns() - begin_ns;
+
+    if(!replay_stats_push_frame(stats, frame_ns))
+    {
+      return error(result_void,
+                   "Unable to allocate memory for frame times!");
+    }
+    stats->commands_count += length;
+
+    if(per_frame)
+    {
+      printf("frame %u: recorded at %.3f ms, %u commands, %.3f us\n",
+             stats->frames_count - 1,
+             (double)timestamp_ns / 1e6,
+             length,
+             (double)frame_ns / 1e3);
+    }
+  }
+
+  return ok_void();
+}
+
+static int compare_u64(const void* a, const void* b)
+{
+  uint64 x = *(const uint64*)a, y = *(const uint64*)b;
+  return (x > y) - (x < y);
+}
+
+static void print_report(const char* backend_name, replay_stats* stats)
+{
+  if(!stats->frames_count)
+  {
+    printf("No frames in recording.\n");
+    return;
+  }
+
+  qsort(stats->frame_times_ns,
+        stats->frames_count,
+        sizeof(uint64),
+        compare_u64);
+
+  uint64* times = stats->frame_times_ns;
+  uint32 count = stats->frames_count;
+  double total_s = (double)stats->total_ns / 1e9;
+
+  printf("backend:       %s\n", backend_name);
+  printf("frames:        %u\n", count);
+  printf("commands:      %llu\n", (unsigned long long)stats->commands_count);
+  printf("backend time:  %.3f ms\n", (double)stats->total_ns / 1e6);
+  printf("commands/sec:  %.0f\n",
+         total_s > 0 ? (double)stats->commands_count / total_s : 0.0);
+  printf("frame time us: avg %.3f, min %.3f, p50 %.3f, p99 %.3f, max %.3f\n",
+         (double)stats->total_ns / count / 1e3,
+         (double)times[0] / 1e3,
+         (double)times[count / 2] / 1e3,
+         (double)times[(uint32)((uint64)(count - 1) * 99 / 100)] / 1e3,
+         (double)times[count - 1] / 1e3);
+}
+
+static void print_usage()
+{
+  printf("Usage: smoll-replay <recording> [--backend <name>] "
+         "[--repeat <count>] [--per-frame]\n");
+  printf("Backends:");
+  for(size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++)
+  {
+    printf(" %s", backends[i].name);
+  }
+  printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = NULL;
+  const char* backend_name = backends[0].name;
+  uint32 repeat = 1;
+  bool per_frame = false;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--backend") && i + 1 < argc)
+    {
+      backend_name = argv[++i];
+    }
+    else if(!strcmp(argv[i], "--repeat") && i + 1 < argc)
+    {
+      repeat = (uint32)strtoul(argv[++i], NULL, 10);
+    }
+    else if(!strcmp(argv[i], "--per-frame"))
+    {
+      per_frame = true;
+    }
+    else if(argv[i][0] != '-' && !path)
+    {
+      path = argv[i];
+    }
+    else
+    {
+      print_usage();
+      return 1;
+    }
+  }
+
+  if(!path || repeat < 1)
+  {
+    print_usage();
+    return 1;
+  }
+
+  render_backend* backend = NULL;
+  void (*destroy_backend)(render_backend*) = NULL;
+  for(size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++)
+  {
+    if(!strcmp(backends[i].name, backend_name))
+    {
+      backend = backends[i].create();
+      destroy_backend = backends[i].destroy;
+      break;
+    }
+  }
+  if(!backend)
+  {
+    fprintf(stderr, "Error: Unknown (or) unavailable backend: %s\n",
+            backend_name);
+    return 1;
+  }
+
+  result_command_stream_reader_ptr _ = command_stream_reader_open(path);
+  if(!_.ok)
+  {
+    fprintf(stderr, "Error: %s\n", _.error);
+    destroy_backend(backend);
+    return 1;
+  }
+  command_stream_reader* reader = _.value;
+
+  result_command_buffer_ptr __ = command_buffer_new();
+  if(!__.ok)
+  {
+    fprintf(stderr, "Error: %s\n", __.error);
+    command_stream_reader_close(reader);
+    destroy_backend(backend);
+    return 1;
+  }
+  command_buffer* buffer = __.value;
+
+  int exit_code = 0;
+  replay_stats stats = {0};
+  for(uint32 i = 0; i < repeat; i++)
+  {
+    command_stream_reader_rewind(reader);
+    result_void ___ = replay(reader, backend, buffer, &stats, per_frame);
+    if(!___.ok)
+    {
+      fprintf(stderr, "Error: %s\n", ___.error);
+      exit_code = 1;
+      break;
+    }
+  }
+
+  if(!exit_code)
+  {
+    print_report(backend->name, &stats);
+  }
+
+  free(stats.frame_times_ns);
+  command_buffer_free(buffer);
+  command_stream_reader_close(reader);
+  destroy_backend(backend);
+
+  return exit_code;
+}